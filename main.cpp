@@ -49,20 +49,99 @@
 #include <thread>
 #include <shared_mutex>
 #include <mutex>
+#include <condition_variable>
 #include <chrono>
 #include <string>
 #include <random>
 #include <map>
 #include <iomanip>
 #include <memory>
+#include <new>
 #include <algorithm>
+#include <array>
+#include <deque>
+#include <queue>
+#include <functional>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <cerrno>
+#include <fstream>
+#include <sstream>
+#include <ctime>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <stdexcept>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/mman.h>
+#include <linux/futex.h>
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <sys/ioctl.h>
+#include <linux/perf_event.h>
+#include <malloc.h>
+#include <execinfo.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <sys/utsname.h>
+#include <gnu/libc-version.h>
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#ifndef GIT_REVISION
+#define GIT_REVISION "unknown" /**< Revision of the source tree, normally injected by the Makefile. */
+#endif
+
+#ifndef BUILD_FLAGS
+#define BUILD_FLAGS "unknown" /**< Compiler flags of the build, normally injected by the Makefile. */
+#endif
+
+// futex_waitv arrived in Linux 5.16; older uapi headers have neither its number nor its types
+#ifndef SYS_futex_waitv
+#define SYS_futex_waitv 449 /**< `futex_waitv` in the generic system call table. */
+#endif
+#ifndef FUTEX_32
+#define FUTEX_32 2 /**< futex2 size flag of a 32-bit word. */
+#endif
+#ifndef FUTEX_WAITV_MAX
+#define FUTEX_WAITV_MAX 128 /**< Most words one `futex_waitv` call waits on. */
+/**
+ * @struct futex_waitv
+ * @brief One word of a `futex_waitv` call, laid out as in `<linux/futex.h>`.
+ */
+struct futex_waitv {
+    uint64_t val;        /**< Value the word is expected to hold. */
+    uint64_t uaddr;      /**< Address of the word. */
+    uint32_t flags;      /**< Size and private flags. */
+    uint32_t __reserved; /**< Must be zero. */
+};
+#endif
 
 /**
  * @class RandomStringGenerator
  * @brief A utility class for generating random strings of specified length.
  *
  * This class provides a static method to generate random alphanumeric strings,
- * which can be used for testing purposes or to simulate text data.
+ * which can be used for testing purposes or to simulate text data. Each thread owns its
+ * generator; seeding it with a value from `deriveSeed()` makes the sequence of strings a
+ * thread produces reproducible, and `digest()` fingerprints that sequence so a replay can
+ * verify it produced the same payloads.
  */
 class RandomStringGenerator {
 public:
@@ -76,20 +155,85 @@ public:
      * avoid collisions in multi-threaded contexts.
      */
     static std::string generate(size_t length) {
+        std::string randomString(length, '\0');
+        generate(&randomString[0], length);
+        return randomString;
+    }
+
+    /**
+     * @brief Fills a caller's buffer with a random string, without allocating.
+     * @param out The buffer, at least `length` characters.
+     * @param length The number of characters to generate.
+     *
+     * Produces the same characters and digest as `generate(size_t)` would.
+     */
+    static void generate(char* out, size_t length) {
         static const char charset[] = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789"; /**< Character set for string generation. */
         static const size_t charsetSize = sizeof(charset) - 1; /**< Size of the character set. */
 
-        static thread_local std::mt19937 generator(std::random_device{}()); /**< Thread-local random number generator. */
         static thread_local std::uniform_int_distribution<> distribution(0, charsetSize - 1); /**< Thread-local distribution for character selection. */
-
-        std::string randomString;
-        randomString.reserve(length);
+        State& current = state();
 
         for (size_t i = 0; i < length; ++i) {
-            randomString += charset[distribution(generator)];
+            out[i] = charset[distribution(current.generator)];
         }
 
-        return randomString;
+        // Every character goes into the digest, eight at a time, so any change to a payload shows
+        uint64_t hash = mix(current.digest ^ length);
+        for (size_t i = 0; i < length; i += 8) {
+            uint64_t chunk = 0;
+            std::memcpy(&chunk, out + i, std::min<size_t>(8, length - i));
+            hash = mix(hash ^ chunk);
+        }
+        current.digest = hash;
+    }
+
+    /**
+     * @brief Reseeds the calling thread's generator and resets its digest.
+     * @param seed The seed, typically obtained from `deriveSeed()`.
+     */
+    static void seed(uint64_t seed) {
+        std::seed_seq sequence{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)};
+        state().generator.seed(sequence);
+        state().digest = 0;
+    }
+
+    /// @return A fingerprint of all strings the calling thread generated since it was last seeded.
+    static uint64_t digest() { return state().digest; }
+
+    /**
+     * @brief Derives a child seed from a base seed and a path of indices.
+     * @param base The base seed, e.g. the global `--seed`.
+     * @param path Indices identifying the consumer, e.g. {test case, lock, role, thread}.
+     * @return A well-mixed seed that depends on the base and every element of the path.
+     */
+    static uint64_t deriveSeed(uint64_t base, std::initializer_list<uint64_t> path) {
+        uint64_t seed = mix(base);
+        for (uint64_t index : path) seed = mix(seed ^ (index + 0x9e3779b97f4a7c15ull));
+        return seed;
+    }
+
+private:
+    /**
+     * @struct State
+     * @brief The generator and digest of one thread.
+     */
+    struct State {
+        std::mt19937 generator{std::random_device{}()}; /**< Random engine; unseeded threads start from random_device. */
+        uint64_t digest = 0;                             /**< Fingerprint of the generated sequence. */
+    };
+
+    /// @return The calling thread's generator state.
+    static State& state() {
+        static thread_local State threadState; /**< Thread-local random number generator. */
+        return threadState;
+    }
+
+    /// @return The splitmix64 finalizer of a value.
+    static uint64_t mix(uint64_t value) {
+        value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+        value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+        return value ^ (value >> 31);
     }
 };
 
@@ -106,220 +250,8292 @@ struct SharedData {
 };
 
 /**
- * @class LockTester
- * @brief Demonstrates the performance differences between `std::shared_mutex` and `std::mutex` in a multi-threaded environment with multiple readers and writers.
- *
- * The `LockTester` class is designed to benchmark and compare the efficiency of `std::shared_mutex` and `std::mutex` under different scenarios,
- * particularly focusing on cases where the number of reader threads exceeds the number of writer threads.
- *
- * **Purpose and Demonstration:**
- *
- * - **Shared vs. Exclusive Locking:**
- *   - `std::shared_mutex` allows multiple threads to acquire a shared (read) lock simultaneously, enabling concurrent read operations.
- *   - `std::mutex` only allows one thread to hold the lock at any given time, blocking both read and write operations from other threads.
- * - **Use Case Scenario:**
- *   - In applications where read operations are frequent and write operations are infrequent, using `std::shared_mutex` can significantly improve performance by allowing multiple readers to access the shared data concurrently.
- *   - This class demonstrates how `std::shared_mutex` can be more efficient than `std::mutex` in such scenarios.
- *
- * **Functionality:**
- *
- * - **Benchmarking Methods:**
- *   - `testSharedMutex()`: Measures the execution time when using `std::shared_mutex` with multiple reader and writer threads.
- *   - `testStandardMutex()`: Measures the execution time when using `std::mutex` with multiple reader and writer threads.
- * - **Thread Functions:**
- *   - Reader threads execute either `readerSharedLock()` or `readerStandardLock()`, depending on the mutex type, to perform read operations.
- *   - Writer threads execute either `writerSharedLock()` or `writerStandardLock()`, depending on the mutex type, to perform write operations.
- *
- * **Usage:**
- *
- * - Create an instance of `LockTester` by specifying the number of readers, writers, reads per reader, and updates per writer.
- * - Call `testSharedMutex()` and `testStandardMutex()` to perform the benchmarks.
- * - Access the `times` map to retrieve the execution times for comparison.
- *
- * **Example:**
- *
- * ```cpp
- * LockTester tester(10, 2, 1000, 500); // 10 readers, 2 writers
- * tester.testSharedMutex();
- * tester.testStandardMutex();
- * std::cout << "Shared Mutex Time: " << tester.times["Shared Mutex Time"] << " ms\n";
- * std::cout << "Standard Mutex Time: " << tester.times["Standard Mutex Time"] << " ms\n";
- * ```
+ * @class LatencyHistogram
+ * @brief A fixed-size log-linear histogram of latencies in nanoseconds.
  *
- * **Conclusion:**
+ * Values below 16 ns get a bucket each; above that every power of two is split into 16
+ * sub-buckets, which bounds the relative error to about 6% while keeping the whole
+ * histogram in a fixed array. Recording never allocates, so a thread can record every
+ * operation without disturbing the measurement.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBuckets = 16;                  /**< Sub-buckets per power of two. */
+    static constexpr int kMaxExponent = 47;                 /**< Largest power of two covered (~39 hours). */
+    static constexpr int kBucketCount = (kMaxExponent - 2) * kSubBuckets; /**< Total number of buckets. */
+
+    /**
+     * @brief Records one latency.
+     * @param ns The latency in nanoseconds; larger values than the covered range go to the last bucket.
+     */
+    void record(uint64_t ns) {
+        ++buckets[bucketIndex(ns)];
+        ++total;
+        sum += ns;
+        maxValue = std::max(maxValue, ns);
+    }
+
+    /**
+     * @brief Adds all samples of another histogram to this one.
+     * @param other The histogram to merge.
+     */
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < kBucketCount; ++i) buckets[i] += other.buckets[i];
+        total += other.total;
+        sum += other.sum;
+        maxValue = std::max(maxValue, other.maxValue);
+    }
+
+    /**
+     * @brief Adds samples counted outside a histogram, e.g. in per-bucket atomics.
+     * @param index The bucket, from `bucketOf()`.
+     * @param n Number of samples; each is taken at the bucket's midpoint for the mean.
+     */
+    void recordBucket(int index, uint64_t n) {
+        if (!n) return;
+        buckets[index] += n;
+        total += n;
+        sum += (bucketLower(index) + bucketUpper(index)) / 2 * n;
+        maxValue = std::max(maxValue, bucketUpper(index) - 1);
+    }
+
+    /// @return The bucket a latency of `ns` is recorded in.
+    static int bucketOf(uint64_t ns) { return bucketIndex(ns); }
+
+    /// @return The number of recorded samples.
+    uint64_t count() const { return total; }
+
+    /// @return The mean of the recorded samples in nanoseconds, or 0 when empty.
+    double mean() const { return total ? static_cast<double>(sum) / total : 0.0; }
+
+    /// @return The largest recorded sample in nanoseconds.
+    uint64_t max() const { return maxValue; }
+
+    /**
+     * @brief Estimates a percentile.
+     * @param q The quantile in [0, 1], e.g. 0.99.
+     * @return The midpoint of the bucket holding the quantile, in nanoseconds; 0 when empty.
+     */
+    uint64_t percentile(double q) const {
+        if (!total) return 0;
+        uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * total)));
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount; ++i) {
+            seen += buckets[i];
+            if (seen >= rank) return std::min(maxValue, (bucketLower(i) + bucketUpper(i)) / 2);
+        }
+        return maxValue;
+    }
+
+    /**
+     * @brief Formats a latency with a readable unit and three significant digits.
+     * @param ns The latency in nanoseconds.
+     * @return The formatted latency, e.g. `850 ns`, `12.5 us` or `1780 ms`.
+     */
+    static std::string format(uint64_t ns) {
+        double value = static_cast<double>(ns);
+        const char* unit = " ns";
+        if (ns >= 1000000) value /= 1e6, unit = " ms";
+        else if (ns >= 1000) value /= 1e3, unit = " us";
+        std::ostringstream out;
+        int precision = ns < 1000 || value >= 100 ? 0 : value < 10 ? 2 : 1;
+        out << std::fixed << std::setprecision(precision) << value << unit;
+        return out.str();
+    }
+
+    /**
+     * @brief Returns the cumulative distribution at each non-empty bucket.
+     * @return Pairs of (bucket upper bound in ns, fraction of samples at or below it).
+     */
+    std::vector<std::pair<uint64_t, double>> cdf() const {
+        std::vector<std::pair<uint64_t, double>> points;
+        uint64_t seen = 0;
+        for (int i = 0; i < kBucketCount && seen < total; ++i) {
+            if (!buckets[i]) continue;
+            seen += buckets[i];
+            points.emplace_back(bucketUpper(i), static_cast<double>(seen) / total);
+        }
+        return points;
+    }
+
+private:
+    /**
+     * @brief Maps a value to its bucket.
+     * @param ns The value in nanoseconds.
+     * @return The bucket index.
+     */
+    static int bucketIndex(uint64_t ns) {
+        if (ns < kSubBuckets) return static_cast<int>(ns);
+        int exponent = 63 - __builtin_clzll(ns);
+        if (exponent > kMaxExponent) return kBucketCount - 1;
+        int sub = static_cast<int>((ns >> (exponent - 4)) & (kSubBuckets - 1));
+        return (exponent - 3) * kSubBuckets + sub;
+    }
+
+    /// @return The smallest value that falls into bucket @p index.
+    static uint64_t bucketLower(int index) {
+        if (index < kSubBuckets) return index;
+        int exponent = index / kSubBuckets + 3;
+        return static_cast<uint64_t>(kSubBuckets + index % kSubBuckets) << (exponent - 4);
+    }
+
+    /// @return The first value past bucket @p index.
+    static uint64_t bucketUpper(int index) {
+        if (index < kSubBuckets) return index + 1;
+        int exponent = index / kSubBuckets + 3;
+        return static_cast<uint64_t>(kSubBuckets + index % kSubBuckets + 1) << (exponent - 4);
+    }
+
+    std::array<uint64_t, kBucketCount> buckets{}; /**< Sample counts per bucket. */
+    uint64_t total = 0;                           /**< Number of samples. */
+    uint64_t sum = 0;                             /**< Sum of all samples, for the mean. */
+    uint64_t maxValue = 0;                        /**< Largest sample. */
+};
+
+/**
+ * @enum MetricKind
+ * @brief The kinds of values a metric can hold.
+ */
+enum class MetricKind {
+    Counter,   /**< Monotonic count; merged by adding. */
+    Gauge,     /**< Point-in-time value; merged by keeping the latest. */
+    Duration,  /**< Elapsed time in the metric's unit; merged by adding. */
+    Histogram, /**< Latency distribution in nanoseconds; merged bucket by bucket. */
+};
+
+/// Index of a metric within its `MetricRegistry`.
+using MetricId = uint32_t;
+
+/**
+ * @struct MetricDescriptor
+ * @brief Name, kind and unit of a registered metric.
+ */
+struct MetricDescriptor {
+    std::string name;       /**< Display name, e.g. `Shared Mutex Time`. */
+    MetricKind kind;        /**< Kind of value. */
+    std::string unit;       /**< Unit of the value, e.g. `ms`, `ns`, `ops/s`. */
+    uint32_t histogramSlot; /**< Index into the histogram storage of a `MetricSet` (histograms only). */
+};
+
+/**
+ * @class MetricRegistry
+ * @brief Defines the metrics a component reports, in a fixed order.
  *
- * - The results demonstrate that `std::shared_mutex` provides better performance in scenarios with a high read-to-write ratio.
- * - This class effectively showcases the conditions under which `std::shared_mutex` is more efficient compared to `std::mutex`.
+ * Metrics are registered once, before measuring, and addressed afterwards by their dense
+ * `MetricId`. The definition order is the presentation order of every reporter, so columns no
+ * longer depend on the iteration order of a string-keyed map.
+ */
+class MetricRegistry final {
+public:
+    /**
+     * @brief Registers a metric, or returns the existing one with the same name.
+     * @param name Display name.
+     * @param kind Kind of value.
+     * @param unit Unit of the value.
+     * @return The id of the metric.
+     * @throws std::logic_error If the name is already registered with another kind or unit.
+     */
+    MetricId define(const std::string& name, MetricKind kind, const std::string& unit) {
+        auto existing = byName.find(name);
+        if (existing != byName.end()) {
+            const MetricDescriptor& descriptor = descriptors[existing->second];
+            if (descriptor.kind != kind || descriptor.unit != unit)
+                throw std::logic_error("metric '" + name + "' redefined with a different kind or unit");
+            return existing->second;
+        }
+        uint32_t slot = kind == MetricKind::Histogram ? histograms++ : 0;
+        descriptors.push_back({name, kind, unit, slot});
+        return byName[name] = static_cast<MetricId>(descriptors.size() - 1);
+    }
+
+    /// @return The id of a new or existing counter.
+    MetricId counter(const std::string& name, const std::string& unit) { return define(name, MetricKind::Counter, unit); }
+    /// @return The id of a new or existing gauge.
+    MetricId gauge(const std::string& name, const std::string& unit) { return define(name, MetricKind::Gauge, unit); }
+    /// @return The id of a new or existing duration.
+    MetricId duration(const std::string& name, const std::string& unit) { return define(name, MetricKind::Duration, unit); }
+    /// @return The id of a new or existing latency histogram (nanoseconds).
+    MetricId histogram(const std::string& name) { return define(name, MetricKind::Histogram, "ns"); }
+
+    /**
+     * @brief Looks up a metric by name.
+     * @param name Display name.
+     * @param id Receives the id when found.
+     * @return Whether the metric exists.
+     */
+    bool find(const std::string& name, MetricId& id) const {
+        auto it = byName.find(name);
+        if (it == byName.end()) return false;
+        id = it->second;
+        return true;
+    }
+
+    /// @return The descriptor of a metric.
+    const MetricDescriptor& descriptor(MetricId id) const { return descriptors[id]; }
+    /// @return The number of registered metrics; ids run from 0 to size() - 1.
+    size_t size() const { return descriptors.size(); }
+    /// @return The number of registered histograms.
+    size_t histogramCount() const { return histograms; }
+
+private:
+    std::vector<MetricDescriptor> descriptors; /**< Metrics in definition order. */
+    std::map<std::string, MetricId> byName;    /**< Name lookup, used only outside the hot path. */
+    uint32_t histograms = 0;                   /**< Number of histogram metrics. */
+};
+
+/**
+ * @class MetricSet
+ * @brief Values of every metric of a registry, stored in preallocated dense arrays.
  *
- * @note Copy and move constructors and assignment operators are deleted to prevent copying of the `LockTester` instance.
+ * A set is sized once from its registry, so `add()`, `set()` and `record()` are plain array
+ * updates that never allocate; each thread gets its own set and sets are merged after the
+ * threads have joined. Only histogram metrics carry histogram storage, so a registry can hold
+ * hundreds of scalar metrics cheaply. Histograms, values and presence flags share one block
+ * that starts and ends on a cache line, so sets of different threads never share a line.
+ * A histogram counts as present once it has samples, which keeps `record()` to the histogram.
  */
-class LockTester final {
+class alignas(64) MetricSet final {
 public:
+    /// Constructs an empty set bound to no registry.
+    MetricSet() = default;
+
     /**
-     * @brief Constructs a LockTester with the specified number of readers, writers, reads, and updates.
-     * @param numReaders The number of reader threads.
-     * @param numWriters The number of writer threads.
-     * @param numReads The number of reads each reader performs.
-     * @param numUpdates The number of updates each writer performs.
+     * @brief Constructs a set with storage for every metric registered so far.
+     * @param registry The registry; must outlive the set and must not grow afterwards.
      */
-    LockTester(int numReaders, int numWriters, int numReads, int numUpdates)
-        : numReaders(numReaders), numWriters(numWriters), numReads(numReads), numUpdates(numUpdates) {}
+    explicit MetricSet(const MetricRegistry& registry)
+        : metricRegistry(&registry), metricCount(registry.size()), histogramCount(registry.histogramCount()),
+          block(allocate(metricCount, histogramCount)) {
+        for (size_t i = 0; i < histogramCount; ++i) new (histograms() + i) LatencyHistogram();
+        std::fill(values(), values() + metricCount, 0.0);
+        std::fill(present(), present() + metricCount, uint8_t(0));
+    }
 
-    // Delete copy and move constructors and assignment operators
-    LockTester(const LockTester&) = delete; /**< Deleted copy constructor. */
-    LockTester& operator=(const LockTester&) = delete; /**< Deleted copy assignment operator. */
-    LockTester(LockTester&&) = delete; /**< Deleted move constructor. */
-    LockTester& operator=(LockTester&&) = delete; /**< Deleted move assignment operator. */
+    /// Copies the values of another set into storage of its own.
+    MetricSet(const MetricSet& other)
+        : metricRegistry(other.metricRegistry), metricCount(other.metricCount), histogramCount(other.histogramCount),
+          block(other.block ? allocate(metricCount, histogramCount) : nullptr) {
+        if (block) std::memcpy(block.get(), other.block.get(), blockSize(metricCount, histogramCount));
+    }
+
+    MetricSet(MetricSet&&) noexcept = default; /**< Takes over the storage of another set. */
+
+    /// Replaces the values with a copy of another set's.
+    MetricSet& operator=(const MetricSet& other) {
+        if (this != &other) *this = MetricSet(other);
+        return *this;
+    }
+
+    MetricSet& operator=(MetricSet&&) noexcept = default; /**< Takes over the storage of another set. */
+
+    /// Adds to a counter or duration.
+    void add(MetricId id, double delta) {
+        values()[id] += delta;
+        present()[id] = 1;
+    }
+
+    /// Sets a gauge or duration.
+    void set(MetricId id, double value) {
+        values()[id] = value;
+        present()[id] = 1;
+    }
+
+    /// Records one sample of a histogram.
+    void record(MetricId id, uint64_t ns) { histograms()[metricRegistry->descriptor(id).histogramSlot].record(ns); }
+
+    /// Adds all samples of a histogram to a histogram metric.
+    void merge(MetricId id, const LatencyHistogram& samples) {
+        histograms()[metricRegistry->descriptor(id).histogramSlot].merge(samples);
+        present()[id] = 1;
+    }
 
     /**
-     * @brief Tests the performance of shared_mutex with multiple readers and writers.
+     * @brief Merges another set of the same registry into this one.
+     * @param other The set to merge.
      *
-     * Launches reader and writer threads that access a shared resource protected by shared_mutex,
-     * then measures the total execution time in milliseconds.
+     * Counters and durations are added, gauges take the other value, histograms are combined.
      */
-    void testSharedMutex() {
-        auto start = std::chrono::high_resolution_clock::now();
+    void merge(const MetricSet& other) {
+        for (MetricId id = 0; id < other.metricCount; ++id) {
+            if (!other.has(id)) continue;
+            const MetricDescriptor& descriptor = metricRegistry->descriptor(id);
+            if (descriptor.kind == MetricKind::Histogram) histograms()[descriptor.histogramSlot].merge(other.histogram(id));
+            else if (descriptor.kind == MetricKind::Gauge) values()[id] = other.value(id);
+            else values()[id] += other.value(id);
+            present()[id] = 1;
+        }
+    }
 
-        std::vector<std::thread> readers, writers;
-        for (int i = 0; i < numReaders; ++i)
-            readers.emplace_back(&LockTester::readerSharedLock, this);
+    /// @return Whether the metric received a value.
+    bool has(MetricId id) const {
+        if (id >= metricCount) return false;
+        if (present()[id]) return true;
+        return metricRegistry->descriptor(id).kind == MetricKind::Histogram && histogram(id).count() > 0;
+    }
+    /// @return The value of a scalar metric.
+    double value(MetricId id) const { return values()[id]; }
+    /// @return The distribution of a histogram metric.
+    const LatencyHistogram& histogram(MetricId id) const {
+        return histograms()[metricRegistry->descriptor(id).histogramSlot];
+    }
+    /// @return The registry the set belongs to, or nullptr for an empty set.
+    const MetricRegistry* registry() const { return metricRegistry; }
 
-        for (int i = 0; i < numWriters; ++i)
-            writers.emplace_back(&LockTester::writerSharedLock, this);
+private:
+    static_assert(std::is_trivially_copyable<LatencyHistogram>::value, "histograms are copied bytewise");
+    static_assert(sizeof(LatencyHistogram) % alignof(double) == 0, "values follow the histograms");
 
-        for (auto& t : readers) t.join();
-        for (auto& t : writers) t.join();
+    /// Cache line size the storage block is aligned and padded to.
+    static constexpr size_t kCacheLine = 64;
 
-        auto end = std::chrono::high_resolution_clock::now();
-        times["Shared Mutex Time"] = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    /// Frees a storage block.
+    struct BlockDeleter {
+        void operator()(unsigned char* memory) const { ::operator delete[](memory, std::align_val_t(kCacheLine)); }
+    };
+
+    /// @return Bytes of the block: histograms, then values, then presence flags, padded to a cache line.
+    static size_t blockSize(size_t metrics, size_t histogramSlots) {
+        size_t bytes = histogramSlots * sizeof(LatencyHistogram) + metrics * (sizeof(double) + sizeof(uint8_t));
+        return (bytes + kCacheLine - 1) / kCacheLine * kCacheLine;
     }
 
+    /// @return A new cache-line-aligned block for the given counts.
+    static std::unique_ptr<unsigned char[], BlockDeleter> allocate(size_t metrics, size_t histogramSlots) {
+        size_t bytes = std::max(kCacheLine, blockSize(metrics, histogramSlots));
+        return std::unique_ptr<unsigned char[], BlockDeleter>(
+            static_cast<unsigned char*>(::operator new[](bytes, std::align_val_t(kCacheLine))));
+    }
+
+    /// @return Histogram storage, indexed by histogram slot.
+    LatencyHistogram* histograms() const { return reinterpret_cast<LatencyHistogram*>(block.get()); }
+    /// @return Scalar values, indexed by MetricId.
+    double* values() const { return reinterpret_cast<double*>(block.get() + histogramCount * sizeof(LatencyHistogram)); }
+    /// @return Whether each metric received a value, indexed by MetricId.
+    uint8_t* present() const { return reinterpret_cast<uint8_t*>(values() + metricCount); }
+
+    const MetricRegistry* metricRegistry = nullptr;          /**< Definitions of the stored metrics. */
+    size_t metricCount = 0;                                  /**< Registered metrics when the set was sized. */
+    size_t histogramCount = 0;                               /**< Histogram slots of the set. */
+    std::unique_ptr<unsigned char[], BlockDeleter> block;    /**< Histograms, values and flags of this set. */
+};
+
+/**
+ * @struct LockStats
+ * @brief Per-thread metrics of all readers and writers of one lock test.
+ *
+ * The sets use `LockTester::threadMetrics()` and are allocated before the threads start.
+ */
+struct LockStats {
+    std::vector<MetricSet> readers; /**< One set per reader thread. */
+    std::vector<MetricSet> writers; /**< One set per writer thread. */
+};
+
+/**
+ * @struct ThreadPriority
+ * @brief Scheduling class and nice value applied to a group of benchmark threads.
+ *
+ * Settings an unprivileged process may choose are `SCHED_OTHER`, `SCHED_BATCH` or
+ * `SCHED_IDLE`, combined with a nice value of 0 or higher. This models background jobs that
+ * share a lock with latency-critical request handlers. The real-time classes `SCHED_FIFO`
+ * and `SCHED_RR` need CAP_SYS_NICE; they are what priority inheritance boosts an owner to,
+ * since the kernel does not lend the nice value of a normal thread.
+ */
+struct ThreadPriority {
+    int policy = SCHED_OTHER; /**< Linux scheduling policy. */
+    int nice = 0;             /**< Nice value; positive values lower the priority. */
+    int rtPriority = 0;       /**< Real-time priority 1-99 of `SCHED_FIFO` and `SCHED_RR`. */
+
     /**
-     * @brief Tests the performance of standard mutex with multiple readers and writers.
-     *
-     * Launches reader and writer threads that access a shared resource protected by std::mutex,
-     * then measures the total execution time in milliseconds.
+     * @brief Parses `CLASS[:NICE]` or `fifo|rr[:PRIORITY]`, e.g. `idle`, `batch:10` or `fifo:10`.
+     * @param text The specification.
+     * @return The parsed priority.
+     * @throws std::invalid_argument For unknown classes or malformed values.
      */
-    void testStandardMutex() {
-        auto start = std::chrono::high_resolution_clock::now();
+    static ThreadPriority parse(const std::string& text) {
+        ThreadPriority priority;
+        std::string cls = text.substr(0, text.find(':'));
+        if (cls == "other" || cls == "normal") priority.policy = SCHED_OTHER;
+        else if (cls == "batch") priority.policy = SCHED_BATCH;
+        else if (cls == "idle") priority.policy = SCHED_IDLE;
+        else if (cls == "fifo") priority.policy = SCHED_FIFO;
+        else if (cls == "rr") priority.policy = SCHED_RR;
+        else throw std::invalid_argument("unknown scheduling class '" + cls + "' (use other, batch, idle, fifo or rr)");
+        int value = text.find(':') != std::string::npos ? std::stoi(text.substr(text.find(':') + 1)) : 0;
+        if (priority.realTime()) {
+            priority.rtPriority = value ? value : 1;
+            if (priority.rtPriority < 1 || priority.rtPriority > 99)
+                throw std::invalid_argument("real-time priority must be between 1 and 99");
+        } else {
+            priority.nice = value;
+        }
+        return priority;
+    }
 
-        std::vector<std::thread> readers, writers;
-        for (int i = 0; i < numReaders; ++i)
-            readers.emplace_back(&LockTester::readerStandardLock, this);
+    /// @return Whether this is the default priority, i.e. nothing needs to be applied.
+    bool isDefault() const { return policy == SCHED_OTHER && nice == 0; }
 
-        for (int i = 0; i < numWriters; ++i)
-            writers.emplace_back(&LockTester::writerStandardLock, this);
+    /// @return Whether the policy is a real-time class.
+    bool realTime() const { return policy == SCHED_FIFO || policy == SCHED_RR; }
 
-        for (auto& t : readers) t.join();
-        for (auto& t : writers) t.join();
+    /// @return The specification in `CLASS:NICE` or `CLASS:PRIORITY` form.
+    std::string describe() const {
+        if (realTime()) return std::string(policy == SCHED_FIFO ? "fifo" : "rr") + ":" + std::to_string(rtPriority);
+        const char* cls = policy == SCHED_BATCH ? "batch" : policy == SCHED_IDLE ? "idle" : "other";
+        return std::string(cls) + ":" + std::to_string(nice);
+    }
 
-        auto end = std::chrono::high_resolution_clock::now();
-        times["Standard Mutex Time"] = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+    /**
+     * @brief Applies the priority to the calling thread.
+     * @return 0, or the error number if the kernel refused (e.g. `EPERM` for a negative nice value
+     *         without CAP_SYS_NICE).
+     */
+    int apply() const {
+        if (isDefault()) return 0;
+        sched_param param{};
+        param.sched_priority = rtPriority;
+        // pthread functions return their error instead of setting errno
+        int error = pthread_setschedparam(pthread_self(), policy, &param);
+        if (realTime() || error) return error;
+        // On Linux, PRIO_PROCESS with a thread id changes only that thread
+        return setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), nice) == 0 ? 0 : errno;
     }
+};
 
-    /// Map to store execution times for shared and standard mutex tests, accessible for move semantics.
-    std::map<std::string, long long> times;
+/**
+ * @struct Futex
+ * @brief Thin wrappers around the Linux futex system call on a 32-bit atomic word.
+ *
+ * Only the process-private operations are used; they skip the lookup of the backing page
+ * that shared futexes need.
+ */
+struct Futex {
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex words must be plain 32-bit integers");
 
-    int numReaders;  /**< Number of reader threads. */
-    int numWriters;  /**< Number of writer threads. */
-    int numReads;    /**< Number of read operations per reader. */
-    int numUpdates;  /**< Number of update operations per writer. */
+    /**
+     * @brief Sleeps while `word` still holds `expected`.
+     * @param word The futex word.
+     * @param expected Value the caller last saw; the kernel returns at once if the word differs.
+     * @param timeout Relative timeout, or null to wait until woken.
+     * @return 0 when woken, -1 with `errno` set to `EAGAIN`, `EINTR` or `ETIMEDOUT` otherwise.
+     */
+    static long wait(std::atomic<uint32_t>& word, uint32_t expected, const timespec* timeout = nullptr) {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+    }
 
-private:
     /**
-     * @brief Function executed by reader threads using shared_mutex.
+     * @brief Wakes threads sleeping on `word`.
+     * @param word The futex word.
+     * @param count Maximum number of threads to wake.
+     * @return The number of threads woken.
+     */
+    static long wake(std::atomic<uint32_t>& word, int count) {
+        return syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+
+    /**
+     * @struct Expected
+     * @brief One word of a `waitAny()` call.
+     */
+    struct Expected {
+        std::atomic<uint32_t>* word; /**< The futex word. */
+        uint32_t value;              /**< Value the caller last saw in it. */
+    };
+
+    /// @return Whether the kernel has `futex_waitv` (Linux 5.16).
+    static bool hasWaitv() {
+        // With no words the call fails with EINVAL where it exists and ENOSYS elsewhere
+        static const bool available = syscall(SYS_futex_waitv, nullptr, 0, 0, nullptr, 0) == -1 && errno != ENOSYS;
+        return available;
+    }
+
+    /**
+     * @brief Sleeps until any of `words` is woken or no longer holds its expected value.
+     * @param words Up to `FUTEX_WAITV_MAX` words.
+     * @param poll Poll even if the kernel has `futex_waitv`.
+     * @return Index of a word that was woken or changed, or -1 if the wait ended without one.
      *
-     * Each reader acquires a shared lock on shared_mutex and reads the shared data.
+     * Uses `futex_waitv` where available. Elsewhere the words are polled with an exponential
+     * backoff from 1 us to 1 ms, which notices changed values but not wakes that leave a value
+     * as it was, so the words must be ones whose wakers change them first.
      */
-    void readerSharedLock() {
-        for (int i = 0; i < numReads; ++i) {
-            std::shared_lock lock(sharedMutex);
-            volatile int data = sharedData.counter;
-            volatile std::string text = sharedData.text;
+    static int waitAny(const std::vector<Expected>& words, bool poll = false) {
+        if (words.empty() || words.size() > FUTEX_WAITV_MAX) throw std::invalid_argument("waitAny needs 1 to 128 words");
+        if (!poll && hasWaitv()) {
+            std::array<futex_waitv, FUTEX_WAITV_MAX> vector{};
+            for (size_t i = 0; i < words.size(); ++i) {
+                vector[i].val = words[i].value;
+                vector[i].uaddr = reinterpret_cast<uintptr_t>(words[i].word);
+                vector[i].flags = FUTEX_32 | FUTEX_PRIVATE_FLAG;
+            }
+            long result = syscall(SYS_futex_waitv, vector.data(), words.size(), 0, nullptr, CLOCK_MONOTONIC);
+            if (result >= 0) return static_cast<int>(result);
+            if (errno != EAGAIN) return -1;
+            // Some word differed already; report it, or nothing if it changed back in the meantime
+            for (size_t i = 0; i < words.size(); ++i)
+                if (words[i].word->load(std::memory_order_acquire) != words[i].value) return static_cast<int>(i);
+            return -1;
+        }
+        for (std::chrono::microseconds backoff{1};; backoff = std::min(backoff * 2, std::chrono::microseconds(1000))) {
+            for (size_t i = 0; i < words.size(); ++i)
+                if (words[i].word->load(std::memory_order_acquire) != words[i].value) return static_cast<int>(i);
+            std::this_thread::sleep_for(backoff);
         }
     }
+};
+
+/**
+ * @class EventCount
+ * @brief Lets threads sleep until a condition they check without a lock may have changed.
+ *
+ * A waiter announces itself with `prepareWait()`, re-checks its condition and then either
+ * sleeps with `commitWait()` or backs out with `cancelWait()`. A notifier first changes the
+ * state and then calls `notifyAll()`, which costs a fence and a load when nobody waits. The
+ * waiter count is incremented and read with full fences on both sides, so either the waiter
+ * sees the new state or the notifier sees the waiter: no wake-up is lost.
+ */
+class EventCount final {
+public:
+    using Key = uint32_t; /**< Epoch observed by `prepareWait()`. */
+
+    /**
+     * @brief Announces a waiter; the caller must re-check its condition afterwards.
+     * @return The key to pass to `commitWait()`.
+     */
+    Key prepareWait() {
+        waiters.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    /// Withdraws a `prepareWait()` after the condition turned out to be true already.
+    void cancelWait() { waiters.fetch_sub(1, std::memory_order_relaxed); }
+
+    /**
+     * @brief Sleeps until a `notifyAll()` after the `prepareWait()` that returned `key`.
+     * @param key The key returned by `prepareWait()`.
+     */
+    void commitWait(Key key) {
+        while (epoch.load(std::memory_order_acquire) == key) Futex::wait(epoch, key);
+        waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Wakes every waiter; call after changing the state waiters check.
+     * @return False if nobody waited and the futex call was skipped.
+     */
+    bool notifyAll() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiters.load(std::memory_order_relaxed) == 0) return false;
+        epoch.fetch_add(1, std::memory_order_release);
+        Futex::wake(epoch, std::numeric_limits<int>::max());
+        return true;
+    }
+
+    /// @return The futex word, for `WaitAny`.
+    std::atomic<uint32_t>& futexWord() { return epoch; }
+
+private:
+    alignas(64) std::atomic<uint32_t> epoch{0}; /**< Futex word; bumped by every notification that has waiters. */
+    std::atomic<uint32_t> waiters{0};           /**< Threads between `prepareWait()` and the end of their wait. */
+};
+
+/**
+ * @class PiMutex
+ * @brief A `pthread_mutex_t` with the `PTHREAD_PRIO_INHERIT` protocol.
+ *
+ * While a higher-priority thread waits, the kernel lends its priority to the owner, so a
+ * preempted low-priority owner gets the CPU to finish its critical section. glibc builds the
+ * protocol on `FUTEX_LOCK_PI`; the uncontended path stays in user space.
+ */
+class PiMutex final {
+public:
+    /// @throws std::runtime_error If the C library does not support priority inheritance.
+    PiMutex() {
+        pthread_mutexattr_t attributes;
+        pthread_mutexattr_init(&attributes);
+        int error = pthread_mutexattr_setprotocol(&attributes, PTHREAD_PRIO_INHERIT);
+        if (!error) error = pthread_mutex_init(&mutex, &attributes);
+        pthread_mutexattr_destroy(&attributes);
+        if (error) throw std::runtime_error(std::string("cannot create a priority-inheritance mutex: ") + std::strerror(error));
+    }
+
+    PiMutex(const PiMutex&) = delete;
+    PiMutex& operator=(const PiMutex&) = delete;
+
+    ~PiMutex() { pthread_mutex_destroy(&mutex); }
+
+    void lock() { pthread_mutex_lock(&mutex); }                   /**< Takes the mutex. */
+    bool try_lock() { return pthread_mutex_trylock(&mutex) == 0; } /**< @return True if the mutex was taken. */
+    void unlock() { pthread_mutex_unlock(&mutex); }               /**< Releases the mutex. */
+
+private:
+    pthread_mutex_t mutex; /**< The priority-inheritance mutex. */
+};
+
+/**
+ * @class FutexPiMutex
+ * @brief A priority-inheritance mutex on the `FUTEX_LOCK_PI` protocol directly.
+ *
+ * The word holds the owner's thread id. Locking and unlocking an uncontended mutex is one
+ * compare-and-swap; otherwise the kernel queues the caller by priority, boosts the owner
+ * and, on unlock, hands the word to the highest-priority waiter.
+ */
+class FutexPiMutex final {
+public:
+    /// Takes the mutex, queueing in the kernel while another thread owns it.
+    void lock() {
+        uint32_t expected = 0;
+        if (word.compare_exchange_strong(expected, threadId(), std::memory_order_acquire, std::memory_order_relaxed)) return;
+        while (syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_LOCK_PI_PRIVATE, 0, nullptr, nullptr, 0) != 0) {
+            if (errno != EINTR && errno != EAGAIN)
+                throw std::runtime_error(std::string("FUTEX_LOCK_PI failed: ") + std::strerror(errno));
+        }
+    }
+
+    /// @return True if the mutex was free and is now taken.
+    bool try_lock() {
+        uint32_t expected = 0;
+        return word.compare_exchange_strong(expected, threadId(), std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    /// Releases the mutex; with waiters queued the kernel picks the next owner.
+    void unlock() {
+        uint32_t expected = threadId();
+        if (word.compare_exchange_strong(expected, 0, std::memory_order_release, std::memory_order_relaxed)) return;
+        syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_UNLOCK_PI_PRIVATE, 0, nullptr, nullptr, 0);
+    }
+
+private:
+    /// @return The kernel thread id of the caller, as the PI protocol stores it.
+    static uint32_t threadId() {
+        thread_local const uint32_t id = static_cast<uint32_t>(syscall(SYS_gettid));
+        return id;
+    }
+
+    alignas(64) std::atomic<uint32_t> word{0}; /**< Owner thread id, plus `FUTEX_WAITERS` while the kernel queues waiters. */
+};
+
+/**
+ * @struct TscClock
+ * @brief A clock reading the time-stamp counter, calibrated against `steady_clock` once.
+ *
+ * Reading the TSC takes a few nanoseconds and no system call. It is only used when the CPU
+ * reports an invariant TSC (`constant_tsc` and `nonstop_tsc`), which runs at the same rate
+ * on every core and in every power state; elsewhere, and on other architectures, the clock
+ * counts `steady_clock` nanoseconds instead, so callers never need to know which one runs.
+ */
+struct TscClock {
+    /// @return The current tick.
+    static uint64_t now() {
+#if defined(__x86_64__)
+        if (calibration().invariant) return __rdtsc();
+#endif
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// @return The ticks in a duration.
+    static uint64_t ticks(std::chrono::nanoseconds duration) {
+        return static_cast<uint64_t>(static_cast<double>(duration.count()) * calibration().ticksPerNs);
+    }
+
+    /// @return Ticks per nanosecond; 1 on the `steady_clock` fallback.
+    static double ticksPerNs() { return calibration().ticksPerNs; }
+
+    /// @return Whether the clock reads the TSC.
+    static bool usesTsc() { return calibration().invariant; }
+
+private:
+    /**
+     * @struct Calibration
+     * @brief Which counter the clock reads and its rate.
+     */
+    struct Calibration {
+        bool invariant = false;  /**< Whether the TSC is invariant and used. */
+        double ticksPerNs = 1;   /**< Counter rate. */
+    };
+
+    /// @return The calibration, measured over 20 ms on first use.
+    static const Calibration& calibration() {
+        static const Calibration instance = [] {
+            Calibration c;
+#if defined(__x86_64__)
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line)) {
+                if (line.rfind("flags", 0) != 0) continue;
+                c.invariant = line.find(" constant_tsc") != std::string::npos && line.find(" nonstop_tsc") != std::string::npos;
+                break;
+            }
+            if (c.invariant) {
+                auto start = std::chrono::steady_clock::now();
+                uint64_t first = __rdtsc();
+                std::this_thread::sleep_for(std::chrono::milliseconds(20));
+                uint64_t last = __rdtsc();
+                auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                c.ticksPerNs = static_cast<double>(last - first) / static_cast<double>(elapsed.count());
+            }
+#endif
+            return c;
+        }();
+        return instance;
+    }
+};
+
+/**
+ * @class LeaseLock
+ * @brief A reader-writer lock in which readers hold time-bounded leases instead of announcing each read.
+ *
+ * A reader takes a lease by recording its end in its own slot, fencing, and checking that
+ * the writer epoch is even, i.e. no writer is in. Until the lease ends, each read only marks
+ * the slot active, reads the clock and checks the epoch: no fence and no write to a line
+ * another reader writes. A writer makes the epoch odd and then waits, slot by slot, until the
+ * lease is released or has ended and the slot is not active. Readers that see an odd epoch
+ * release their lease at once, so a writer waits for the full lease only on readers that do
+ * not read meanwhile, e.g. preempted ones. A read that starts just before its lease ends is
+ * covered by the active mark; the writer adds `kGrace` to the lease end so that the mark,
+ * stored without a fence, is visible by the time it looks. Writers exclude each other with a
+ * mutex, and readers waiting for a writer sleep on the epoch.
+ */
+class LeaseLock final {
+    struct Slot;
+
+public:
+    /// Time a writer waits beyond a lease's end for a read that started just before it.
+    static constexpr std::chrono::nanoseconds kGrace{2000};
+
+    /**
+     * @brief Constructs the lock.
+     * @param maxReaders Readers that can hold a `Reader` at once.
+     * @param lease Length of a lease; the longest a writer waits for a reader that does not read.
+     */
+    LeaseLock(size_t maxReaders, std::chrono::nanoseconds lease)
+        : slots(maxReaders), leaseTicks(TscClock::ticks(lease)), graceTicks(TscClock::ticks(kGrace)) {}
+
+    LeaseLock(const LeaseLock&) = delete; /**< Deleted copy constructor. */
+    LeaseLock& operator=(const LeaseLock&) = delete; /**< Deleted copy assignment operator. */
+
+    /**
+     * @class Reader
+     * @brief One reader's handle, owning a slot; use it from one thread with `std::shared_lock`.
+     */
+    class Reader final {
+    public:
+        /**
+         * @brief Claims a slot of `lock`.
+         * @throws std::runtime_error If every slot is taken.
+         */
+        explicit Reader(LeaseLock& lock) : lock(lock), slot(lock.claim()) {}
+
+        /// Releases the lease, so no writer waits for it to end.
+        ~Reader() { slot.leaseEnd.store(0, std::memory_order_release); }
+
+        Reader(const Reader&) = delete; /**< Deleted copy constructor. */
+        Reader& operator=(const Reader&) = delete; /**< Deleted copy assignment operator. */
+
+        /// Starts a read, renewing the lease if it ended or a writer is waiting.
+        void lock_shared() {
+            slot.active.store(1, std::memory_order_relaxed);
+            std::atomic_signal_fence(std::memory_order_seq_cst);
+            if (TscClock::now() < slot.leaseEnd.load(std::memory_order_relaxed) &&
+                (lock.epoch.load(std::memory_order_acquire) & 1) == 0)
+                return;
+            renew();
+        }
+
+        /// Ends a read; the lease stays for the next one.
+        void unlock_shared() { slot.active.store(0, std::memory_order_release); }
+
+        /// @return Leases taken so far.
+        uint64_t renewals() const { return slot.renewals; }
+
+    private:
+        /// Releases the lease, waits while a writer is in and takes a new lease; returns active.
+        void renew() {
+            slot.leaseEnd.store(0, std::memory_order_relaxed);
+            for (;;) {
+                uint32_t epoch = lock.epoch.load(std::memory_order_acquire);
+                if (epoch & 1) {
+                    slot.active.store(0, std::memory_order_release);
+                    lock.waitForWriter(epoch);
+                    slot.active.store(1, std::memory_order_relaxed);
+                    continue;
+                }
+                slot.leaseEnd.store(TscClock::now() + lock.leaseTicks, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (lock.epoch.load(std::memory_order_acquire) == epoch) {
+                    ++slot.renewals;
+                    return;
+                }
+                slot.leaseEnd.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        LeaseLock& lock;  /**< The lock. */
+        Slot& slot;       /**< This reader's slot. */
+    };
+
+    /// Takes the lock exclusively: waits for other writers, then for every lease.
+    void lock() {
+        writers.lock();
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        for (Slot& slot : slots) {
+            for (;;) {
+                uint64_t end = slot.leaseEnd.load(std::memory_order_acquire);
+                bool expired = end == 0 || TscClock::now() >= end + graceTicks;
+                if (expired && slot.active.load(std::memory_order_acquire) == 0) break;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    /// Releases the exclusive lock and wakes sleeping readers.
+    void unlock() {
+        epoch.fetch_add(1, std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_seq_cst) > 0) Futex::wake(epoch, std::numeric_limits<int>::max());
+        writers.unlock();
+    }
+
+private:
+    /**
+     * @struct Slot
+     * @brief A reader's lease and active mark, on a cache line of its own.
+     */
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> leaseEnd{0};  /**< Tick at which the lease ends; 0 when released. */
+        std::atomic<uint32_t> active{0};    /**< Set while the reader reads. */
+        std::atomic<bool> claimed{false};   /**< Whether a `Reader` owns the slot. */
+        uint64_t renewals = 0;              /**< Leases taken, written by the owner only. */
+    };
+
+    /// @return A free slot, now claimed.
+    Slot& claim() {
+        for (Slot& slot : slots)
+            if (!slot.claimed.exchange(true)) return slot;
+        throw std::runtime_error("LeaseLock has no free reader slot");
+    }
+
+    /// Sleeps until the epoch moves on from the odd value `seen`.
+    void waitForWriter(uint32_t seen) {
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        while (epoch.load(std::memory_order_acquire) == seen) Futex::wait(epoch, seen);
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    alignas(64) std::atomic<uint32_t> epoch{0};  /**< Odd while a writer waits or writes. */
+    std::atomic<uint32_t> sleepers{0};           /**< Readers sleeping on the epoch. */
+    std::mutex writers;                          /**< Orders writers. */
+    std::vector<Slot> slots;                     /**< One per reader. */
+    uint64_t leaseTicks;                         /**< Length of a lease in clock ticks. */
+    uint64_t graceTicks;                         /**< `kGrace` in clock ticks. */
+};
+
+/**
+ * @class ParkingLot
+ * @brief A global table of wait queues keyed by address, so a lock needs only a few bits of state.
+ *
+ * A thread that must wait parks on an address: it locks the bucket the address hashes to,
+ * re-checks its condition through a `validate` callback, queues itself and sleeps on a futex
+ * word of its own. A waker unparks the threads queued on the address and tells the lock,
+ * still under the bucket lock, whether any remain, so the lock can clear its parked bit
+ * without racing a thread that is about to park. Queue entries live in the threads
+ * themselves, so the table costs the same whether one lock or millions exist, and only
+ * contended locks touch it.
+ */
+class ParkingLot final {
+public:
+    /**
+     * @brief Sleeps on `address` unless `validate()` fails.
+     * @param address Key of the queue, usually the lock word.
+     * @param validate Called under the bucket lock; the thread parks only if it returns true.
+     * @return Whether the thread parked and was unparked.
+     */
+    template <typename Validate>
+    static bool park(const void* address, Validate&& validate) {
+        ThreadData& self = threadData();
+        Bucket& bucket = bucketOf(address);
+        {
+            std::lock_guard<std::mutex> guard(bucket.mutex);
+            if (!validate()) return false;
+            self.address = address;
+            self.next = nullptr;
+            self.parked.store(1, std::memory_order_relaxed);
+            (bucket.tail ? bucket.tail->next : bucket.head) = &self;
+            bucket.tail = &self;
+        }
+        parks.fetch_add(1, std::memory_order_relaxed);
+        while (self.parked.load(std::memory_order_acquire)) Futex::wait(self.parked, 1);
+        return true;
+    }
+
+    /**
+     * @brief Wakes the oldest thread parked on `address`.
+     * @param address Key of the queue.
+     * @param callback Called under the bucket lock with whether threads remain parked on `address`.
+     * @return Whether a thread was woken.
+     */
+    template <typename Callback>
+    static bool unparkOne(const void* address, Callback&& callback) {
+        return unpark(address, false, std::forward<Callback>(callback)) > 0;
+    }
+
+    /**
+     * @brief Wakes every thread parked on `address`.
+     * @param address Key of the queue.
+     * @param callback Called under the bucket lock; no thread remains parked on `address`.
+     * @return The number of threads woken.
+     */
+    template <typename Callback>
+    static size_t unparkAll(const void* address, Callback&& callback) {
+        return unpark(address, true, [&](bool) { callback(); });
+    }
+
+    /// @return Parks since the program started.
+    static uint64_t parkCount() { return parks.load(std::memory_order_relaxed); }
+
+private:
+    /// Buckets in the table; a power of two.
+    static constexpr size_t kBuckets = 4096;
+
+    /**
+     * @struct ThreadData
+     * @brief A thread's queue entry and the futex word it sleeps on.
+     */
+    struct ThreadData {
+        std::atomic<uint32_t> parked{0};  /**< 1 while queued. */
+        const void* address = nullptr;    /**< Address parked on. */
+        ThreadData* next = nullptr;       /**< Next entry in the bucket. */
+    };
+
+    /**
+     * @struct Bucket
+     * @brief The queue of the threads parked on addresses that hash here, oldest first.
+     */
+    struct alignas(64) Bucket {
+        std::mutex mutex;             /**< Guards the queue. */
+        ThreadData* head = nullptr;   /**< Oldest entry. */
+        ThreadData* tail = nullptr;   /**< Newest entry. */
+    };
+
+    /// @return The calling thread's entry.
+    static ThreadData& threadData() {
+        static thread_local ThreadData data;
+        return data;
+    }
+
+    /// @return The bucket of an address, by Fibonacci hashing.
+    static Bucket& bucketOf(const void* address) {
+        static Bucket table[kBuckets];
+        uint64_t key = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(address)) * 0x9e3779b97f4a7c15ull;
+        return table[key >> (64 - 12)];
+    }
+
+    /// Dequeues one or all threads parked on `address`, calls back, then wakes them.
+    template <typename Callback>
+    static size_t unpark(const void* address, bool all, Callback&& callback) {
+        static_assert(kBuckets == 1 << 12, "bucketOf() takes 12 bits");
+        Bucket& bucket = bucketOf(address);
+        static thread_local std::vector<ThreadData*> woken;
+        woken.clear();
+        {
+            std::lock_guard<std::mutex> guard(bucket.mutex);
+            ThreadData* previous = nullptr;
+            bool more = false;
+            for (ThreadData* entry = bucket.head; entry;) {
+                ThreadData* next = entry->next;
+                if (entry->address != address) {
+                    previous = entry;
+                } else if (!all && !woken.empty()) {
+                    more = true;
+                    break;
+                } else {
+                    (previous ? previous->next : bucket.head) = next;
+                    if (bucket.tail == entry) bucket.tail = previous;
+                    woken.push_back(entry);
+                }
+                entry = next;
+            }
+            callback(more);
+            for (ThreadData* entry : woken) entry->parked.store(0, std::memory_order_release);
+        }
+        // A thread that saw 0 before its wake may have moved on; a stray wake is harmless
+        for (ThreadData* entry : woken) Futex::wake(entry->parked, 1);
+        return woken.size();
+    }
+
+    inline static std::atomic<uint64_t> parks{0}; /**< Parks since the program started. */
+};
+
+/**
+ * @class ParkingMutex
+ * @brief A one-byte mutex that parks its waiters in the `ParkingLot`.
+ *
+ * The byte holds a locked bit and a parked bit. An uncontended lock and unlock are one
+ * compare-and-swap each. A waiter spins briefly, then sets the parked bit and parks while
+ * the byte still reads locked and parked; an unlock that finds the parked bit wakes one
+ * waiter, which then competes for the lock like any other thread.
+ */
+class ParkingMutex final {
+public:
+    ParkingMutex() = default;
+    ParkingMutex(const ParkingMutex&) = delete; /**< Deleted copy constructor. */
+    ParkingMutex& operator=(const ParkingMutex&) = delete; /**< Deleted copy assignment operator. */
+
+    void lock() {
+        uint8_t expected = 0;
+        if (!state.compare_exchange_weak(expected, kLocked, std::memory_order_acquire, std::memory_order_relaxed)) lockSlow();
+    }
+
+    bool try_lock() {
+        uint8_t current = state.load(std::memory_order_relaxed);
+        return !(current & kLocked) &&
+               state.compare_exchange_strong(current, current | kLocked, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        uint8_t expected = kLocked;
+        if (!state.compare_exchange_strong(expected, 0, std::memory_order_release, std::memory_order_relaxed)) unlockSlow();
+    }
+
+private:
+    static constexpr uint8_t kLocked = 1; /**< Held. */
+    static constexpr uint8_t kParked = 2; /**< Threads may be parked on the byte. */
+    static constexpr int kSpins = 40;     /**< Tries before parking. */
+
+    void lockSlow() {
+        for (int spins = 0;; ++spins) {
+            uint8_t current = state.load(std::memory_order_relaxed);
+            if (!(current & kLocked)) {
+                if (state.compare_exchange_weak(current, current | kLocked, std::memory_order_acquire, std::memory_order_relaxed))
+                    return;
+                continue;
+            }
+            if (!(current & kParked)) {
+                if (spins < kSpins) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (!state.compare_exchange_weak(current, current | kParked, std::memory_order_relaxed, std::memory_order_relaxed))
+                    continue;
+            }
+            ParkingLot::park(&state, [this] { return state.load(std::memory_order_relaxed) == (kLocked | kParked); });
+        }
+    }
+
+    void unlockSlow() {
+        // Only the parked bit can be set besides ours, and only the unparker clears it
+        ParkingLot::unparkOne(&state, [this](bool more) { state.store(more ? kParked : 0, std::memory_order_release); });
+    }
+
+    std::atomic<uint8_t> state{0}; /**< Locked and parked bits. */
+};
+
+/**
+ * @class ParkingSharedMutex
+ * @brief A two-byte reader-writer lock that parks its waiters in the `ParkingLot`.
+ *
+ * The word holds a writer bit, a parked bit and a reader count of up to 16383. Readers enter
+ * with one compare-and-swap while no writer holds the lock and nobody is parked, so a parked
+ * writer stops new readers from overtaking it. Readers and writers park on the same address
+ * and every release that finds the parked bit wakes them all to compete again: the herd is
+ * the price of two bytes, and only contended locks pay it.
+ */
+class ParkingSharedMutex final {
+public:
+    ParkingSharedMutex() = default;
+    ParkingSharedMutex(const ParkingSharedMutex&) = delete; /**< Deleted copy constructor. */
+    ParkingSharedMutex& operator=(const ParkingSharedMutex&) = delete; /**< Deleted copy assignment operator. */
+
+    void lock() {
+        uint16_t expected = 0;
+        if (!state.compare_exchange_weak(expected, kWriter, std::memory_order_acquire, std::memory_order_relaxed)) acquire(true);
+    }
+
+    bool try_lock() {
+        uint16_t current = state.load(std::memory_order_relaxed);
+        return !(current & (kWriter | kReaders)) &&
+               state.compare_exchange_strong(current, current | kWriter, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock() {
+        if (state.fetch_and(static_cast<uint16_t>(~kWriter), std::memory_order_release) & kParked) wakeAll();
+    }
+
+    void lock_shared() {
+        uint16_t current = state.load(std::memory_order_relaxed);
+        if (!(current & (kWriter | kParked)) && current < kReaders &&
+            state.compare_exchange_weak(current, current + kOneReader, std::memory_order_acquire, std::memory_order_relaxed))
+            return;
+        acquire(false);
+    }
+
+    bool try_lock_shared() {
+        uint16_t current = state.load(std::memory_order_relaxed);
+        return !(current & kWriter) && (current & kReaders) != kReaders &&
+               state.compare_exchange_strong(current, current + kOneReader, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    void unlock_shared() {
+        uint16_t previous = state.fetch_sub(kOneReader, std::memory_order_release);
+        if ((previous & kReaders) == kOneReader && (previous & kParked)) wakeAll();
+    }
+
+private:
+    static constexpr uint16_t kWriter = 1;         /**< A writer holds the lock. */
+    static constexpr uint16_t kParked = 2;         /**< Threads may be parked on the word. */
+    static constexpr uint16_t kOneReader = 4;      /**< One reader in the count. */
+    static constexpr uint16_t kReaders = 0xfffc;   /**< Mask of the reader count. */
+    static constexpr int kSpins = 40;              /**< Tries before parking. */
+
+    /// @return Whether a thread seeing `current` must wait: a writer holds it, or readers do and others are parked.
+    static bool blocked(uint16_t current, bool exclusive) {
+        if (current & kWriter) return true;
+        if (exclusive) return (current & kReaders) != 0;
+        return (current & kReaders) == kReaders || ((current & kParked) && (current & kReaders));
+    }
+
+    /// Waits for the lock in either mode, spinning briefly and then parking.
+    void acquire(bool exclusive) {
+        for (int spins = 0;; ++spins) {
+            uint16_t current = state.load(std::memory_order_relaxed);
+            if (!blocked(current, exclusive)) {
+                uint16_t next = exclusive ? current | kWriter : current + kOneReader;
+                if (state.compare_exchange_weak(current, next, std::memory_order_acquire, std::memory_order_relaxed)) return;
+                continue;
+            }
+            if (!(current & kParked)) {
+                if (spins < kSpins) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                if (!state.compare_exchange_weak(current, current | kParked, std::memory_order_relaxed, std::memory_order_relaxed))
+                    continue;
+            }
+            ParkingLot::park(&state, [this, exclusive] {
+                uint16_t now = state.load(std::memory_order_relaxed);
+                return (now & kParked) && blocked(now, exclusive);
+            });
+        }
+    }
+
+    /// Wakes every parked thread and clears the parked bit under the bucket lock.
+    void wakeAll() {
+        ParkingLot::unparkAll(&state, [this] { state.fetch_and(static_cast<uint16_t>(~kParked), std::memory_order_relaxed); });
+    }
+
+    std::atomic<uint16_t> state{0}; /**< Writer bit, parked bit and reader count. */
+};
+
+/**
+ * @class IoUring
+ * @brief A minimal io_uring instance driven through the raw system calls.
+ *
+ * Maps the submission and completion rings, hands out zeroed submission entries and reaps
+ * completions, so no liburing is needed. Opcodes newer than the installed kernel headers are
+ * defined here; `supports()` asks the running kernel whether it implements them.
+ */
+class IoUring final {
+public:
+    /// `IORING_OP_FUTEX_WAIT`, added in Linux 6.7 and missing from older headers.
+    static constexpr uint8_t kOpFutexWait = 51;
+    /// futex2 flags of a futex operation on a process-private 32-bit word.
+    static constexpr uint32_t kFutex2PrivateU32 = 0x02 | 128;
+
+    /**
+     * @brief Creates the ring.
+     * @param entries Submission queue size; the completion queue is twice as large.
+     * @throws std::runtime_error If the kernel has no io_uring or refuses to create one.
+     */
+    explicit IoUring(unsigned entries) {
+        io_uring_params params{};
+        fd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (fd < 0) throw std::runtime_error(std::string("io_uring_setup failed: ") + std::strerror(errno));
+        sqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+        cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqRingSize = cqRingSize = std::max(sqRingSize, cqRingSize);
+        sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqRing = mmap(nullptr, sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+        cqRing = single ? sqRing : mmap(nullptr, cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+        void* entriesMap = mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+        if (sqRing == MAP_FAILED || cqRing == MAP_FAILED || entriesMap == MAP_FAILED) {
+            int error = errno;
+            if (entriesMap != MAP_FAILED) munmap(entriesMap, sqesSize);
+            if (!single && cqRing != MAP_FAILED) munmap(cqRing, cqRingSize);
+            if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+            close(fd);
+            throw std::runtime_error(std::string("cannot map io_uring: ") + std::strerror(error));
+        }
+        sqes = static_cast<io_uring_sqe*>(entriesMap);
+        char* sq = static_cast<char*>(sqRing);
+        char* cq = static_cast<char*>(cqRing);
+        sqHead = reinterpret_cast<std::atomic<uint32_t>*>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<std::atomic<uint32_t>*>(sq + params.sq_off.tail);
+        sqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+        sqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+        sqEntries = params.sq_entries;
+        cqHead = reinterpret_cast<std::atomic<uint32_t>*>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<std::atomic<uint32_t>*>(cq + params.cq_off.tail);
+        cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        cqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+        localTail = sqTail->load(std::memory_order_relaxed);
+
+        std::vector<char> probe(sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op), 0);
+        if (syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe.data(), 256) == 0) {
+            auto* ops = reinterpret_cast<io_uring_probe*>(probe.data());
+            for (int op = 0; op <= ops->last_op && op < 256; ++op)
+                supported[op] = ops->ops[op].flags & IO_URING_OP_SUPPORTED;
+        }
+    }
+
+    IoUring(const IoUring&) = delete;
+    IoUring& operator=(const IoUring&) = delete;
+
+    ~IoUring() {
+        munmap(sqes, sqesSize);
+        if (cqRing != sqRing) munmap(cqRing, cqRingSize);
+        munmap(sqRing, sqRingSize);
+        close(fd);
+    }
+
+    /// @return Whether the running kernel implements `opcode`.
+    bool supports(uint8_t opcode) const { return supported[opcode]; }
+
+    /**
+     * @brief Reserves the next submission entry; it is sent with the next `submit()`.
+     * @param userData Value returned with the completion.
+     * @return A zeroed entry with `user_data` set, or null if the queue is full.
+     */
+    io_uring_sqe* next(uint64_t userData) {
+        if (localTail - sqHead->load(std::memory_order_acquire) >= sqEntries) return nullptr;
+        uint32_t index = localTail & sqMask;
+        io_uring_sqe* sqe = &sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->user_data = userData;
+        sqArray[index] = index;
+        ++localTail;
+        return sqe;
+    }
+
+    /**
+     * @brief Prepares a wait that completes once `word` is woken, or at once if it differs from `expected`.
+     * @param sqe Entry from `next()`.
+     * @param word The futex word.
+     * @param expected Value the caller last saw in the word.
+     */
+    static void prepareFutexWait(io_uring_sqe* sqe, std::atomic<uint32_t>& word, uint32_t expected) {
+        sqe->opcode = kOpFutexWait;
+        sqe->fd = static_cast<int32_t>(kFutex2PrivateU32);
+        sqe->addr = reinterpret_cast<uintptr_t>(&word);
+        sqe->off = expected;
+        sqe->addr3 = FUTEX_BITSET_MATCH_ANY;
+    }
+
+    /**
+     * @brief Submits the reserved entries and optionally waits for completions.
+     * @param waitFor Completions to wait for; 0 returns at once.
+     * @throws std::runtime_error If the kernel rejects the submission.
+     */
+    void submit(unsigned waitFor = 0) {
+        sqTail->store(localTail, std::memory_order_release);
+        unsigned pending = localTail - submitted;
+        long result = syscall(__NR_io_uring_enter, fd, pending, waitFor, waitFor ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+        if (result < 0 && errno != EINTR && errno != EBUSY && errno != EAGAIN)
+            throw std::runtime_error(std::string("io_uring_enter failed: ") + std::strerror(errno));
+        if (result > 0) submitted += static_cast<uint32_t>(result);
+    }
+
+    /**
+     * @brief Passes every available completion to `handler` and releases it.
+     * @param handler Called as `handler(userData, result)`.
+     * @return The number of completions handled.
+     */
+    template <typename Handler>
+    unsigned reap(Handler&& handler) {
+        uint32_t head = cqHead->load(std::memory_order_relaxed);
+        uint32_t tail = cqTail->load(std::memory_order_acquire);
+        unsigned handled = 0;
+        for (; head != tail; ++head, ++handled) {
+            const io_uring_cqe& cqe = cqes[head & cqMask];
+            uint64_t userData = cqe.user_data;
+            int32_t result = cqe.res;
+            cqHead->store(head + 1, std::memory_order_release);
+            handler(userData, result);
+        }
+        return handled;
+    }
+
+private:
+    int fd = -1;                                /**< The ring. */
+    void* sqRing = nullptr;                     /**< Mapped submission ring. */
+    void* cqRing = nullptr;                     /**< Mapped completion ring; the same mapping on most kernels. */
+    io_uring_sqe* sqes = nullptr;               /**< Mapped submission entries. */
+    size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0; /**< Sizes of the three mappings. */
+    std::atomic<uint32_t>* sqHead = nullptr;    /**< Consumed by the kernel. */
+    std::atomic<uint32_t>* sqTail = nullptr;    /**< Published by `submit()`. */
+    uint32_t* sqArray = nullptr;                /**< Indirection from ring slots to entries. */
+    uint32_t sqMask = 0, sqEntries = 0;         /**< Submission ring geometry. */
+    std::atomic<uint32_t>* cqHead = nullptr;    /**< Advanced by `reap()`. */
+    std::atomic<uint32_t>* cqTail = nullptr;    /**< Advanced by the kernel. */
+    io_uring_cqe* cqes = nullptr;               /**< Completion entries. */
+    uint32_t cqMask = 0;                        /**< Completion ring mask. */
+    uint32_t localTail = 0;                     /**< Entries reserved so far. */
+    uint32_t submitted = 0;                     /**< Entries the kernel accepted so far. */
+    std::array<bool, 256> supported{};          /**< Probed opcodes. */
+};
+
+/**
+ * @class AsyncSharedLock
+ * @brief A reader-writer lock on one futex word that event loops can wait for without blocking.
+ *
+ * The word holds a writer bit, a waiters bit and the reader count. Blocking callers sleep on
+ * the word with the futex system call. An event loop instead tries the lock and, if that
+ * fails, arms a wait with `prepareWait()` and either submits `IORING_OP_FUTEX_WAIT` for the
+ * value it saw, which completes as a ring event when an unlock wakes the word, or parks an
+ * eventfd that the next waking unlock signals. Either way the loop retries the lock when the
+ * event arrives and keeps serving its other requests in the meantime. Unlocks wake every
+ * waiter, as a futex-based lock without a queue has to.
+ */
+class AsyncSharedLock final {
+public:
+    static constexpr uint32_t kWriter = 1u << 31;  /**< Held exclusively. */
+    static constexpr uint32_t kWaiters = 1u << 30; /**< Someone sleeps on the word or parked an eventfd. */
+
+    /// @return True if a shared hold was taken.
+    bool tryLockShared() {
+        uint32_t state = word.load(std::memory_order_relaxed);
+        while (!(state & kWriter))
+            if (word.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) return true;
+        return false;
+    }
+
+    /// @return True if the exclusive hold was taken.
+    bool tryLock() {
+        uint32_t state = word.load(std::memory_order_relaxed);
+        while ((state & ~kWaiters) == 0)
+            if (word.compare_exchange_weak(state, state | kWriter, std::memory_order_acquire, std::memory_order_relaxed)) return true;
+        return false;
+    }
+
+    /// Takes a shared hold, sleeping in the futex system call while a writer holds the lock.
+    void lockShared() {
+        uint32_t expected;
+        while (!tryLockShared())
+            if (prepareWait(expected, false)) Futex::wait(word, expected);
+    }
+
+    /// Takes the exclusive hold, sleeping in the futex system call while anyone holds the lock.
+    void lock() {
+        uint32_t expected;
+        while (!tryLock())
+            if (prepareWait(expected, true)) Futex::wait(word, expected);
+    }
+
+    /// Releases a shared hold; the last reader wakes the waiters.
+    void unlockShared() {
+        uint32_t previous = word.fetch_sub(1, std::memory_order_release);
+        if ((previous & ~kWaiters) == 1 && (previous & kWaiters)) wakeAll();
+    }
+
+    /// Releases the exclusive hold and wakes the waiters.
+    void unlock() {
+        if (word.fetch_and(~kWriter, std::memory_order_release) & kWaiters) wakeAll();
+    }
+
+    /**
+     * @brief Sets the waiters bit so the next unlock wakes the word.
+     * @param expected Receives the value to wait for; the wait ends at once if the word changed.
+     * @param exclusive Whether the caller waits for an exclusive hold.
+     * @return False if the lock became available and the caller should try again instead.
+     */
+    bool prepareWait(uint32_t& expected, bool exclusive) {
+        uint32_t state = word.load(std::memory_order_relaxed);
+        for (;;) {
+            bool busy = exclusive ? (state & ~kWaiters) != 0 : (state & kWriter) != 0;
+            if (!busy) return false;
+            if (state & kWaiters) break;
+            if (word.compare_exchange_weak(state, state | kWaiters, std::memory_order_relaxed)) {
+                state |= kWaiters;
+                break;
+            }
+        }
+        expected = state;
+        return true;
+    }
+
+    /**
+     * @brief Parks an eventfd that the next waking unlock increments.
+     * @param eventFd The eventfd of the waiting loop.
+     * @return False if the lock became available and the caller should try again instead.
+     */
+    bool park(int eventFd) {
+        std::lock_guard<std::mutex> guard(parkedMutex);
+        uint32_t expected;
+        if (!prepareWait(expected, false)) return false;
+        parked.push_back(eventFd);
+        return true;
+    }
+
+    /// @return The futex word, for `IoUring::prepareFutexWait()`.
+    std::atomic<uint32_t>& futexWord() { return word; }
+
+private:
+    /// Clears the waiters bit, then wakes the sleepers and signals the parked eventfds.
+    void wakeAll() {
+        word.fetch_and(~kWaiters, std::memory_order_relaxed);
+        Futex::wake(word, std::numeric_limits<int>::max());
+        std::lock_guard<std::mutex> guard(parkedMutex);
+        for (int eventFd : parked) {
+            uint64_t one = 1;
+            if (write(eventFd, &one, sizeof(one)) < 0) continue;
+        }
+        parked.clear();
+    }
+
+    alignas(64) std::atomic<uint32_t> word{0}; /**< Writer bit, waiters bit and reader count. */
+    std::mutex parkedMutex;                    /**< Guards `parked`. */
+    std::vector<int> parked;                   /**< Eventfds to signal at the next waking unlock. */
+};
+
+/**
+ * @class HandoffSharedLock
+ * @brief A FIFO reader-writer lock that hands ownership to queued continuations.
+ *
+ * Models the async mutex of coroutine libraries in C++17: a waiter that cannot get the lock
+ * queues a continuation instead of sleeping, and the unlock that makes it eligible takes the
+ * lock on the waiter's behalf and resumes the continuation, so the waiter neither retries nor
+ * gets overtaken. Consecutive readers at the head of the queue are granted together.
+ */
+class HandoffSharedLock final {
+public:
+    using Continuation = std::function<void()>; /**< Resumes a waiter that now holds the lock. */
+
+    /**
+     * @brief Takes a shared hold now or queues `resume` to run once one was granted.
+     * @param resume Continuation of the waiter; runs on the thread of the granting unlock.
+     * @return True if the hold was taken at once and `resume` will not run.
+     */
+    bool lockShared(Continuation resume) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (!writer && queue.empty()) {
+            ++readers;
+            return true;
+        }
+        queue.push_back({false, std::move(resume)});
+        return false;
+    }
+
+    /**
+     * @brief Takes the exclusive hold, sleeping on a futex until it was handed over.
+     *
+     * The futex word is the thread's own and outlives the call: the granting thread wakes it
+     * after the store this thread may already have seen and returned on.
+     */
+    void lock() {
+        static thread_local std::atomic<uint32_t> granted{0};
+        granted.store(0, std::memory_order_relaxed);
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (!writer && readers == 0 && queue.empty()) {
+                writer = true;
+                return;
+            }
+            std::atomic<uint32_t>* word = &granted;
+            queue.push_back({true, [word] {
+                                 word->store(1, std::memory_order_release);
+                                 Futex::wake(*word, 1);
+                             }});
+        }
+        while (granted.load(std::memory_order_acquire) == 0) Futex::wait(granted, 0);
+    }
+
+    /// Releases a shared hold; the last reader hands the lock on.
+    void unlockShared() {
+        std::vector<Continuation> ready;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (--readers == 0) grant(ready);
+        }
+        for (auto& resume : ready) resume();
+    }
+
+    /// Releases the exclusive hold and hands the lock on.
+    void unlock() {
+        std::vector<Continuation> ready;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            writer = false;
+            grant(ready);
+        }
+        for (auto& resume : ready) resume();
+    }
+
+private:
+    /**
+     * @struct Waiter
+     * @brief A queued request for the lock.
+     */
+    struct Waiter {
+        bool exclusive;      /**< Whether the waiter wants the exclusive hold. */
+        Continuation resume; /**< Runs once the hold was granted. */
+    };
+
+    /// Grants the lock to the head of the queue, or to every reader at its head; the caller holds `mutex`.
+    void grant(std::vector<Continuation>& ready) {
+        if (queue.empty()) return;
+        if (queue.front().exclusive) {
+            if (readers > 0) return;
+            writer = true;
+            ready.push_back(std::move(queue.front().resume));
+            queue.pop_front();
+            return;
+        }
+        while (!queue.empty() && !queue.front().exclusive) {
+            ++readers;
+            ready.push_back(std::move(queue.front().resume));
+            queue.pop_front();
+        }
+    }
+
+    std::mutex mutex;          /**< Guards the state and the queue. */
+    int readers = 0;           /**< Shared holds. */
+    bool writer = false;       /**< Whether the exclusive hold is taken. */
+    std::deque<Waiter> queue;  /**< Waiters in arrival order. */
+};
+
+/**
+ * @class WaitAny
+ * @brief Blocks a thread until any one of several locks or eventcounts may have become available.
+ *
+ * The caller adds every object it could use; each `add()` arms a wait on the object's futex
+ * word, and a lock that is available already is reported instead so the caller can take it.
+ * `wait()` then sleeps on all words at once and returns the first object that changed. After
+ * it returns the caller retries and, if it still has to wait, clears and adds again.
+ */
+class WaitAny final {
+public:
+    /// @param poll Poll the words even if the kernel has `futex_waitv`.
+    explicit WaitAny(bool poll = false) : poll(poll) {}
+
+    WaitAny(const WaitAny&) = delete;
+    WaitAny& operator=(const WaitAny&) = delete;
+
+    ~WaitAny() { clear(); }
+
+    /**
+     * @brief Arms a wait for a lock.
+     * @param lock The lock.
+     * @param exclusive Whether the caller needs the exclusive hold.
+     * @return False if the lock is available and was not added.
+     */
+    bool add(AsyncSharedLock& lock, bool exclusive) {
+        uint32_t expected;
+        if (!lock.prepareWait(expected, exclusive)) return false;
+        words.push_back({&lock.futexWord(), expected});
+        return true;
+    }
+
+    /**
+     * @brief Arms a wait for an eventcount; re-check the condition afterwards, as with `EventCount::prepareWait()`.
+     * @param events The eventcount.
+     */
+    void add(EventCount& events) {
+        EventCount::Key key = events.prepareWait();
+        words.push_back({&events.futexWord(), key});
+        eventCounts.push_back(&events);
+    }
+
+    /// @return Index, in the order of `add()`, of an object that changed, or -1 if none is known to have.
+    int wait() const { return Futex::waitAny(words, poll); }
+
+    /// Withdraws all armed waits.
+    void clear() {
+        for (EventCount* events : eventCounts) events->cancelWait();
+        eventCounts.clear();
+        words.clear();
+    }
+
+private:
+    bool poll;                               /**< Poll instead of `futex_waitv`. */
+    std::vector<Futex::Expected> words;      /**< Armed words and the values they held. */
+    std::vector<EventCount*> eventCounts;    /**< Eventcounts whose waits must be withdrawn. */
+};
+
+/**
+ * @class SpscQueue
+ * @brief A bounded single-producer single-consumer ring without locks.
+ * @tparam T Element type; must be default-constructible and copyable.
+ *
+ * The producer owns the tail and the consumer the head, each on its own cache line. Both
+ * keep a cached copy of the other side's index and reread it only when the ring looks full
+ * or empty, so a steady stream of messages moves about one shared line per batch instead of
+ * one per message.
+ */
+template <typename T>
+class SpscQueue final {
+public:
+    /**
+     * @brief Allocates the ring.
+     * @param capacity Minimum number of elements; rounded up to a power of two.
+     */
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size *= 2;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    SpscQueue(const SpscQueue&) = delete; /**< Deleted copy constructor. */
+    SpscQueue& operator=(const SpscQueue&) = delete; /**< Deleted copy assignment operator. */
+
+    /**
+     * @brief Appends an element; producer only.
+     * @return False if the ring is full.
+     */
+    bool push(const T& value) {
+        size_t tail = producer.index.load(std::memory_order_relaxed);
+        if (tail - producer.cached > mask) {
+            producer.cached = consumer.index.load(std::memory_order_acquire);
+            if (tail - producer.cached > mask) return false;
+        }
+        slots[tail & mask] = value;
+        producer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Removes the oldest element; consumer only.
+     * @return False if the ring is empty.
+     */
+    bool pop(T& value) {
+        size_t head = consumer.index.load(std::memory_order_relaxed);
+        if (head == consumer.cached) {
+            consumer.cached = producer.index.load(std::memory_order_acquire);
+            if (head == consumer.cached) return false;
+        }
+        value = slots[head & mask];
+        consumer.index.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    /**
+     * @struct Side
+     * @brief The index one side advances and its cached view of the other side's.
+     */
+    struct alignas(64) Side {
+        std::atomic<size_t> index{0}; /**< Next slot to write (producer) or read (consumer). */
+        size_t cached = 0;            /**< Last seen index of the other side. */
+    };
+
+    Side producer;          /**< Tail and the cached head. */
+    Side consumer;          /**< Head and the cached tail. */
+    std::vector<T> slots;   /**< The ring. */
+    size_t mask = 0;        /**< Ring size minus one. */
+};
+
+/**
+ * @struct NumaTopology
+ * @brief The NUMA nodes of the machine, the CPUs that belong to each, and memory policy syscalls.
+ *
+ * Read once from `/sys/devices/system/node`; machines or containers without that directory
+ * are reported as a single node holding every CPU. Memory policies are set with the raw
+ * `mbind` and `set_mempolicy` system calls, so no libnuma is needed.
+ */
+struct NumaTopology {
+    std::vector<int> nodes;     /**< Online node ids, ascending. */
+    std::map<int, int> cpuNode; /**< Node of each CPU listed by sysfs. */
+
+    /// @return The topology of this machine.
+    static const NumaTopology& get() {
+        static const NumaTopology topology = [] {
+            NumaTopology t;
+            std::ifstream online("/sys/devices/system/node/online");
+            std::string list;
+            if (online >> list) t.nodes = parseCpuList(list);
+            for (int node : t.nodes) {
+                std::ifstream cpus("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+                std::string cpuList;
+                if (cpus >> cpuList)
+                    for (int cpu : parseCpuList(cpuList)) t.cpuNode[cpu] = node;
+            }
+            if (t.nodes.empty()) t.nodes.push_back(0);
+            return t;
+        }();
+        return topology;
+    }
+
+    /// @return The node of a CPU, or the first node if the CPU is unknown.
+    int nodeOf(int cpu) const {
+        auto it = cpuNode.find(cpu);
+        return it != cpuNode.end() ? it->second : nodes.front();
+    }
+
+    /**
+     * @brief Parses a kernel CPU or node list such as `0-3,8,10-11`.
+     * @param list The list.
+     * @return The listed numbers in order.
+     */
+    static std::vector<int> parseCpuList(const std::string& list) {
+        std::vector<int> values;
+        std::istringstream in(list);
+        for (std::string range; std::getline(in, range, ',');) {
+            if (range.empty()) continue;
+            size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int value = first; value <= last; ++value) values.push_back(value);
+        }
+        return values;
+    }
+
+    /**
+     * @brief Returns the node holding the page at an address.
+     * @param address Any address inside a page that has been touched.
+     * @return The node, or -1 if the kernel cannot tell (no NUMA support, page not present).
+     */
+    static int nodeOfAddress(const void* address) {
+        int node = -1;
+        if (syscall(SYS_get_mempolicy, &node, nullptr, 0, const_cast<void*>(address), kMpolFNode | kMpolFAddr) != 0) return -1;
+        return node;
+    }
+
+    /**
+     * @brief Sets the memory policy of a range of pages with `mbind()`.
+     * @param address Start of the range; rounded down to a page boundary.
+     * @param length Length of the range in bytes.
+     * @param mode `kMpolBind`, `kMpolInterleave` or `kMpolPreferred`.
+     * @param policyNodes Nodes of the policy.
+     * @param move Also migrate pages that are already present.
+     * @return False with `errno` set if the kernel refused.
+     */
+    static bool bind(const void* address, size_t length, int mode, const std::vector<int>& policyNodes, bool move) {
+        uintptr_t page = static_cast<uintptr_t>(sysconf(_SC_PAGESIZE));
+        uintptr_t begin = reinterpret_cast<uintptr_t>(address) & ~(page - 1);
+        uintptr_t end = (reinterpret_cast<uintptr_t>(address) + length + page - 1) & ~(page - 1);
+        std::vector<unsigned long> mask = nodeMask(policyNodes);
+        return syscall(SYS_mbind, begin, end - begin, mode, mask.data(), mask.size() * 64 + 1, move ? kMpolMfMove : 0) == 0;
+    }
+
+    /**
+     * @brief Sets the memory policy of the calling thread with `set_mempolicy()`.
+     * @param mode A policy mode, or `kMpolDefault` to restore first-touch allocation.
+     * @param policyNodes Nodes of the policy; ignored for `kMpolDefault`.
+     * @return False with `errno` set if the kernel refused.
+     */
+    static bool setThreadPolicy(int mode, const std::vector<int>& policyNodes) {
+        if (mode == kMpolDefault) return syscall(SYS_set_mempolicy, kMpolDefault, nullptr, 0) == 0;
+        std::vector<unsigned long> mask = nodeMask(policyNodes);
+        return syscall(SYS_set_mempolicy, mode, mask.data(), mask.size() * 64 + 1) == 0;
+    }
+
+    // Memory policy constants from <linux/mempolicy.h>, kept here to avoid a libnuma dependency
+    static constexpr int kMpolDefault = 0;    /**< Allocate on the node of the touching CPU. */
+    static constexpr int kMpolPreferred = 1;  /**< Prefer one node, fall back to others. */
+    static constexpr int kMpolBind = 2;       /**< Allocate only on the given nodes. */
+    static constexpr int kMpolInterleave = 3; /**< Spread pages round-robin over the given nodes. */
+    static constexpr int kMpolFNode = 1;      /**< get_mempolicy: return a node instead of the policy. */
+    static constexpr int kMpolFAddr = 2;      /**< get_mempolicy: look up the page at an address. */
+    static constexpr int kMpolMfMove = 2;     /**< mbind: migrate pages that do not match the policy. */
+
+private:
+    /// @return A kernel node bitmask with the given nodes set.
+    static std::vector<unsigned long> nodeMask(const std::vector<int>& policyNodes) {
+        int highest = policyNodes.empty() ? 0 : *std::max_element(policyNodes.begin(), policyNodes.end());
+        std::vector<unsigned long> mask(highest / 64 + 1, 0);
+        for (int node : policyNodes) mask[node / 64] |= 1ul << (node % 64);
+        return mask;
+    }
+};
+
+/**
+ * @struct MemoryPlacement
+ * @brief Where a benchmark object (SharedData, its text buffer, the lock words) is placed in memory.
+ *
+ * `writer` and `reader` let the first writer or reader's CPU touch the memory first, so the
+ * kernel's default first-touch policy puts it on that CPU's node. `interleave` spreads pages
+ * over all nodes and `node:N` binds them to one node. `default` leaves placement as it was.
+ */
+struct MemoryPlacement {
+    /// The placement strategies.
+    enum class Mode { Default, Writer, Reader, Interleave, Node };
+
+    Mode mode = Mode::Default; /**< Placement strategy. */
+    int node = 0;              /**< Target node of `Mode::Node`. */
+
+    /**
+     * @brief Parses `default`, `writer`, `reader`, `interleave` or `node:N`.
+     * @param text The specification.
+     * @return The parsed placement.
+     * @throws std::invalid_argument For unknown strategies or nodes that are not online.
+     */
+    static MemoryPlacement parse(const std::string& text) {
+        MemoryPlacement placement;
+        if (text == "default") placement.mode = Mode::Default;
+        else if (text == "writer") placement.mode = Mode::Writer;
+        else if (text == "reader") placement.mode = Mode::Reader;
+        else if (text == "interleave") placement.mode = Mode::Interleave;
+        else if (text.compare(0, 5, "node:") == 0) {
+            placement.mode = Mode::Node;
+            placement.node = std::stoi(text.substr(5));
+            const std::vector<int>& nodes = NumaTopology::get().nodes;
+            if (std::find(nodes.begin(), nodes.end(), placement.node) == nodes.end())
+                throw std::invalid_argument("NUMA node " + std::to_string(placement.node) + " is not online");
+        } else {
+            throw std::invalid_argument("unknown placement '" + text + "' (use default, writer, reader, interleave or node:N)");
+        }
+        return placement;
+    }
+
+    /// @return Whether placement is left to the allocator.
+    bool isDefault() const { return mode == Mode::Default; }
+
+    /// @return Whether the placement relies on which thread touches the memory first.
+    bool firstTouch() const { return mode == Mode::Writer || mode == Mode::Reader; }
+
+    /// @return The specification in the form `parse()` accepts.
+    std::string describe() const {
+        switch (mode) {
+        case Mode::Writer: return "writer";
+        case Mode::Reader: return "reader";
+        case Mode::Interleave: return "interleave";
+        case Mode::Node: return "node:" + std::to_string(node);
+        default: return "default";
+        }
+    }
+
+    /**
+     * @brief Applies an explicit policy (`interleave`, `node:N`) to a range of pages.
+     * @param address Start of the range.
+     * @param length Length of the range in bytes.
+     * @param move Also migrate pages that are already present.
+     * @return False if the kernel refused; first-touch and default placements always succeed.
+     */
+    bool bind(const void* address, size_t length, bool move) const {
+        if (mode == Mode::Interleave) return NumaTopology::bind(address, length, NumaTopology::kMpolInterleave, NumaTopology::get().nodes, move);
+        if (mode == Mode::Node) return NumaTopology::bind(address, length, NumaTopology::kMpolBind, {node}, move);
+        return true;
+    }
+
+    /**
+     * @brief Makes the calling thread allocate new pages according to an explicit policy.
+     * @return False if the kernel refused; call `NumaTopology::setThreadPolicy(kMpolDefault, {})` afterwards.
+     */
+    bool applyToThread() const {
+        if (mode == Mode::Interleave) return NumaTopology::setThreadPolicy(NumaTopology::kMpolInterleave, NumaTopology::get().nodes);
+        if (mode == Mode::Node) return NumaTopology::setThreadPolicy(NumaTopology::kMpolBind, {node});
+        return true;
+    }
+};
+
+/**
+ * @class PlacedObject
+ * @brief An object constructed on pages of its own, so its memory policy can be chosen.
+ * @tparam T Type of the object; must be default-constructible.
+ *
+ * The pages come straight from `mmap()` and are touched for the first time by the thread
+ * that calls `create()`, after an explicit policy has been applied to them.
+ */
+template <typename T>
+class PlacedObject final {
+public:
+    PlacedObject() = default;
+    ~PlacedObject() { reset(); }
+    PlacedObject(const PlacedObject&) = delete; /**< Deleted copy constructor. */
+    PlacedObject& operator=(const PlacedObject&) = delete; /**< Deleted copy assignment operator. */
+
+    /**
+     * @brief Destroys the current object and constructs a fresh one on new pages.
+     * @param placement Placement whose explicit policy, if any, is applied before construction.
+     * @throws std::runtime_error If the pages cannot be mapped.
+     */
+    void create(const MemoryPlacement& placement) {
+        reset();
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        length = (sizeof(T) + page - 1) / page * page;
+        void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) throw std::runtime_error(std::string("cannot map placed object: ") + std::strerror(errno));
+        if (!placement.bind(memory, length, false) && !policyWarned.exchange(true))
+            std::cerr << "Warning: cannot apply placement " << placement.describe() << ": " << std::strerror(errno) << std::endl;
+        object = new (memory) T();
+    }
+
+    /// Destroys the object and unmaps its pages.
+    void reset() {
+        if (!object) return;
+        object->~T();
+        munmap(object, length);
+        object = nullptr;
+    }
+
+    T& operator*() const { return *object; }   /**< @return The object. */
+    T* operator->() const { return object; }   /**< @return Pointer to the object. */
+    T* get() const { return object; }          /**< @return Pointer to the object, or null before `create()`. */
+
+private:
+    T* object = nullptr; /**< The object, or null. */
+    size_t length = 0;   /**< Length of the mapping. */
+    inline static std::atomic<bool> policyWarned{false}; /**< Whether a refused policy was reported. */
+};
+
+/**
+ * @struct StreamingCopy
+ * @brief Copy and fill kernels whose stores bypass the caches, chosen at run time.
+ *
+ * Non-temporal stores write whole lines to memory without first reading them into the cache,
+ * so copying a payload larger than the last-level cache does not evict everyone else's
+ * working set, lock lines included. The price is that the next reader of the destination
+ * misses. The kernels form a fallback chain from AVX (32-byte stores) to SSE2 (16-byte
+ * stores); the first entry is always plain `memcpy`/`memset` for comparison, and on other
+ * architectures it is the only one. Streaming kernels end with a store fence, so the data is
+ * visible before the caller publishes it, e.g. by unlocking.
+ */
+struct StreamingCopy {
+    using CopyKernel = void (*)(void* destination, const void* source, size_t length); /**< Copies like `memcpy`. */
+    using FillKernel = void (*)(void* destination, int value, size_t length);          /**< Fills like `memset`. */
+
+    /**
+     * @struct Kernels
+     * @brief A matching pair of copy and fill kernels.
+     */
+    struct Kernels {
+        const char* name; /**< `memcpy`, `sse2` or `avx`. */
+        CopyKernel copy;  /**< The copy kernel. */
+        FillKernel fill;  /**< The fill kernel. */
+    };
+
+    /// @return `memcpy` followed by every streaming variant this CPU supports, narrowest first.
+    static const std::vector<Kernels>& available() {
+        static const std::vector<Kernels> kernels = [] {
+            std::vector<Kernels> list = {{"memcpy", [](void* d, const void* s, size_t n) { std::memcpy(d, s, n); },
+                                          [](void* d, int v, size_t n) { std::memset(d, v, n); }}};
+#if defined(__x86_64__)
+            list.push_back({"sse2", copySse2, fillSse2});
+            if (__builtin_cpu_supports("avx")) list.push_back({"avx", copyAvx, fillAvx});
+#endif
+            return list;
+        }();
+        return kernels;
+    }
+
+    /**
+     * @brief Looks up kernels by name.
+     * @param name `memcpy`, `sse2`, `avx`, or `stream` for the widest streaming kernels available.
+     * @return The kernels.
+     * @throws std::invalid_argument If the name is unknown or the CPU lacks the instructions.
+     */
+    static const Kernels& find(const std::string& name) {
+        const std::vector<Kernels>& kernels = available();
+        if (name == "stream") {
+            if (kernels.size() < 2) throw std::invalid_argument("no streaming copy kernels on this CPU");
+            return kernels.back();
+        }
+        for (const Kernels& k : kernels)
+            if (name == k.name) return k;
+        throw std::invalid_argument("copy kernel '" + name + "' is unknown or unsupported here (use memcpy, sse2, avx or stream)");
+    }
+
+private:
+#if defined(__x86_64__)
+    /// Copies the unaligned head of `d` with `memcpy` and returns its length, so streaming stores start aligned.
+    static size_t alignHead(void* d, size_t n, size_t alignment) {
+        size_t head = (alignment - reinterpret_cast<uintptr_t>(d) % alignment) % alignment;
+        return std::min(head, n);
+    }
+
+    static void copySse2(void* destination, const void* source, size_t n) {
+        auto* d = static_cast<char*>(destination);
+        auto* s = static_cast<const char*>(source);
+        size_t head = alignHead(d, n, 16);
+        std::memcpy(d, s, head);
+        size_t i = head;
+        for (; i + 64 <= n; i += 64) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 32));
+            __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 48));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + i), a);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + i + 16), b);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + i + 32), c);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(d + i + 48), e);
+        }
+        std::memcpy(d + i, s + i, n - i);
+        _mm_sfence();
+    }
+
+    static void fillSse2(void* destination, int value, size_t n) {
+        auto* d = static_cast<char*>(destination);
+        size_t head = alignHead(d, n, 16);
+        std::memset(d, value, head);
+        __m128i v = _mm_set1_epi8(static_cast<char>(value));
+        size_t i = head;
+        for (; i + 16 <= n; i += 16) _mm_stream_si128(reinterpret_cast<__m128i*>(d + i), v);
+        std::memset(d + i, value, n - i);
+        _mm_sfence();
+    }
+
+    __attribute__((target("avx"))) static void copyAvx(void* destination, const void* source, size_t n) {
+        auto* d = static_cast<char*>(destination);
+        auto* s = static_cast<const char*>(source);
+        size_t head = alignHead(d, n, 32);
+        std::memcpy(d, s, head);
+        size_t i = head;
+        for (; i + 64 <= n; i += 64) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(s + i + 32));
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(d + i), a);
+            _mm256_stream_si256(reinterpret_cast<__m256i*>(d + i + 32), b);
+        }
+        std::memcpy(d + i, s + i, n - i);
+        _mm_sfence();
+    }
+
+    __attribute__((target("avx"))) static void fillAvx(void* destination, int value, size_t n) {
+        auto* d = static_cast<char*>(destination);
+        size_t head = alignHead(d, n, 32);
+        std::memset(d, value, head);
+        __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+        size_t i = head;
+        for (; i + 32 <= n; i += 32) _mm256_stream_si256(reinterpret_cast<__m256i*>(d + i), v);
+        std::memset(d + i, value, n - i);
+        _mm_sfence();
+    }
+#endif
+};
+
+/**
+ * @class CacheMissCounter
+ * @brief Counts the calling thread's last-level cache misses with `perf_event_open`.
+ *
+ * Counts user space only, which `perf_event_paranoid` up to 2 allows. Virtual machines and
+ * containers often expose no hardware counters; `available()` is then false and callers fall
+ * back to timing.
+ */
+class CacheMissCounter final {
+public:
+    CacheMissCounter() {
+        perf_event_attr attributes{};
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    ~CacheMissCounter() {
+        if (fd >= 0) close(fd);
+    }
+
+    /// @return Whether the counter could be opened.
+    bool available() const { return fd >= 0; }
+
+    /// Resets and starts counting.
+    void start() {
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+
+    /// @return The misses since `start()`, or 0 without a counter.
+    uint64_t stop() {
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t count = 0;
+        if (read(fd, &count, sizeof(count)) != static_cast<ssize_t>(sizeof(count))) return 0;
+        return count;
+    }
+
+private:
+    int fd = -1; /**< The perf event, or -1. */
+};
+
+/**
+ * @class ProfilerControl
+ * @brief Drives an external `perf record` or `perf stat` through its `--control fifo:` interface.
+ *
+ * Start perf with its events disabled on two FIFOs, e.g.
+ * `mkfifo ctl ack; perf record -D -1 -k mono --control fifo:ctl,ack -- ./main --perf-ctl ctl,ack`.
+ * The harness then enables the events only while the threads of one lock test do their
+ * measured work, so thread creation, payload set-up, joins and table printing stay out of the
+ * profile. Every enable and disable is logged to stderr as a marker with its CLOCK_MONOTONIC
+ * time and the test case and lock it belongs to, so samples can be attributed to a test.
+ */
+class ProfilerControl final {
+public:
+    /**
+     * @brief Opens the FIFOs perf listens on.
+     * @param spec `CTL[,ACK]`: the control FIFO and, optionally, the FIFO perf acknowledges on.
+     * @throws std::runtime_error If a FIFO cannot be opened.
+     */
+    explicit ProfilerControl(const std::string& spec) {
+        std::string controlPath = spec.substr(0, spec.find(','));
+        std::string ackPath = spec.find(',') == std::string::npos ? "" : spec.substr(spec.find(',') + 1);
+        // perf holds both FIFOs open for reading and writing, so neither open blocks
+        control = open(controlPath.c_str(), O_WRONLY | O_CLOEXEC);
+        if (control < 0) throw std::runtime_error("cannot open perf control FIFO " + controlPath + ": " + std::strerror(errno));
+        if (!ackPath.empty()) {
+            ack = open(ackPath.c_str(), O_RDONLY | O_CLOEXEC);
+            if (ack < 0) {
+                close(control);
+                throw std::runtime_error("cannot open perf ack FIFO " + ackPath + ": " + std::strerror(errno));
+            }
+        }
+    }
+
+    ProfilerControl(const ProfilerControl&) = delete;
+    ProfilerControl& operator=(const ProfilerControl&) = delete;
+
+    ~ProfilerControl() {
+        close(control);
+        if (ack >= 0) close(ack);
+    }
+
+    /**
+     * @brief Enables perf's events.
+     * @param label Test case and lock the measured phase belongs to.
+     */
+    void enable(const std::string& label) {
+        command("enable");
+        mark("enable", label);
+    }
+
+    /**
+     * @brief Disables perf's events.
+     * @param label Test case and lock the measured phase belonged to.
+     */
+    void disable(const std::string& label) {
+        mark("disable", label);
+        command("disable");
+    }
+
+private:
+    /// Sends one command and, with an ack FIFO, waits for perf to acknowledge it.
+    void command(const std::string& text) {
+        std::string line = text + "\n";
+        if (write(control, line.data(), line.size()) != static_cast<ssize_t>(line.size())) {
+            std::cerr << "Warning: perf control command '" << text << "' failed: " << std::strerror(errno) << std::endl;
+            return;
+        }
+        for (char c = 0; ack >= 0 && c != '\n';)
+            if (read(ack, &c, 1) != 1) break;
+    }
+
+    /// Logs a marker line with the CLOCK_MONOTONIC time, which `perf record -k mono` uses for samples.
+    static void mark(const char* event, const std::string& label) {
+        timespec now{};
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        std::ostringstream line;
+        line << "perf-marker " << now.tv_sec << "." << std::setw(9) << std::setfill('0') << now.tv_nsec << " " << event << " "
+             << label << "\n";
+        std::cerr << line.str() << std::flush;
+    }
+
+    int control = -1; /**< Control FIFO. */
+    int ack = -1;     /**< Acknowledgement FIFO, or -1. */
+};
+
+/**
+ * @class WaitProfiler
+ * @brief Collects the call stacks of the slowest lock acquisitions, deduplicated.
+ *
+ * A wait is captured when it reaches the threshold or is among the `topN` longest waits
+ * seen so far. Threshold captures are aggregated per lock and stack at once; top-N
+ * candidates are kept individually and dropped again when longer waits displace them, so
+ * the report holds exactly the waits above the threshold plus the final top N. Stacks are
+ * captured with `backtrace()`; names need the dynamic symbol table (`-rdynamic`), and
+ * frames without one are printed as `module+offset` for `addr2line`.
+ *
+ * Nothing runs inside the profiled critical sections but a clock read and a copy: a waiter
+ * records its stack before it blocks, keeps an accepted wait in a fixed per-thread buffer
+ * while it holds the lock, and publishes it under the profiler's mutex once it holds no
+ * profiled lock.
+ */
+class WaitProfiler final {
+public:
+    /// Frames kept per stack.
+    static constexpr int kMaxFrames = 16;
+
+    /**
+     * @struct Stack
+     * @brief The raw frames of one call stack.
+     */
+    struct Stack {
+        std::array<void*, kMaxFrames + 8> frames; /**< Return addresses, innermost first. */
+        int depth = 0;                            /**< Frames filled in. */
+    };
+
+    /// Fills `stack` with the calling thread's frames; meant for the contended path, before blocking.
+    static void record(Stack& stack) { stack.depth = backtrace(stack.frames.data(), static_cast<int>(stack.frames.size())); }
+
+    /**
+     * @brief Constructs the profiler.
+     * @param thresholdNs Waits at least this long are captured; 0 captures none by threshold.
+     * @param topN Also capture the N longest waits.
+     */
+    WaitProfiler(uint64_t thresholdNs, size_t topN) : thresholdNs(thresholdNs ? thresholdNs : UINT64_MAX), topN(topN) {}
+
+    /// @return Whether a wait of `waitNs` must be captured; cheap, called after every contended acquisition.
+    bool wants(uint64_t waitNs) const {
+        return waitNs >= thresholdNs || (topN && waitNs > topFloor.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * @brief Keeps a wait that `wants()` accepted in the calling thread's buffer until `released()`.
+     * @param lock Name of the lock; must outlive the publication.
+     * @param waitNs Duration of the wait.
+     * @param stack Frames recorded with `record()` before the wait.
+     * @param caller Return address of the lock call, e.g. `__builtin_return_address(0)` in a wrapper;
+     *        the stack starts at that frame, leaving out the wrapper however it was inlined.
+     *
+     * Called with the lock held, so it only copies into a fixed buffer; a wait that finds the
+     * buffer full is dropped.
+     */
+    void defer(const std::string& lock, uint64_t waitNs, const Stack& stack, const void* caller) {
+        Deferred& pending = deferred();
+        if (pending.count < pending.waits.size()) pending.waits[pending.count++] = {this, &lock, waitNs, caller, stack};
+    }
+
+    /// Notes that the calling thread took a profiled lock.
+    static void acquired() { ++deferred().held; }
+
+    /// Notes that the calling thread released a profiled lock; once it holds none, publishes its deferred waits.
+    static void released() {
+        Deferred& pending = deferred();
+        if (--pending.held > 0) return;
+        for (size_t i = 0; i < pending.count; ++i) {
+            const Deferred::Wait& wait = pending.waits[i];
+            wait.profiler->capture(*wait.lock, wait.waitNs, wait.stack, wait.caller);
+        }
+        pending.count = 0;
+    }
+
+    /**
+     * @brief Prints the captured stacks, longest total wait first.
+     * @param limit Maximum number of stacks to print.
+     */
+    void printReport(size_t limit = 20) const;
+
+private:
+    using Key = std::pair<std::string, std::vector<void*>>; /**< Lock name and call stack. */
+
+    /**
+     * @struct Deferred
+     * @brief A thread's accepted waits that are not yet published, and its profiled locks held.
+     */
+    struct Deferred {
+        /// One accepted wait.
+        struct Wait {
+            WaitProfiler* profiler;  /**< Profiler to publish to. */
+            const std::string* lock; /**< Name of the lock. */
+            uint64_t waitNs;         /**< Duration of the wait. */
+            const void* caller;      /**< Return address of the lock call. */
+            Stack stack;             /**< Frames recorded before the wait. */
+        };
+        std::array<Wait, 4> waits; /**< The waits, in arrival order. */
+        size_t count = 0;          /**< Waits filled in. */
+        int held = 0;              /**< Profiled locks the thread holds. */
+    };
+
+    /// @return The calling thread's deferred waits.
+    static Deferred& deferred() {
+        static thread_local Deferred pending;
+        return pending;
+    }
+
+    /// Publishes one wait; called with no profiled lock held.
+    void capture(const std::string& lock, uint64_t waitNs, const Stack& stack, const void* caller) {
+        const auto& frames = stack.frames;
+        int depth = stack.depth;
+        int first = static_cast<int>(std::find(frames.begin(), frames.begin() + depth, caller) - frames.begin());
+        if (first == depth) first = 0;
+        Capture entry{waitNs, {lock, std::vector<void*>(frames.begin() + first, frames.begin() + std::min(depth, first + kMaxFrames))}};
+
+        std::lock_guard<std::mutex> guard(mutex);
+        if (waitNs >= thresholdNs) {
+            add(aggregated[entry.key], waitNs);
+            return;
+        }
+        auto longer = [](const Capture& a, const Capture& b) { return a.waitNs > b.waitNs; };
+        if (top.size() == topN && waitNs <= top.front().waitNs) return;
+        top.push_back(std::move(entry));
+        std::push_heap(top.begin(), top.end(), longer);
+        if (top.size() > topN) {
+            std::pop_heap(top.begin(), top.end(), longer);
+            top.pop_back();
+        }
+        if (top.size() == topN) topFloor.store(top.front().waitNs, std::memory_order_relaxed);
+    }
+
+    /**
+     * @struct Aggregate
+     * @brief Waits with the same lock and stack.
+     */
+    struct Aggregate {
+        uint64_t count = 0;   /**< Number of waits. */
+        uint64_t totalNs = 0; /**< Sum of the waits. */
+        uint64_t maxNs = 0;   /**< Longest wait. */
+    };
+
+    /**
+     * @struct Capture
+     * @brief One top-N candidate.
+     */
+    struct Capture {
+        uint64_t waitNs; /**< Duration of the wait. */
+        Key key;         /**< Lock and stack. */
+    };
+
+    /// Adds one wait to an aggregate.
+    static void add(Aggregate& aggregate, uint64_t waitNs) {
+        ++aggregate.count;
+        aggregate.totalNs += waitNs;
+        aggregate.maxNs = std::max(aggregate.maxNs, waitNs);
+    }
+
+    /// @return The demangled function and offset of a return address, or its module and offset.
+    static std::string describe(void* frame) {
+        std::ostringstream out;
+        Dl_info info{};
+        if (!dladdr(frame, &info)) {
+            out << frame;
+            return out.str();
+        }
+        if (info.dli_sname) {
+            int status = 0;
+            char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+            out << (status == 0 && demangled ? demangled : info.dli_sname) << "+0x" << std::hex
+                << (static_cast<char*>(frame) - static_cast<char*>(info.dli_saddr));
+            std::free(demangled);
+        } else {
+            const char* module = info.dli_fname ? std::strrchr(info.dli_fname, '/') : nullptr;
+            out << (module ? module + 1 : info.dli_fname ? info.dli_fname : "?") << "+0x" << std::hex
+                << (static_cast<char*>(frame) - static_cast<char*>(info.dli_fbase));
+        }
+        return out.str();
+    }
+
+    uint64_t thresholdNs;                 /**< Waits captured regardless of rank; UINT64_MAX when off. */
+    size_t topN;                          /**< Longest waits captured regardless of the threshold. */
+    std::atomic<uint64_t> topFloor{0};    /**< Shortest wait in a full top-N set. */
+    mutable std::mutex mutex;             /**< Guards the captures. */
+    std::map<Key, Aggregate> aggregated;  /**< Waits at or above the threshold. */
+    std::vector<Capture> top;             /**< Min-heap of the longest waits below the threshold. */
+};
+
+/**
+ * @class ProfiledLock
+ * @brief Wraps a mutex and reports its slow acquisitions, with their call stacks, to a `WaitProfiler`.
+ * @tparam Mutex The wrapped lock; shared members are only needed if used.
+ *
+ * Acquisitions first try the lock, so an uncontended one costs only a call; a contended
+ * one records its stack before blocking, is timed, and is handed to the profiler if it wants
+ * it. The wait is published after the release, outside the critical section. The wrapper satisfies the same lock
+ * requirements as `Mutex`, so it drops into `std::lock_guard`, `std::unique_lock` or
+ * `std::shared_lock` in application code.
+ */
+template <typename Mutex>
+class ProfiledLock final {
+public:
+    /**
+     * @brief Wraps `mutex`.
+     * @param mutex The lock; must outlive the wrapper.
+     * @param profiler Receives the slow waits.
+     * @param name Name of the lock in the report.
+     */
+    ProfiledLock(Mutex& mutex, WaitProfiler& profiler, std::string name)
+        : mutex(mutex), profiler(profiler), name(std::move(name)) {}
+
+    __attribute__((noinline)) void lock() {
+        WaitProfiler::acquired();
+        if (mutex.try_lock()) return;
+        WaitProfiler::Stack stack;
+        WaitProfiler::record(stack);
+        auto start = std::chrono::steady_clock::now();
+        mutex.lock();
+        waited(start, stack, __builtin_return_address(0));
+    }
+    bool try_lock() { return mutex.try_lock() && (WaitProfiler::acquired(), true); }
+    void unlock() {
+        mutex.unlock();
+        WaitProfiler::released();
+    }
+
+    __attribute__((noinline)) void lock_shared() {
+        WaitProfiler::acquired();
+        if (mutex.try_lock_shared()) return;
+        WaitProfiler::Stack stack;
+        WaitProfiler::record(stack);
+        auto start = std::chrono::steady_clock::now();
+        mutex.lock_shared();
+        waited(start, stack, __builtin_return_address(0));
+    }
+    bool try_lock_shared() { return mutex.try_lock_shared() && (WaitProfiler::acquired(), true); }
+    void unlock_shared() {
+        mutex.unlock_shared();
+        WaitProfiler::released();
+    }
+
+private:
+    /// Defers the stack above `caller` to the release if the wait since `start` is one of the slow ones.
+    void waited(std::chrono::steady_clock::time_point start, const WaitProfiler::Stack& stack, const void* caller) {
+        uint64_t waitNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        if (profiler.wants(waitNs)) profiler.defer(name, waitNs, stack, caller);
+    }
+
+    Mutex& mutex;            /**< The wrapped lock. */
+    WaitProfiler& profiler;  /**< Receives the slow waits. */
+    std::string name;        /**< Name of the lock in the report. */
+};
+
+/**
+ * @class NodeReplicatedData
+ * @brief `SharedData` replicated per NUMA node, or per core group on single-node machines.
+ *
+ * Follows node replication (black-box concurrency): every replica sits behind its own
+ * reader-writer lock, and writers never touch a replica other than their own. A writer
+ * appends its operation, the new payload, to a shared circular log and applies the log to
+ * its replica. A reader first brings its replica up to the log's tail, if it is behind, and
+ * then reads under the replica's shared lock, so a read touches only node-local memory
+ * besides one load of the tail. A writer that would overwrite an entry some replica has not
+ * applied yet applies the log to that replica first.
+ */
+class NodeReplicatedData final {
+public:
+    /**
+     * @brief Constructs the replicas.
+     * @param count Number of replicas.
+     * @param logCapacity Number of operations the circular log holds.
+     */
+    explicit NodeReplicatedData(int count, size_t logCapacity = 256)
+        : replicas(std::max(1, count)), log(std::max<size_t>(1, logCapacity)) {}
+
+    NodeReplicatedData(const NodeReplicatedData&) = delete; /**< Deleted copy constructor. */
+    NodeReplicatedData& operator=(const NodeReplicatedData&) = delete; /**< Deleted copy assignment operator. */
+
+    /// @return The number of replicas.
+    int replicaCount() const { return static_cast<int>(replicas.size()); }
+
+    /**
+     * @brief Chooses the replica for a thread.
+     * @param cpu CPU the thread runs on.
+     * @param placement Index of the thread, used when there are fewer CPUs than core groups.
+     * @param coreGroups Core groups to split a single-node machine into.
+     * @return The number of replicas to create and the replica of the thread.
+     */
+    static std::pair<int, int> layout(int cpu, int placement, int coreGroups) {
+        const NumaTopology& topology = NumaTopology::get();
+        if (topology.nodes.size() > 1) {
+            int node = topology.nodeOf(cpu);
+            return {static_cast<int>(topology.nodes.size()),
+                    static_cast<int>(std::find(topology.nodes.begin(), topology.nodes.end(), node) - topology.nodes.begin())};
+        }
+        static const int cpus = std::max(1, static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN)));
+        coreGroups = std::max(1, coreGroups);
+        if (cpus < coreGroups) return {coreGroups, placement % coreGroups};
+        return {coreGroups, std::min(coreGroups - 1, std::max(0, cpu) * coreGroups / cpus)};
+    }
+
+    /**
+     * @brief Reads from a replica once it has caught up with the log.
+     * @param replica Index of the reader's replica.
+     * @param reader Called with the replica's data under its shared lock.
+     */
+    template <typename Reader>
+    void read(int replica, Reader&& reader) {
+        Replica& local = replicas[replica];
+        if (local.applied.load(std::memory_order_acquire) < tail.load(std::memory_order_acquire)) {
+            std::unique_lock<std::shared_mutex> lock(local.lock);
+            apply(local);
+        }
+        std::shared_lock<std::shared_mutex> lock(local.lock);
+        reader(static_cast<const SharedData&>(local.data));
+    }
+
+    /**
+     * @brief Appends an update to the log and applies it to the writer's replica.
+     * @param replica Index of the writer's replica.
+     * @param produce Called once the writer holds the log and returns the new text, as the other
+     *        locks' writers generate it inside their critical section; the update also
+     *        increments the counter.
+     */
+    template <typename Producer>
+    void update(int replica, Producer&& produce) {
+        {
+            std::lock_guard<std::mutex> lock(appendMutex);
+            std::string payload = produce();
+            uint64_t position = tail.load(std::memory_order_relaxed);
+            for (Replica& other : replicas) {
+                if (other.applied.load(std::memory_order_acquire) + log.size() > position) continue;
+                std::unique_lock<std::shared_mutex> otherLock(other.lock);
+                apply(other);
+            }
+            log[position % log.size()] = std::move(payload);
+            tail.store(position + 1, std::memory_order_release);
+        }
+        std::unique_lock<std::shared_mutex> lock(replicas[replica].lock);
+        apply(replicas[replica]);
+    }
+
+private:
+    /**
+     * @struct Replica
+     * @brief One copy of the data with its lock, on its own cache lines.
+     */
+    struct alignas(64) Replica {
+        std::shared_mutex lock;          /**< Readers share it; applying the log takes it exclusively. */
+        SharedData data;                 /**< This replica's copy. */
+        std::atomic<uint64_t> applied{0}; /**< Log entries applied to `data`. */
+    };
+
+    /// Applies every log entry the replica is missing; the caller holds its lock exclusively.
+    void apply(Replica& replica) {
+        uint64_t end = tail.load(std::memory_order_acquire);
+        for (uint64_t i = replica.applied.load(std::memory_order_relaxed); i < end; ++i) {
+            replica.data.counter++;
+            replica.data.text = log[i % log.size()];
+        }
+        replica.applied.store(end, std::memory_order_release);
+    }
+
+    std::vector<Replica> replicas;     /**< One replica per node or core group. */
+    std::vector<std::string> log;      /**< Circular operation log holding payloads. */
+    std::mutex appendMutex;            /**< Serializes writers appending to the log. */
+    alignas(64) std::atomic<uint64_t> tail{0}; /**< Number of operations ever appended. */
+};
+
+/**
+ * @class LockTester
+ * @brief Demonstrates the performance differences between `std::shared_mutex` and `std::mutex` in a multi-threaded environment with multiple readers and writers.
+ *
+ * The `LockTester` class is designed to benchmark and compare the efficiency of `std::shared_mutex` and `std::mutex` under different scenarios,
+ * particularly focusing on cases where the number of reader threads exceeds the number of writer threads.
+ *
+ * **Purpose and Demonstration:**
+ *
+ * - **Shared vs. Exclusive Locking:**
+ *   - `std::shared_mutex` allows multiple threads to acquire a shared (read) lock simultaneously, enabling concurrent read operations.
+ *   - `std::mutex` only allows one thread to hold the lock at any given time, blocking both read and write operations from other threads.
+ * - **Use Case Scenario:**
+ *   - In applications where read operations are frequent and write operations are infrequent, using `std::shared_mutex` can significantly improve performance by allowing multiple readers to access the shared data concurrently.
+ *   - This class demonstrates how `std::shared_mutex` can be more efficient than `std::mutex` in such scenarios.
+ *
+ * **Functionality:**
+ *
+ * - **Benchmarking Methods:**
+ *   - `testSharedMutex()`: Measures the execution time when using `std::shared_mutex` with multiple reader and writer threads.
+ *   - `testStandardMutex()`: Measures the execution time when using `std::mutex` with multiple reader and writer threads.
+ * - **Thread Functions:**
+ *   - Reader threads execute either `readerSharedLock()` or `readerStandardLock()`, depending on the mutex type, to perform read operations.
+ *   - Writer threads execute either `writerSharedLock()` or `writerStandardLock()`, depending on the mutex type, to perform write operations.
+ *
+ * **Usage:**
+ *
+ * - Create an instance of `LockTester` by specifying the number of readers, writers, reads per reader, and updates per writer.
+ * - Call `testSharedMutex()` and `testStandardMutex()` to perform the benchmarks.
+ * - Read the execution times and latency histograms from the `metrics` set, whose metrics are defined
+ *   in `LockTester::definitions()`; per-thread metrics are kept in `stats`.
+ *
+ * **Example:**
+ *
+ * ```cpp
+ * LockTester tester(10, 2, 1000, 500); // 10 readers, 2 writers
+ * tester.testSharedMutex();
+ * tester.testStandardMutex();
+ * const auto& ids = LockTester::definitions().locks.at("Shared Mutex");
+ * std::cout << "Shared Mutex Time: " << tester.metrics.value(ids.time) << " ms\n";
+ * std::cout << "Reader p99: " << tester.metrics.histogram(ids.readerLatency).percentile(0.99) << " ns\n";
+ * ```
+ *
+ * **Conclusion:**
+ *
+ * - The results demonstrate that `std::shared_mutex` provides better performance in scenarios with a high read-to-write ratio.
+ * - This class effectively showcases the conditions under which `std::shared_mutex` is more efficient compared to `std::mutex`.
+ *
+ * @note Copy and move constructors and assignment operators are deleted to prevent copying of the `LockTester` instance.
+ */
+class LockTester final {
+public:
+    /**
+     * @brief Constructs a LockTester with the specified number of readers, writers, reads, and updates.
+     * @param numReaders The number of reader threads.
+     * @param numWriters The number of writer threads.
+     * @param numReads The number of reads each reader performs.
+     * @param numUpdates The number of updates each writer performs.
+     */
+    LockTester(int numReaders, int numWriters, int numReads, int numUpdates)
+        : numReaders(numReaders), numWriters(numWriters), numReads(numReads), numUpdates(numUpdates) {}
+
+    // Delete copy and move constructors and assignment operators
+    LockTester(const LockTester&) = delete; /**< Deleted copy constructor. */
+    LockTester& operator=(const LockTester&) = delete; /**< Deleted copy assignment operator. */
+    LockTester(LockTester&&) = delete; /**< Deleted move constructor. */
+    LockTester& operator=(LockTester&&) = delete; /**< Deleted move assignment operator. */
+
+    /**
+     * @brief Tests the performance of shared_mutex with multiple readers and writers.
+     *
+     * Launches reader and writer threads that access a shared resource protected by shared_mutex,
+     * then measures the total execution time in milliseconds. Per-thread latencies and throughput
+     * are stored in `stats["Shared Mutex"]`.
+     */
+    void testSharedMutex() { runLockTest("Shared Mutex", &LockTester::readerSharedLock, &LockTester::writerSharedLock); }
+
+    /**
+     * @brief Tests the performance of standard mutex with multiple readers and writers.
+     *
+     * Launches reader and writer threads that access a shared resource protected by std::mutex,
+     * then measures the total execution time in milliseconds. Per-thread latencies and throughput
+     * are stored in `stats["Standard Mutex"]`.
+     */
+    void testStandardMutex() { runLockTest("Standard Mutex", &LockTester::readerStandardLock, &LockTester::writerStandardLock); }
+
+    /**
+     * @brief Tests the `PTHREAD_PRIO_INHERIT` mutex with the same loops as the standard mutex.
+     *
+     * Per-thread metrics are stored in `stats["PI Mutex"]`.
+     */
+    void testPiMutex() { runLockTest("PI Mutex", &LockTester::readerPiMutex, &LockTester::writerPiMutex); }
+
+    /**
+     * @brief Tests the mutex built on `FUTEX_LOCK_PI` directly with the same loops as the standard mutex.
+     *
+     * Per-thread metrics are stored in `stats["Futex PI"]`.
+     */
+    void testFutexPi() { runLockTest("Futex PI", &LockTester::readerFutexPi, &LockTester::writerFutexPi); }
+
+    /**
+     * @brief Tests the lease lock with the same loops as the shared mutex.
+     *
+     * Each reader claims a slot of a fresh `LeaseLock` whose leases last `leaseTime`; the
+     * leases it took are stored as its `Lease Renewals`. Per-thread metrics are stored in
+     * `stats["Lease Lock"]`.
+     */
+    void testLeaseLock() {
+        runLockTest("Lease Lock", &LockTester::readerLeaseLock, &LockTester::writerLeaseLock, [this] {
+            placeSharedState("Lease Lock");
+            leaseLock = std::make_unique<LeaseLock>(numReaders, leaseTime);
+        });
+    }
+
+    /**
+     * @brief Tests the one-byte parking-lot mutex with the same loops as the standard mutex.
+     *
+     * Per-thread metrics are stored in `stats["Parking Mutex"]`.
+     */
+    void testParkingMutex() { runLockTest("Parking Mutex", &LockTester::readerParkingMutex, &LockTester::writerParkingMutex); }
+
+    /**
+     * @brief Tests the two-byte parking-lot shared mutex with the same loops as the shared mutex.
+     *
+     * Per-thread metrics are stored in `stats["Parking Shared"]`.
+     */
+    void testParkingShared() { runLockTest("Parking Shared", &LockTester::readerParkingShared, &LockTester::writerParkingShared); }
+
+    /**
+     * @brief Tests node replication: a `SharedData` replica per NUMA node or core group.
+     *
+     * Readers read their own replica under its shared lock after applying pending log entries;
+     * writers append to the shared operation log (see `NodeReplicatedData`). Per-thread metrics
+     * are stored in `stats["Node Replicated"]`.
+     */
+    void testNodeReplicated() {
+        // The replicas are the test's data, so the data placement applies to them
+        runLockTest("Node Replicated", &LockTester::readerReplicated, &LockTester::writerReplicated, [this] {
+            touchAs(dataPlacement, [this] {
+                dataPlacement.applyToThread();
+                replicatedData = std::make_unique<NodeReplicatedData>(NodeReplicatedData::layout(0, 0, coreGroups).first);
+                NumaTopology::setThreadPolicy(NumaTopology::kMpolDefault, {});
+            });
+        });
+    }
+
+    /**
+     * @brief Tests readers that block until a writer publishes a new `counter` version, woken by an `EventCount`.
+     *
+     * Writers update under the shared mutex's exclusive lock, publish the version and notify
+     * after unlocking, pausing `updateInterval` between updates. Readers check the published
+     * version without a lock, sleep on the eventcount while it is unchanged and then read under
+     * a shared lock. Per-thread metrics are stored in `stats["EventCount"]`.
+     */
+    void testEventCountWait() {
+        runWaitTest("EventCount", &LockTester::readerEventCount, &LockTester::writerEventCount);
+    }
+
+    /**
+     * @brief Tests the same waiting readers with `std::condition_variable_any` on the shared mutex.
+     *
+     * Readers wait on the condition variable under their shared lock, so every notification
+     * wakes them all and each must reacquire the lock. Per-thread metrics are stored in
+     * `stats["Condition Variable"]`.
+     */
+    void testConditionVariableWait() {
+        runWaitTest("Condition Variable", &LockTester::readerConditionVariable, &LockTester::writerConditionVariable);
+    }
+
+    /**
+     * @struct LockMetricIds
+     * @brief Result metrics reported for one lock of the family.
+     */
+    struct LockMetricIds {
+        MetricId time;          /**< Wall time of the test (`<Lock> Time`, ms). */
+        MetricId throughput;    /**< Completed operations per second (`<Lock> Throughput`). */
+        MetricId readerLatency; /**< Latency of all reader operations (`<Lock> Reader Latency`). */
+        MetricId writerLatency; /**< Latency of all writer operations (`<Lock> Writer Latency`). */
+        MetricId readerWait;    /**< Time readers waited for the lock (`<Lock> Reader Wait`). */
+        MetricId writerHold;    /**< Time writers held the lock (`<Lock> Writer Hold`). */
+        MetricId writerOffCpu;  /**< Hold time writers spent preempted (`<Lock> Writer Hold Off-CPU`). */
+        MetricId preemptedHolds; /**< Writer critical sections spent mostly off the CPU. */
+        MetricId dataNode;      /**< NUMA node of SharedData (`<Lock> Data Node`), -1 if unknown. */
+        MetricId textNode;      /**< NUMA node of the placed text buffer, -1 if not placed. */
+        MetricId lockNode;      /**< NUMA node of the lock words. */
+    };
+
+    /**
+     * @struct Definitions
+     * @brief The metric registries of LockTester and the ids of their metrics.
+     */
+    struct Definitions {
+        MetricRegistry threadRegistry;  /**< Metrics every reader and writer thread records. */
+        MetricRegistry resultRegistry;  /**< Metrics of a whole test case, per lock. */
+        MetricId operations;            /**< Thread: completed operations. */
+        MetricId activeTime;            /**< Thread: time from first to last operation, ns. */
+        MetricId latency;               /**< Thread: latency of each operation. */
+        MetricId startOrder;            /**< Thread: position in which the thread actually started running. */
+        MetricId cpu;                   /**< Thread: CPU the thread started on. */
+        MetricId payloadDigest;         /**< Thread: 48-bit fingerprint of the payloads a writer generated. */
+        MetricId waitTime;              /**< Thread: time from requesting to holding the lock. */
+        MetricId holdTime;              /**< Thread: time from acquiring to releasing the lock. */
+        MetricId holdOffCpu;            /**< Thread: part of the hold time a writer spent off the CPU. */
+        MetricId preemptedHolds;        /**< Thread: critical sections spent mostly off the CPU. */
+        MetricId node;                  /**< Thread: NUMA node of the CPU the thread started on. */
+        MetricId wakeLatency;           /**< Thread: time from publishing a version until a waiting reader sees it. */
+        MetricId notifyTime;            /**< Thread: time a writer spends notifying waiters. */
+        MetricId skippedNotifies;       /**< Thread: notifications skipped because nobody waited. */
+        MetricId cpuTime;               /**< Thread: CPU time the thread consumed, ns. */
+        MetricId leaseRenewals;         /**< Thread: leases a reader of the lease lock took. */
+        std::map<std::string, LockMetricIds> locks; /**< Result metrics per lock name. */
+    };
+
+    /**
+     * @brief Returns the metric definitions, built once for the whole lock family.
+     * @return The registries and metric ids.
+     */
+    static const Definitions& definitions() {
+        static const Definitions instance = [] {
+            Definitions d;
+            d.operations = d.threadRegistry.counter("Operations", "ops");
+            d.activeTime = d.threadRegistry.duration("Active Time", "ns");
+            d.latency = d.threadRegistry.histogram("Operation Latency");
+            d.startOrder = d.threadRegistry.gauge("Start Order", "#");
+            d.cpu = d.threadRegistry.gauge("CPU", "#");
+            d.payloadDigest = d.threadRegistry.gauge("Payload Digest", "hash");
+            d.waitTime = d.threadRegistry.histogram("Wait Time");
+            d.holdTime = d.threadRegistry.histogram("Hold Time");
+            d.holdOffCpu = d.threadRegistry.histogram("Hold Off-CPU Time");
+            d.preemptedHolds = d.threadRegistry.counter("Preempted Holds", "ops");
+            d.node = d.threadRegistry.gauge("Node", "#");
+            d.wakeLatency = d.threadRegistry.histogram("Wake Latency");
+            d.notifyTime = d.threadRegistry.histogram("Notify Time");
+            d.skippedNotifies = d.threadRegistry.counter("Skipped Notifies", "ops");
+            d.cpuTime = d.threadRegistry.duration("CPU Time", "ns");
+            d.leaseRenewals = d.threadRegistry.counter("Lease Renewals", "ops");
+            for (const std::string& lock : lockNames()) {
+                d.locks[lock] = {d.resultRegistry.duration(lock + " Time", "ms"),
+                                 d.resultRegistry.gauge(lock + " Throughput", "ops/s"),
+                                 d.resultRegistry.histogram(lock + " Reader Latency"),
+                                 d.resultRegistry.histogram(lock + " Writer Latency"),
+                                 d.resultRegistry.histogram(lock + " Reader Wait"),
+                                 d.resultRegistry.histogram(lock + " Writer Hold"),
+                                 d.resultRegistry.histogram(lock + " Writer Hold Off-CPU"),
+                                 d.resultRegistry.counter(lock + " Preempted Writer Holds", "ops"),
+                                 d.resultRegistry.gauge(lock + " Data Node", "#"),
+                                 d.resultRegistry.gauge(lock + " Text Node", "#"),
+                                 d.resultRegistry.gauge(lock + " Lock Node", "#")};
+            }
+            return d;
+        }();
+        return instance;
+    }
+
+    /// @return Whether reads are at least 90% of the operations, where the lease lock runs.
+    bool readDominated() const { return readDominated(numReaders, numWriters, numReads, numUpdates); }
+
+    /// @return Whether reads are at least 90% of the operations of a test case with these parameters.
+    static bool readDominated(int readers, int writers, int reads, int updates) {
+        return static_cast<double>(readers) * reads >= 9 * static_cast<double>(writers) * updates;
+    }
+
+    /// @return The names of the locks this tester benchmarks, in report order.
+    static const std::vector<std::string>& lockNames() {
+        static const std::vector<std::string> names = {"Shared Mutex", "Standard Mutex", "Node Replicated", "PI Mutex", "Futex PI", "Lease Lock",
+                                                           "Parking Mutex", "Parking Shared"};
+        return names;
+    }
+
+    /**
+     * @brief Computes the throughput of one thread from its metrics.
+     * @param threadMetrics Metrics of a reader or writer thread.
+     * @return Operations per second over the thread's active time, or 0 if it did not run.
+     */
+    static double threadThroughput(const MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        double activeNs = threadMetrics.value(ids.activeTime);
+        return activeNs > 0 ? threadMetrics.value(ids.operations) * 1e9 / activeNs : 0.0;
+    }
+
+    /// Result metrics of every lock test run so far (times, throughput, latency histograms).
+    MetricSet metrics{definitions().resultRegistry};
+
+    /// Per-thread metrics of each lock test, keyed by lock name (e.g. `Shared Mutex`).
+    std::map<std::string, LockStats> stats;
+
+    int numReaders;  /**< Number of reader threads. */
+    int numWriters;  /**< Number of writer threads. */
+    int numReads;    /**< Number of read operations per reader. */
+    int numUpdates;  /**< Number of update operations per writer. */
+    uint64_t seed = 0;       /**< Seed from which every thread's generator seed is derived. */
+    bool pinThreads = false; /**< Pin each thread to a CPU chosen deterministically from its role and index. */
+    int cpuOffset = 0;       /**< Added to every pinned thread's placement, so testers running side by side can use other CPUs. */
+    ThreadPriority readerPriority; /**< Scheduling class and nice value of reader threads. */
+    ThreadPriority writerPriority; /**< Scheduling class and nice value of writer threads. */
+    bool measureOffCpu = false;    /**< Have writers read their CPU time around each hold, for the priority report. */
+    int coreGroups = 2;      /**< Replicas of `Node Replicated` on single-node machines. */
+    MemoryPlacement dataPlacement; /**< Placement of SharedData itself. */
+    MemoryPlacement textPlacement; /**< Placement of SharedData's text buffer; non-default keeps the buffer in place. */
+    MemoryPlacement lockPlacement; /**< Placement of the lock words. */
+    std::chrono::microseconds updateInterval{200}; /**< Pause between updates of a writer in the waiting-reader tests. */
+    ProfilerControl* profiler = nullptr; /**< If set, enabled only while the threads of a test do their measured work. */
+    WaitProfiler* waitProfiler = nullptr; /**< If set, the blocking locks capture the stacks of their slowest waits. */
+    std::chrono::microseconds leaseTime{50}; /**< Lease length of the lease lock. */
+
+    /// Size in characters of the text payload a writer installs on every update.
+    static constexpr size_t kPayloadSize = 10000;
+
+    /// Kernel readers copy the text with; null copies it into a fresh std::string.
+    inline static StreamingCopy::CopyKernel readCopy = nullptr;
+    /// Kernel writers install the payload with, in place; null assigns a new std::string.
+    inline static StreamingCopy::CopyKernel writeCopy = nullptr;
+
+    /**
+     * @brief The read operation every reader performs while holding its lock.
+     * @param data The shared data to read.
+     *
+     * Reads the counter and copies the full text, as a reader of a cached object would. With
+     * `readCopy` set the text is copied into a reused per-thread buffer with that kernel, so
+     * the kernel is measured without the allocation.
+     */
+    static void readOperation(const SharedData& data) {
+        volatile int counter = data.counter;
+        (void)counter;
+        if (!readCopy) {
+            volatile std::string text = data.text;
+            return;
+        }
+        thread_local std::vector<char> copy;
+        copy.resize(data.text.size());
+        readCopy(copy.data(), data.text.data(), data.text.size());
+    }
+
+    /**
+     * @brief The update operation every writer performs while holding its lock.
+     * @param data The shared data to update.
+     * @param inPlace Copy the payload into the existing text buffer instead of moving a new
+     *        buffer in, so a placed buffer stays on its node.
+     *
+     * Increments the counter and replaces the text with a freshly generated payload. With
+     * `writeCopy` set, or `inPlace`, the payload is generated into a reused per-thread buffer
+     * and copied into the existing text with that kernel, or `memcpy`, without allocating.
+     */
+    static void writeOperation(SharedData& data, bool inPlace = false) {
+        data.counter++;
+        if (!writeCopy && !inPlace) {
+            data.text = RandomStringGenerator::generate(kPayloadSize);
+            return;
+        }
+        StreamingCopy::CopyKernel copy = writeCopy ? writeCopy : StreamingCopy::available().front().copy;
+        thread_local std::vector<char> payload(kPayloadSize);
+        RandomStringGenerator::generate(payload.data(), kPayloadSize);
+        data.text.resize(kPayloadSize);
+        copy(&data.text[0], payload.data(), kPayloadSize);
+    }
+
+    /**
+     * @brief Pins the calling thread to one of the CPUs the process may run on.
+     * @param placement Deterministic placement index; wraps around the allowed CPUs.
+     */
+    static void pinToCpu(int placement) {
+        static const std::vector<int> cpus = [] {
+            std::vector<int> allowed;
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0)
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                    if (CPU_ISSET(cpu, &set)) allowed.push_back(cpu);
+            return allowed;
+        }();
+        if (cpus.empty()) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[placement % cpus.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+private:
+    using Clock = std::chrono::steady_clock; /**< Clock used for per-operation latencies. */
+
+    /// Payload digests are truncated to 48 bits so a double gauge holds them exactly.
+    static constexpr uint64_t kDigestMask = (1ull << 48) - 1;
+    /// Off-CPU time within one critical section above which the holder counts as preempted.
+    static constexpr uint64_t kPreemptedHoldNs = 10000;
+
+    /**
+     * @brief Allocates the per-thread measurement slots of a lock test before its threads start.
+     * @param lockName Name of the lock under test, used as the key in `stats`.
+     * @return The freshly sized statistics, one slot per reader and writer.
+     */
+    LockStats& prepareStats(const std::string& lockName) {
+        startTicket = 0;
+        arrived = 0;
+        finished = 0;
+        gateOpen = 0;
+        profileLabel = std::to_string(numReaders) + "/" + std::to_string(numWriters) + "/" + std::to_string(numReads) + "/" +
+                       std::to_string(numUpdates) + " " + lockName;
+        LockStats& lockStats = stats[lockName];
+        lockStats.readers.assign(numReaders, MetricSet(definitions().threadRegistry));
+        lockStats.writers.assign(numWriters, MetricSet(definitions().threadRegistry));
+        return lockStats;
+    }
+
+    /**
+     * @brief Starts a reader or writer thread with a reproducible seed and placement.
+     * @param body The thread function to run.
+     * @param lockName Name of the lock under test.
+     * @param writer Whether the thread is a writer.
+     * @param index Index of the thread within its role.
+     * @param threadMetrics Preallocated metrics of the thread.
+     * @return The started thread.
+     *
+     * The thread's generator seed is derived from `seed`, the lock, the role and the index, so the
+     * payload sequence of every writer is the same in every run with the same seed. The thread
+     * records the order in which it actually started and its CPU; with `pinThreads` it is first
+     * pinned to CPU number `(cpuOffset + (readers first, then writers) index) % allowed CPUs`. Finally the
+     * scheduling class and nice value of its role are applied. With a `profiler` the threads
+     * then wait at a start gate, and the profiler is enabled when the last one opens it and
+     * disabled when the last one finishes, before any join.
+     */
+    std::thread launch(void (LockTester::*body)(MetricSet&), const std::string& lockName, bool writer, int index,
+                       MetricSet& threadMetrics) {
+        uint64_t lockIndex = std::find(lockNames().begin(), lockNames().end(), lockName) - lockNames().begin();
+        uint64_t threadSeed = RandomStringGenerator::deriveSeed(seed, {lockIndex, writer ? 1u : 0u, static_cast<uint64_t>(index)});
+        int placement = writer ? numReaders + index : index;
+        return std::thread([this, body, writer, threadSeed, placement, &threadMetrics] {
+            const Definitions& ids = definitions();
+            RandomStringGenerator::seed(threadSeed);
+            if (pinThreads) pinToCpu(cpuOffset + placement);
+            const ThreadPriority& priority = writer ? writerPriority : readerPriority;
+            int error = priority.apply();
+            if (error && !priorityWarned.exchange(true))
+                std::cerr << "Warning: cannot apply scheduling " << priority.describe() << ": " << std::strerror(error) << std::endl;
+            threadMetrics.set(ids.startOrder, startTicket.fetch_add(1));
+            threadMetrics.set(ids.cpu, sched_getcpu());
+            threadMetrics.set(ids.node, NumaTopology::get().nodeOf(sched_getcpu()));
+            if (profiler) passStartGate();
+            (this->*body)(threadMetrics);
+            if (profiler && finished.fetch_add(1) + 1 == numReaders + numWriters) profiler->disable(profileLabel);
+            if (writer) threadMetrics.set(ids.payloadDigest, static_cast<double>(RandomStringGenerator::digest() & kDigestMask));
+        });
+    }
+
+    /// Waits until every thread of the test arrived; the last one enables the profiler and opens the gate.
+    void passStartGate() {
+        if (arrived.fetch_add(1) + 1 == numReaders + numWriters) {
+            profiler->enable(profileLabel);
+            gateOpen.store(1, std::memory_order_release);
+            Futex::wake(gateOpen, std::numeric_limits<int>::max());
+            return;
+        }
+        while (gateOpen.load(std::memory_order_acquire) == 0) Futex::wait(gateOpen, 0);
+    }
+
+    /**
+     * @brief Runs `construct` where a placement wants memory touched first.
+     * @param placement The placement; first-touch modes run on a helper thread pinned to the CPU
+     *        the first writer or reader gets, which `Options` ensures by implying `--pin`.
+     * @param construct Allocates and touches the memory.
+     */
+    template <typename Construct>
+    void touchAs(const MemoryPlacement& placement, Construct&& construct) {
+        if (!placement.firstTouch()) {
+            construct();
+            return;
+        }
+        int placementIndex = cpuOffset + (placement.mode == MemoryPlacement::Mode::Writer ? numReaders : 0);
+        std::thread([placementIndex, &construct] {
+            pinToCpu(placementIndex);
+            construct();
+        }).join();
+    }
+
+    /**
+     * @brief Creates fresh SharedData and lock words for a test, placed as configured.
+     * @param lockName Name of the lock or workload under test; the nodes of a lock are recorded as its result metrics.
+     *
+     * First-touch placements construct the object on a helper thread pinned to the CPU the
+     * first writer or reader gets with `pinThreads`. A placed text buffer is preallocated with
+     * a full payload, and writers then copy into it, so it does not move during the test.
+     */
+    void placeSharedState(const std::string& lockName) {
+        auto touch = [this](const MemoryPlacement& placement, auto construct) { touchAs(placement, construct); };
+        touch(dataPlacement, [this] { sharedData.create(dataPlacement); });
+        touch(lockPlacement, [this] {
+            sharedMutex.create(lockPlacement);
+            standardMutex.create(lockPlacement);
+            piMutex.create(lockPlacement);
+            futexPiMutex.create(lockPlacement);
+            parkingMutex.create(lockPlacement);
+            parkingShared.create(lockPlacement);
+        });
+        if (!textPlacement.isDefault()) {
+            touch(textPlacement, [this] {
+                textPlacement.applyToThread();
+                sharedData->text.assign(kPayloadSize, '.');
+                NumaTopology::setThreadPolicy(NumaTopology::kMpolDefault, {});
+                textPlacement.bind(sharedData->text.data(), sharedData->text.capacity(), true);
+            });
+        }
+
+        auto lock = definitions().locks.find(lockName);
+        if (lock == definitions().locks.end()) return;
+        const LockMetricIds& lockIds = lock->second;
+        metrics.set(lockIds.dataNode, NumaTopology::nodeOfAddress(sharedData.get()));
+        metrics.set(lockIds.textNode, textPlacement.isDefault() ? -1 : NumaTopology::nodeOfAddress(sharedData->text.data()));
+        metrics.set(lockIds.lockNode, NumaTopology::nodeOfAddress(sharedMutex.get()));
+    }
+
+    /**
+     * @brief Runs a reader/writer lock test and records its wall time as the lock's result.
+     * @param name Name of the lock, used as the key in `stats`.
+     * @param reader Reader thread function.
+     * @param writer Writer thread function.
+     * @param place Creates the test's shared state; not timed.
+     */
+    template <typename Place>
+    void runLockTest(const std::string& name, void (LockTester::*reader)(MetricSet&), void (LockTester::*writer)(MetricSet&),
+                     Place&& place) {
+        place();
+        auto start = std::chrono::high_resolution_clock::now();
+
+        LockStats& lockStats = prepareStats(name);
+        std::vector<std::thread> readers, writers;
+        for (int i = 0; i < numReaders; ++i) readers.push_back(launch(reader, name, false, i, lockStats.readers[i]));
+        for (int i = 0; i < numWriters; ++i) writers.push_back(launch(writer, name, true, i, lockStats.writers[i]));
+        for (auto& t : readers) t.join();
+        for (auto& t : writers) t.join();
+
+        auto end = std::chrono::high_resolution_clock::now();
+        recordResult(name, end - start);
+    }
+
+    /// Runs a lock test on freshly placed `SharedData` and lock words; see `placeSharedState()`.
+    void runLockTest(const std::string& name, void (LockTester::*reader)(MetricSet&), void (LockTester::*writer)(MetricSet&)) {
+        runLockTest(name, reader, writer, [this, &name] { placeSharedState(name); });
+    }
+
+    /**
+     * @brief Runs a waiting-reader test: readers observe every published version until the last.
+     * @param name Name of the approach, used as the key in `stats`.
+     * @param reader Reader thread function.
+     * @param writer Writer thread function.
+     */
+    void runWaitTest(const std::string& name, void (LockTester::*reader)(MetricSet&), void (LockTester::*writer)(MetricSet&)) {
+        placeSharedState(name);
+        publishedVersion = 0;
+        publishedAt = 0;
+        LockStats& lockStats = prepareStats(name);
+        std::vector<std::thread> readers, writers;
+        for (int i = 0; i < numReaders; ++i) readers.push_back(launch(reader, name, false, i, lockStats.readers[i]));
+        for (int i = 0; i < numWriters; ++i) writers.push_back(launch(writer, name, true, i, lockStats.writers[i]));
+        for (auto& t : readers) t.join();
+        for (auto& t : writers) t.join();
+    }
+
+    /// @return Nanoseconds on the steady clock, as stored in `publishedAt`.
+    static int64_t steadyNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Reader of the eventcount test.
+     * @param threadMetrics Preallocated metrics of this reader.
+     *
+     * Every observed version counts as one operation; versions published while the reader was
+     * busy are coalesced into the next observation.
+     */
+    void readerEventCount(MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        uint64_t cpuStart = threadCpuNanos();
+        uint32_t seen = 0, last = static_cast<uint32_t>(numWriters * numUpdates);
+        while (seen < last) {
+            if (publishedVersion.load(std::memory_order_acquire) == seen) {
+                EventCount::Key key = versionEvents.prepareWait();
+                if (publishedVersion.load(std::memory_order_acquire) == seen) versionEvents.commitWait(key);
+                else versionEvents.cancelWait();
+                continue;
+            }
+            threadMetrics.record(ids.wakeLatency, static_cast<uint64_t>(std::max<int64_t>(0, steadyNanos() - publishedAt.load())));
+            std::shared_lock<std::shared_mutex> lock(*sharedMutex);
+            readOperation(*sharedData);
+            seen = static_cast<uint32_t>(sharedData->counter);
+            threadMetrics.add(ids.operations, 1);
+        }
+        threadMetrics.add(ids.cpuTime, static_cast<double>(threadCpuNanos() - cpuStart));
+    }
+
+    /**
+     * @brief Writer of the eventcount test.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    void writerEventCount(MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        uint64_t cpuStart = threadCpuNanos();
+        for (int i = 0; i < numUpdates; ++i) {
+            std::this_thread::sleep_for(updateInterval);
+            {
+                std::unique_lock<std::shared_mutex> lock(*sharedMutex);
+                writeOperation(*sharedData, !textPlacement.isDefault());
+                publishedAt.store(steadyNanos());
+                publishedVersion.store(static_cast<uint32_t>(sharedData->counter), std::memory_order_release);
+            }
+            auto notifyStart = Clock::now();
+            if (!versionEvents.notifyAll()) threadMetrics.add(ids.skippedNotifies, 1);
+            threadMetrics.record(ids.notifyTime, nanosSince(notifyStart));
+        }
+        threadMetrics.add(ids.operations, numUpdates);
+        threadMetrics.add(ids.cpuTime, static_cast<double>(threadCpuNanos() - cpuStart));
+    }
+
+    /**
+     * @brief Reader of the condition-variable test.
+     * @param threadMetrics Preallocated metrics of this reader.
+     */
+    void readerConditionVariable(MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        uint64_t cpuStart = threadCpuNanos();
+        uint32_t seen = 0, last = static_cast<uint32_t>(numWriters * numUpdates);
+        std::shared_lock<std::shared_mutex> lock(*sharedMutex);
+        while (seen < last) {
+            versionChanged.wait(lock, [&] { return static_cast<uint32_t>(sharedData->counter) != seen; });
+            threadMetrics.record(ids.wakeLatency, static_cast<uint64_t>(std::max<int64_t>(0, steadyNanos() - publishedAt.load())));
+            readOperation(*sharedData);
+            seen = static_cast<uint32_t>(sharedData->counter);
+            threadMetrics.add(ids.operations, 1);
+        }
+        lock.unlock();
+        threadMetrics.add(ids.cpuTime, static_cast<double>(threadCpuNanos() - cpuStart));
+    }
+
+    /**
+     * @brief Writer of the condition-variable test.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    void writerConditionVariable(MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        uint64_t cpuStart = threadCpuNanos();
+        for (int i = 0; i < numUpdates; ++i) {
+            std::this_thread::sleep_for(updateInterval);
+            {
+                std::unique_lock<std::shared_mutex> lock(*sharedMutex);
+                writeOperation(*sharedData, !textPlacement.isDefault());
+                publishedAt.store(steadyNanos());
+            }
+            auto notifyStart = Clock::now();
+            versionChanged.notify_all();
+            threadMetrics.record(ids.notifyTime, nanosSince(notifyStart));
+        }
+        threadMetrics.add(ids.operations, numUpdates);
+        threadMetrics.add(ids.cpuTime, static_cast<double>(threadCpuNanos() - cpuStart));
+    }
+
+    /**
+     * @brief Aggregates the per-thread metrics of a finished lock test into `metrics`.
+     * @param lockName Name of the lock under test.
+     * @param elapsed Wall time of the test.
+     */
+    void recordResult(const std::string& lockName, std::chrono::nanoseconds elapsed) {
+        const Definitions& ids = definitions();
+        const LockMetricIds& lockIds = ids.locks.at(lockName);
+        const LockStats& lockStats = stats.at(lockName);
+
+        MetricSet readers(ids.threadRegistry), writers(ids.threadRegistry);
+        for (const auto& reader : lockStats.readers) readers.merge(reader);
+        for (const auto& writer : lockStats.writers) writers.merge(writer);
+        double operations = readers.value(ids.operations) + writers.value(ids.operations);
+
+        metrics.set(lockIds.time, static_cast<double>(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count()));
+        metrics.set(lockIds.throughput, elapsed.count() > 0 ? operations * 1e9 / elapsed.count() : 0.0);
+        metrics.merge(lockIds.readerLatency, readers.histogram(ids.latency));
+        metrics.merge(lockIds.writerLatency, writers.histogram(ids.latency));
+        metrics.merge(lockIds.readerWait, readers.histogram(ids.waitTime));
+        metrics.merge(lockIds.writerHold, writers.histogram(ids.holdTime));
+        metrics.merge(lockIds.writerOffCpu, writers.histogram(ids.holdOffCpu));
+        metrics.add(lockIds.preemptedHolds, writers.value(ids.preemptedHolds));
+    }
+
+    /**
+     * @brief Returns the nanoseconds elapsed since a point in time.
+     * @param since The starting point.
+     * @return Elapsed time in nanoseconds.
+     */
+    static uint64_t nanosSince(Clock::time_point since) {
+        return nanosBetween(since, Clock::now());
+    }
+
+    /// @return The nanoseconds between two points in time.
+    static uint64_t nanosBetween(Clock::time_point from, Clock::time_point to) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(to - from).count();
+    }
+
+    /**
+     * @brief Reads the calling thread's CPU time.
+     * @return CPU time consumed by the calling thread, in nanoseconds.
+     */
+    static uint64_t threadCpuNanos() {
+        timespec ts{};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + ts.tv_nsec;
+    }
+
+    /**
+     * @brief The reader loop shared by every lock of the family.
+     * @tparam Guard RAII guard that takes the lock for reading (e.g. `std::shared_lock<std::shared_mutex>`).
+     * @tparam Mutex The lock type.
+     * @param mutex The lock protecting `sharedData`.
+     * @param threadMetrics Preallocated metrics of this reader.
+     *
+     * Records per operation the total latency and the time spent waiting for the lock.
+     */
+    template <typename Guard, typename Mutex>
+    void readerLoop(Mutex& mutex, MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        auto threadStart = Clock::now();
+        for (int i = 0; i < numReads; ++i) {
+            auto opStart = Clock::now();
+            Clock::time_point acquired;
+            {
+                Guard lock(mutex);
+                acquired = Clock::now();
+                readOperation(*sharedData);
+            }
+            auto opEnd = Clock::now();
+            threadMetrics.record(ids.latency, nanosBetween(opStart, opEnd));
+            threadMetrics.record(ids.waitTime, nanosBetween(opStart, acquired));
+            threadMetrics.record(ids.holdTime, nanosBetween(acquired, opEnd));
+        }
+        threadMetrics.add(ids.operations, numReads);
+        threadMetrics.add(ids.activeTime, static_cast<double>(nanosSince(threadStart)));
+    }
+
+    /**
+     * @brief The writer loop shared by every lock of the family.
+     * @tparam Guard RAII guard that takes the lock exclusively (e.g. `std::unique_lock<std::shared_mutex>`).
+     * @tparam Mutex The lock type.
+     * @param mutex The lock protecting `sharedData`.
+     * @param threadMetrics Preallocated metrics of this writer.
+     *
+     * Besides latency, wait and hold time, each writer can measure how long it was off the CPU while
+     * holding the lock. A low-priority writer that is preempted inside its critical section keeps
+     * every reader waiting: that off-CPU hold time is the priority inversion readers pay for. The
+     * two CPU clock reads lengthen every hold, so they only happen with `measureOffCpu`.
+     */
+    template <typename Guard, typename Mutex>
+    void writerLoop(Mutex& mutex, MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        auto threadStart = Clock::now();
+        for (int i = 0; i < numUpdates; ++i) {
+            auto opStart = Clock::now();
+            Clock::time_point acquired;
+            uint64_t holdCpu = 0;
+            {
+                Guard lock(mutex);
+                acquired = Clock::now();
+                if (measureOffCpu) {
+                    uint64_t cpuAtAcquire = threadCpuNanos();
+                    writeOperation(*sharedData, !textPlacement.isDefault());
+                    holdCpu = threadCpuNanos() - cpuAtAcquire;
+                } else {
+                    writeOperation(*sharedData, !textPlacement.isDefault());
+                }
+            }
+            auto opEnd = Clock::now();
+            uint64_t holdNs = nanosBetween(acquired, opEnd);
+            threadMetrics.record(ids.latency, nanosBetween(opStart, opEnd));
+            threadMetrics.record(ids.waitTime, nanosBetween(opStart, acquired));
+            threadMetrics.record(ids.holdTime, holdNs);
+            if (measureOffCpu) {
+                uint64_t offCpuNs = holdNs > holdCpu ? holdNs - holdCpu : 0;
+                threadMetrics.record(ids.holdOffCpu, offCpuNs);
+                if (offCpuNs > kPreemptedHoldNs && offCpuNs * 2 > holdNs) threadMetrics.add(ids.preemptedHolds, 1);
+            }
+        }
+        threadMetrics.add(ids.operations, numUpdates);
+        threadMetrics.add(ids.activeTime, static_cast<double>(nanosSince(threadStart)));
+    }
+
+    /**
+     * @brief Runs `readerLoop` on `mutex`, through a `ProfiledLock` when stacks are captured.
+     * @tparam Guard RAII guard template that takes the lock for reading.
+     * @param mutex The lock protecting `sharedData`.
+     * @param lockName Name of the lock in the wait profile.
+     * @param threadMetrics Preallocated metrics of this reader.
+     */
+    template <template <typename> class Guard, typename Mutex>
+    void profiledReaderLoop(Mutex& mutex, const char* lockName, MetricSet& threadMetrics) {
+        if (!waitProfiler) return readerLoop<Guard<Mutex>>(mutex, threadMetrics);
+        ProfiledLock<Mutex> profiled(mutex, *waitProfiler, lockName);
+        readerLoop<Guard<ProfiledLock<Mutex>>>(profiled, threadMetrics);
+    }
+
+    /**
+     * @brief Runs `writerLoop` on `mutex`, through a `ProfiledLock` when stacks are captured.
+     * @tparam Guard RAII guard template that takes the lock exclusively.
+     * @param mutex The lock protecting `sharedData`.
+     * @param lockName Name of the lock in the wait profile.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    template <template <typename> class Guard, typename Mutex>
+    void profiledWriterLoop(Mutex& mutex, const char* lockName, MetricSet& threadMetrics) {
+        if (!waitProfiler) return writerLoop<Guard<Mutex>>(mutex, threadMetrics);
+        ProfiledLock<Mutex> profiled(mutex, *waitProfiler, lockName);
+        writerLoop<Guard<ProfiledLock<Mutex>>>(profiled, threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads using shared_mutex.
+     * @param threadMetrics Preallocated metrics of this reader.
+     *
+     * Each reader acquires a shared lock on shared_mutex and reads the shared data.
+     */
+    void readerSharedLock(MetricSet& threadMetrics) {
+        profiledReaderLoop<std::shared_lock>(*sharedMutex, "Shared Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by writer threads using shared_mutex.
+     * @param threadMetrics Preallocated metrics of this writer.
+     *
+     * Each writer acquires an exclusive lock on shared_mutex and updates the shared data.
+     */
+    void writerSharedLock(MetricSet& threadMetrics) {
+        profiledWriterLoop<std::unique_lock>(*sharedMutex, "Shared Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads using standard mutex.
+     * @param threadMetrics Preallocated metrics of this reader.
+     *
+     * Each reader acquires a lock on standardMutex and reads the shared data.
+     */
+    void readerStandardLock(MetricSet& threadMetrics) {
+        profiledReaderLoop<std::lock_guard>(*standardMutex, "Standard Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by writer threads using standard mutex.
+     * @param threadMetrics Preallocated metrics of this writer.
+     *
+     * Each writer acquires a lock on standardMutex and updates the shared data.
+     */
+    void writerStandardLock(MetricSet& threadMetrics) {
+        profiledWriterLoop<std::lock_guard>(*standardMutex, "Standard Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads using the priority-inheritance pthread mutex.
+     * @param threadMetrics Preallocated metrics of this reader.
+     */
+    void readerPiMutex(MetricSet& threadMetrics) {
+        profiledReaderLoop<std::lock_guard>(*piMutex, "PI Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by writer threads using the priority-inheritance pthread mutex.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    void writerPiMutex(MetricSet& threadMetrics) {
+        profiledWriterLoop<std::lock_guard>(*piMutex, "PI Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads using the `FUTEX_LOCK_PI` mutex.
+     * @param threadMetrics Preallocated metrics of this reader.
+     */
+    void readerFutexPi(MetricSet& threadMetrics) {
+        profiledReaderLoop<std::lock_guard>(*futexPiMutex, "Futex PI", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by writer threads using the `FUTEX_LOCK_PI` mutex.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    void writerFutexPi(MetricSet& threadMetrics) {
+        profiledWriterLoop<std::lock_guard>(*futexPiMutex, "Futex PI", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads using the lease lock.
+     * @param threadMetrics Preallocated metrics of this reader.
+     */
+    void readerLeaseLock(MetricSet& threadMetrics) {
+        LeaseLock::Reader reader(*leaseLock);
+        readerLoop<std::shared_lock<LeaseLock::Reader>>(reader, threadMetrics);
+        threadMetrics.add(definitions().leaseRenewals, static_cast<double>(reader.renewals()));
+    }
+
+    /**
+     * @brief Function executed by writer threads using the lease lock.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    void writerLeaseLock(MetricSet& threadMetrics) {
+        writerLoop<std::lock_guard<LeaseLock>>(*leaseLock, threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads using the parking-lot mutex.
+     * @param threadMetrics Preallocated metrics of this reader.
+     */
+    void readerParkingMutex(MetricSet& threadMetrics) {
+        profiledReaderLoop<std::lock_guard>(*parkingMutex, "Parking Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by writer threads using the parking-lot mutex.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    void writerParkingMutex(MetricSet& threadMetrics) {
+        profiledWriterLoop<std::lock_guard>(*parkingMutex, "Parking Mutex", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads using the parking-lot shared mutex.
+     * @param threadMetrics Preallocated metrics of this reader.
+     */
+    void readerParkingShared(MetricSet& threadMetrics) {
+        profiledReaderLoop<std::shared_lock>(*parkingShared, "Parking Shared", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by writer threads using the parking-lot shared mutex.
+     * @param threadMetrics Preallocated metrics of this writer.
+     */
+    void writerParkingShared(MetricSet& threadMetrics) {
+        profiledWriterLoop<std::unique_lock>(*parkingShared, "Parking Shared", threadMetrics);
+    }
+
+    /**
+     * @brief Function executed by reader threads of the node-replicated test.
+     * @param threadMetrics Preallocated metrics of this reader.
+     *
+     * The wait time includes bringing the replica up to date with the log.
+     */
+    void readerReplicated(MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        int replica = NodeReplicatedData::layout(sched_getcpu(), static_cast<int>(threadMetrics.value(ids.startOrder)), coreGroups).second;
+        auto threadStart = Clock::now();
+        for (int i = 0; i < numReads; ++i) {
+            auto opStart = Clock::now();
+            Clock::time_point acquired;
+            replicatedData->read(replica, [&acquired](const SharedData& data) {
+                acquired = Clock::now();
+                readOperation(data);
+            });
+            auto opEnd = Clock::now();
+            threadMetrics.record(ids.latency, nanosBetween(opStart, opEnd));
+            threadMetrics.record(ids.waitTime, nanosBetween(opStart, acquired));
+            threadMetrics.record(ids.holdTime, nanosBetween(acquired, opEnd));
+        }
+        threadMetrics.add(ids.operations, numReads);
+        threadMetrics.add(ids.activeTime, static_cast<double>(nanosSince(threadStart)));
+    }
+
+    /**
+     * @brief Function executed by writer threads of the node-replicated test.
+     * @param threadMetrics Preallocated metrics of this writer.
+     *
+     * The payload is generated once the writer holds the log, as the other writers generate it
+     * under their lock, so the hold time covers generating, appending to the log and applying it
+     * to the writer's replica. The replica is the one of the CPU the writer starts on.
+     */
+    void writerReplicated(MetricSet& threadMetrics) {
+        const Definitions& ids = definitions();
+        int replica = NodeReplicatedData::layout(sched_getcpu(), static_cast<int>(threadMetrics.value(ids.startOrder)), coreGroups).second;
+        auto threadStart = Clock::now();
+        for (int i = 0; i < numUpdates; ++i) {
+            auto opStart = Clock::now();
+            Clock::time_point acquired;
+            replicatedData->update(replica, [&acquired] {
+                acquired = Clock::now();
+                return RandomStringGenerator::generate(kPayloadSize);
+            });
+            auto opEnd = Clock::now();
+            threadMetrics.record(ids.latency, nanosBetween(opStart, opEnd));
+            threadMetrics.record(ids.waitTime, nanosBetween(opStart, acquired));
+            threadMetrics.record(ids.holdTime, nanosBetween(acquired, opEnd));
+        }
+        threadMetrics.add(ids.operations, numUpdates);
+        threadMetrics.add(ids.activeTime, static_cast<double>(nanosSince(threadStart)));
+    }
+
+    PlacedObject<SharedData> sharedData; /**< Shared data accessed by readers and writers, fresh for every test. */
+    std::unique_ptr<NodeReplicatedData> replicatedData; /**< Replicas of the node-replicated test. */
+    PlacedObject<std::shared_mutex> sharedMutex; /**< Mutex for shared lock testing. */
+    PlacedObject<std::mutex> standardMutex;      /**< Mutex for standard lock testing. */
+    PlacedObject<PiMutex> piMutex;               /**< Priority-inheritance pthread mutex. */
+    PlacedObject<FutexPiMutex> futexPiMutex;     /**< Priority-inheritance mutex on `FUTEX_LOCK_PI`. */
+    std::unique_ptr<LeaseLock> leaseLock;        /**< Lease lock of the current test, sized for its readers. */
+    PlacedObject<ParkingMutex> parkingMutex;     /**< One-byte mutex parking in the `ParkingLot`. */
+    PlacedObject<ParkingSharedMutex> parkingShared; /**< Two-byte shared mutex parking in the `ParkingLot`. */
+    EventCount versionEvents;                    /**< Wakes readers of the eventcount test. */
+    std::condition_variable_any versionChanged;  /**< Wakes readers of the condition-variable test. */
+    std::atomic<uint32_t> publishedVersion{0};   /**< Latest counter version, readable without the lock. */
+    std::atomic<int64_t> publishedAt{0};         /**< Steady-clock time the latest version was published, ns. */
+    std::atomic<int> startTicket{0}; /**< Next start order handed to a starting thread. */
+    std::atomic<int> arrived{0};     /**< Threads at the start gate. */
+    std::atomic<int> finished{0};    /**< Threads done with their measured work. */
+    std::atomic<uint32_t> gateOpen{0}; /**< Futex word of the start gate. */
+    std::string profileLabel;        /**< Test case and lock the profiler markers name. */
+    inline static std::atomic<bool> priorityWarned{false}; /**< Whether a failed priority change was reported. */
+};
+
+
+/**
+ * @class TextTable
+ * @brief A small helper that prints rows of strings as a boxed ASCII table.
+ *
+ * Column widths are computed from the header and every row, and the output uses the same
+ * `+---+` separators as `Benchmark::printBenchmarkTable()` so all reports look alike.
+ */
+class TextTable final {
+public:
+    /**
+     * @brief Constructs a table with the given column headers.
+     * @param headers Column titles, printed in the order given.
+     */
+    explicit TextTable(std::vector<std::string> headers) : headers(std::move(headers)) {}
+
+    /**
+     * @brief Appends a row; missing cells are printed empty, extra cells are ignored.
+     * @param row The cell values of the row.
+     * @return Reference to the TextTable object for chaining.
+     */
+    TextTable& addRow(std::vector<std::string> row) {
+        row.resize(headers.size());
+        rows.push_back(std::move(row));
+        return *this;
+    }
+
+    /**
+     * @brief Prints the table to the given stream.
+     * @param out The output stream.
+     */
+    void print(std::ostream& out = std::cout) const {
+        std::vector<size_t> widths;
+        for (const auto& header : headers) widths.push_back(header.length());
+        for (const auto& row : rows)
+            for (size_t i = 0; i < row.size(); ++i)
+                widths[i] = std::max(widths[i], row[i].length());
+
+        auto printSeparator = [&]() {
+            for (size_t width : widths) out << "+" << std::string(width + 2, '-');
+            out << "+" << std::endl;
+        };
+        auto printRow = [&](const std::vector<std::string>& row) {
+            for (size_t i = 0; i < row.size(); ++i)
+                out << "| " << std::setw(static_cast<int>(widths[i])) << std::setfill(' ') << row[i] << " ";
+            out << "|" << std::endl;
+        };
+
+        printSeparator();
+        printRow(headers);
+        printSeparator();
+        for (const auto& row : rows) {
+            printRow(row);
+            printSeparator();
+        }
+    }
+
+private:
+    std::vector<std::string> headers;           /**< Column titles. */
+    std::vector<std::vector<std::string>> rows; /**< Table body. */
+};
+
+void WaitProfiler::printReport(size_t limit) const {
+    std::map<Key, Aggregate> all;
+    {
+        std::lock_guard<std::mutex> guard(mutex);
+        all = aggregated;
+        for (const Capture& capture : top) add(all[capture.key], capture.waitNs);
+    }
+    std::vector<std::pair<Key, Aggregate>> stacks(all.begin(), all.end());
+    std::sort(stacks.begin(), stacks.end(), [](const auto& a, const auto& b) { return a.second.totalNs > b.second.totalNs; });
+    if (stacks.size() > limit) stacks.resize(limit);
+
+    std::cout << "\nSlowest lock waits by call stack (threshold "
+              << (thresholdNs == UINT64_MAX ? std::string("off") : LatencyHistogram::format(thresholdNs)) << ", top "
+              << topN << "):" << std::endl;
+    if (stacks.empty()) {
+        std::cout << "No wait was captured." << std::endl;
+        return;
+    }
+    TextTable table({"#", "Lock", "Waits", "Total wait", "Max wait"});
+    for (size_t i = 0; i < stacks.size(); ++i)
+        table.addRow({std::to_string(i + 1), stacks[i].first.first, std::to_string(stacks[i].second.count),
+                      LatencyHistogram::format(stacks[i].second.totalNs), LatencyHistogram::format(stacks[i].second.maxNs)});
+    table.print();
+    for (size_t i = 0; i < stacks.size(); ++i) {
+        std::cout << "#" << i + 1 << ":" << std::endl;
+        for (void* frame : stacks[i].first.second) std::cout << "    " << describe(frame) << std::endl;
+    }
+}
+
+/**
+ * @class SoakTester
+ * @brief Runs one reader/writer workload for a long time and tracks memory and latency drift.
+ *
+ * Readers and writers loop over `LockTester::readOperation()` and `LockTester::writeOperation()`
+ * until the configured duration has passed. Every interval a sampler records RSS, the glibc
+ * allocator state reported by `malloc_info()`, throughput and p99 latencies. At the end each
+ * series is checked for monotonic drift, which reveals heap fragmentation caused by the 10KB
+ * payload being replaced and copied millions of times, as well as memory that is never reclaimed.
+ */
+class SoakTester final {
+public:
+    /**
+     * @struct Sample
+     * @brief Measurements of one sampling interval.
+     */
+    struct Sample {
+        double elapsedSec = 0;      /**< Seconds since the start of the soak. */
+        double readsPerSec = 0;     /**< Reader throughput during the interval. */
+        double writesPerSec = 0;    /**< Writer throughput during the interval. */
+        uint64_t readP99Ns = 0;     /**< 99th percentile read latency during the interval. */
+        uint64_t writeP99Ns = 0;    /**< 99th percentile write latency during the interval. */
+        uint64_t rssBytes = 0;      /**< Resident set size at the end of the interval. */
+        uint64_t heapBytes = 0;     /**< Memory obtained from the system by all malloc arenas. */
+        uint64_t freeBytes = 0;     /**< Free chunks held inside the arenas (fragmentation). */
+        int arenas = 0;             /**< Number of malloc arenas. */
+
+        /// @return Heap bytes in use by the program.
+        uint64_t inUseBytes() const { return heapBytes > freeBytes ? heapBytes - freeBytes : 0; }
+        /// @return Fraction of the heap that is free but not returned to the system.
+        double fragmentation() const { return heapBytes ? static_cast<double>(freeBytes) / heapBytes : 0.0; }
+    };
+
+    /**
+     * @brief Configures a soak run.
+     * @param numReaders Number of reader threads.
+     * @param numWriters Number of writer threads.
+     * @param lockName Lock protecting the data: `shared` (std::shared_mutex) or `standard` (std::mutex).
+     * @param duration Total run time.
+     * @param interval Time between samples.
+     * @throws std::invalid_argument For an unknown lock name.
+     */
+    SoakTester(int numReaders, int numWriters, std::string lockName, std::chrono::seconds duration,
+               std::chrono::seconds interval)
+        : numReaders(numReaders), numWriters(numWriters), lockName(std::move(lockName)), duration(duration),
+          interval(interval) {
+        if (this->lockName != "shared" && this->lockName != "standard")
+            throw std::invalid_argument("unknown soak lock '" + this->lockName + "' (use shared or standard)");
+    }
+
+    SoakTester(const SoakTester&) = delete;            /**< Deleted copy constructor. */
+    SoakTester& operator=(const SoakTester&) = delete; /**< Deleted copy assignment operator. */
+
+    uint64_t seed = 0;             /**< Seed from which every thread's generator seed is derived. */
+    bool pinThreads = false;       /**< Pin each thread to a CPU chosen deterministically from its role and index. */
+    ThreadPriority readerPriority; /**< Scheduling class and nice value of reader threads. */
+    ThreadPriority writerPriority; /**< Scheduling class and nice value of writer threads. */
+
+    /**
+     * @brief Runs the soak, printing one line per interval, then the drift summary.
+     * @param out The output stream.
+     * @return The recorded samples.
+     */
+    std::vector<Sample> run(std::ostream& out = std::cout) {
+        readerSlots = std::vector<Slot>(numReaders);
+        writerSlots = std::vector<Slot>(numWriters);
+        stop = false;
+
+        out << "Soak: " << numReaders << " readers, " << numWriters << " writers, " << lockName << " lock, "
+            << duration.count() << " s, sample every " << interval.count() << " s" << std::endl;
+        out << std::setw(9) << "elapsed" << std::setw(12) << "reads/s" << std::setw(11) << "writes/s"
+            << std::setw(11) << "read p99" << std::setw(11) << "write p99" << std::setw(11) << "RSS"
+            << std::setw(11) << "heap" << std::setw(11) << "in use" << std::setw(8) << "frag" << std::setw(8)
+            << "arenas" << std::endl;
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numReaders; ++i)
+            threads.emplace_back([this, i] {
+                prepareThread(false, i);
+                reader(readerSlots[i]);
+            });
+        for (int i = 0; i < numWriters; ++i)
+            threads.emplace_back([this, i] {
+                prepareThread(true, i);
+                writer(writerSlots[i]);
+            });
+
+        std::vector<Sample> samples;
+        auto start = std::chrono::steady_clock::now();
+        auto last = start;
+        for (auto next = start + interval; next <= start + duration; next += interval) {
+            std::this_thread::sleep_until(next);
+            samples.push_back(takeSample(start, last));
+            printSample(out, samples.back());
+        }
+
+        stop = true;
+        for (auto& thread : threads) thread.join();
+        printDrift(out, samples);
+        return samples;
+    }
+
+private:
+    /// Minimum relative growth between the first and last quarter of a series reported as drift.
+    static constexpr double kDriftThreshold = 0.05;
+    /// Minimum Kendall rank correlation with time for a series to count as monotonic.
+    static constexpr double kMonotonicTau = 0.5;
+
+    /**
+     * @struct Slot
+     * @brief Per-thread cumulative counters, so that recording takes no lock and draining never waits.
+     *
+     * Only the owner writes the counters, with relaxed stores, and they only grow. The sampler
+     * reads them with relaxed loads and reports the difference to what it drained last time,
+     * so a thread that is stalled, e.g. a writer starved behind readers, delays no sample; its
+     * operations simply show up in the interval in which they completed.
+     */
+    struct alignas(64) Slot {
+        std::array<std::atomic<uint64_t>, LatencyHistogram::kBucketCount> buckets{}; /**< Operations per latency bucket. */
+        std::atomic<uint64_t> operations{0};                                          /**< Operations in total. */
+        alignas(64) std::array<uint64_t, LatencyHistogram::kBucketCount> drained{};   /**< `buckets` at the last sample; sampler only. */
+        uint64_t drainedOperations = 0;                                               /**< `operations` at the last sample; sampler only. */
+    };
+
+    /**
+     * @brief Records one operation in a slot.
+     * @param slot The slot of the calling thread.
+     * @param ns Operation latency in nanoseconds.
+     */
+    static void record(Slot& slot, uint64_t ns) {
+        // Single writer: a load and a store suffice, and neither is a locked instruction
+        std::atomic<uint64_t>& bucket = slot.buckets[LatencyHistogram::bucketOf(ns)];
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        slot.operations.store(slot.operations.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Seeds, pins and schedules the calling thread the way `LockTester::launch()` does.
+     * @param writer Whether the thread is a writer.
+     * @param index Index of the thread within its role.
+     */
+    void prepareThread(bool writer, int index) {
+        RandomStringGenerator::seed(RandomStringGenerator::deriveSeed(seed, {writer ? 1u : 0u, static_cast<uint64_t>(index)}));
+        if (pinThreads) LockTester::pinToCpu(writer ? numReaders + index : index);
+        const ThreadPriority& priority = writer ? writerPriority : readerPriority;
+        int error = priority.apply();
+        if (error && !priorityWarned.exchange(true))
+            std::cerr << "Warning: cannot apply scheduling " << priority.describe() << ": " << std::strerror(error) << std::endl;
+    }
+
+    /**
+     * @brief Reader loop: repeats the read operation until the soak ends.
+     * @param slot Measurement slot of this reader.
+     */
+    void reader(Slot& slot) {
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto opStart = std::chrono::steady_clock::now();
+            if (lockName == "shared") {
+                std::shared_lock lock(sharedMutex);
+                LockTester::readOperation(sharedData);
+            } else {
+                std::lock_guard lock(standardMutex);
+                LockTester::readOperation(sharedData);
+            }
+            record(slot, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - opStart).count());
+        }
+    }
+
+    /**
+     * @brief Writer loop: repeats the update operation until the soak ends.
+     * @param slot Measurement slot of this writer.
+     */
+    void writer(Slot& slot) {
+        while (!stop.load(std::memory_order_relaxed)) {
+            auto opStart = std::chrono::steady_clock::now();
+            if (lockName == "shared") {
+                std::unique_lock lock(sharedMutex);
+                LockTester::writeOperation(sharedData);
+            } else {
+                std::lock_guard lock(standardMutex);
+                LockTester::writeOperation(sharedData);
+            }
+            record(slot, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - opStart).count());
+        }
+    }
+
+    /**
+     * @brief Collects the operations since the last sample and reads the process memory state.
+     * @param start Start of the soak.
+     * @param last End of the previous interval; advanced to the end of this one.
+     * @return The sample.
+     *
+     * The interval ends once the counters are drained, so its length covers every operation
+     * counted in it.
+     */
+    Sample takeSample(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point& last) {
+        auto drain = [](std::vector<Slot>& slots, LatencyHistogram& latency) {
+            uint64_t operations = 0;
+            for (auto& slot : slots) {
+                uint64_t total = slot.operations.load(std::memory_order_relaxed);
+                operations += total - slot.drainedOperations;
+                slot.drainedOperations = total;
+                for (int i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+                    uint64_t count = slot.buckets[i].load(std::memory_order_relaxed);
+                    latency.recordBucket(i, count - slot.drained[i]);
+                    slot.drained[i] = count;
+                }
+            }
+            return operations;
+        };
+        LatencyHistogram reads, writes;
+        uint64_t readCount = drain(readerSlots, reads);
+        uint64_t writeCount = drain(writerSlots, writes);
+        auto now = std::chrono::steady_clock::now();
+        double intervalSec = std::chrono::duration<double>(now - last).count();
+        last = now;
+
+        Sample sample;
+        sample.elapsedSec = std::chrono::duration<double>(now - start).count();
+        sample.readsPerSec = readCount / intervalSec;
+        sample.writesPerSec = writeCount / intervalSec;
+        sample.readP99Ns = reads.percentile(0.99);
+        sample.writeP99Ns = writes.percentile(0.99);
+
+        std::ifstream statm("/proc/self/statm");
+        uint64_t sizePages = 0, residentPages = 0;
+        if (statm >> sizePages >> residentPages) sample.rssBytes = residentPages * sysconf(_SC_PAGESIZE);
+        readMallocInfo(sample);
+        return sample;
+    }
+
+    /**
+     * @brief Fills the allocator fields of a sample from the XML written by `malloc_info()`.
+     * @param sample The sample to fill.
+     *
+     * The process-wide totals follow the per-arena `<heap>` elements; the last `<total>` and
+     * `<system type="current">` elements therefore describe all arenas together.
+     */
+    static void readMallocInfo(Sample& sample) {
+        char* buffer = nullptr;
+        size_t size = 0;
+        FILE* stream = open_memstream(&buffer, &size);
+        if (!stream) return;
+        malloc_info(0, stream);
+        std::fclose(stream);
+        std::string xml(buffer, size);
+        std::free(buffer);
+
+        auto attribute = [&](size_t from, const std::string& name) -> uint64_t {
+            size_t pos = xml.find(name + "=\"", from);
+            return pos == std::string::npos ? 0 : std::strtoull(xml.c_str() + pos + name.size() + 2, nullptr, 10);
+        };
+        size_t tail = xml.rfind("</heap>");
+        tail = tail == std::string::npos ? 0 : tail;
+        for (size_t pos = xml.find("<total ", tail); pos != std::string::npos; pos = xml.find("<total ", pos + 1))
+            if (xml.compare(pos, 19, "<total type=\"mmap\" ") != 0) sample.freeBytes += attribute(pos, "size");
+        size_t current = xml.find("<system type=\"current\"", tail);
+        if (current != std::string::npos) sample.heapBytes = attribute(current, "size");
+        for (size_t pos = xml.find("<heap nr="); pos != std::string::npos; pos = xml.find("<heap nr=", pos + 1))
+            ++sample.arenas;
+    }
+
+    /**
+     * @brief Prints one sample as a row of the live log.
+     * @param out The output stream.
+     * @param sample The sample.
+     */
+    static void printSample(std::ostream& out, const Sample& sample) {
+        out << std::setw(8) << static_cast<long long>(sample.elapsedSec) << "s" << std::setw(12)
+            << static_cast<long long>(sample.readsPerSec) << std::setw(11) << static_cast<long long>(sample.writesPerSec)
+            << std::setw(11) << formatNs(sample.readP99Ns) << std::setw(11) << formatNs(sample.writeP99Ns)
+            << std::setw(11) << formatBytes(sample.rssBytes) << std::setw(11) << formatBytes(sample.heapBytes)
+            << std::setw(11) << formatBytes(sample.inUseBytes()) << std::setw(7) << std::fixed << std::setprecision(1)
+            << sample.fragmentation() * 100 << "%" << std::setw(8) << sample.arenas << std::endl;
+    }
+
+    /**
+     * @brief Checks every tracked series for monotonic drift and prints a verdict table.
+     * @param out The output stream.
+     * @param samples All samples of the run.
+     *
+     * A series drifts when it is rank-correlated with time (Kendall's tau above `kMonotonicTau`)
+     * and the mean of its last quarter differs from the mean of its first quarter by more than
+     * `kDriftThreshold`. Throughput is flagged when it falls, everything else when it rises.
+     */
+    static void printDrift(std::ostream& out, const std::vector<Sample>& samples) {
+        if (samples.size() < 4) {
+            out << "Drift analysis needs at least 4 samples; run longer or sample more often." << std::endl;
+            return;
+        }
+        struct Series {
+            const char* name;
+            double (*value)(const Sample&);
+            bool higherIsWorse;
+        };
+        const Series series[] = {
+            {"RSS", [](const Sample& s) { return static_cast<double>(s.rssBytes); }, true},
+            {"Heap in use", [](const Sample& s) { return static_cast<double>(s.inUseBytes()); }, true},
+            {"Heap free (fragmentation)", [](const Sample& s) { return static_cast<double>(s.freeBytes); }, true},
+            {"Read p99", [](const Sample& s) { return static_cast<double>(s.readP99Ns); }, true},
+            {"Write p99", [](const Sample& s) { return static_cast<double>(s.writeP99Ns); }, true},
+            {"Read throughput", [](const Sample& s) { return s.readsPerSec; }, false},
+            {"Write throughput", [](const Sample& s) { return s.writesPerSec; }, false},
+        };
+
+        TextTable table({"Series", "First quarter", "Last quarter", "Change", "Kendall tau", "Verdict"});
+        size_t quarter = samples.size() / 4;
+        for (const auto& entry : series) {
+            std::vector<double> values;
+            for (const auto& sample : samples) values.push_back(entry.value(sample));
+            double head = 0, tailMean = 0;
+            for (size_t i = 0; i < quarter; ++i) {
+                head += values[i];
+                tailMean += values[values.size() - 1 - i];
+            }
+            head /= quarter;
+            tailMean /= quarter;
+            double change = head != 0 ? (tailMean - head) / head : 0;
+            double tau = kendallTau(values);
+            bool worse = entry.higherIsWorse ? change > kDriftThreshold && tau > kMonotonicTau
+                                             : change < -kDriftThreshold && tau < -kMonotonicTau;
+
+            std::ostringstream changeText, tauText;
+            changeText << std::showpos << std::fixed << std::setprecision(1) << change * 100 << "%";
+            tauText << std::fixed << std::setprecision(2) << tau;
+            table.addRow({entry.name, formatValue(entry.name, head), formatValue(entry.name, tailMean), changeText.str(),
+                          tauText.str(), worse ? "DRIFT" : "stable"});
+        }
+        out << "\nDrift analysis over " << samples.size() << " samples:" << std::endl;
+        table.print(out);
+    }
+
+    /**
+     * @brief Computes Kendall's rank correlation between a series and its sample index.
+     * @param values The series in time order.
+     * @return tau in [-1, 1]; +1 means strictly increasing, -1 strictly decreasing.
+     */
+    static double kendallTau(const std::vector<double>& values) {
+        long long concordant = 0, pairs = 0;
+        for (size_t i = 0; i < values.size(); ++i) {
+            for (size_t j = i + 1; j < values.size(); ++j) {
+                if (values[j] > values[i]) ++concordant;
+                else if (values[j] < values[i]) --concordant;
+                ++pairs;
+            }
+        }
+        return pairs ? static_cast<double>(concordant) / pairs : 0.0;
+    }
+
+    /// @return A series value formatted according to its kind (bytes, latency or rate).
+    static std::string formatValue(const std::string& series, double value) {
+        if (series.find("p99") != std::string::npos) return formatNs(static_cast<uint64_t>(value));
+        if (series.find("throughput") != std::string::npos) return std::to_string(static_cast<long long>(value)) + "/s";
+        return formatBytes(static_cast<uint64_t>(value));
+    }
+
+    /// @return A nanosecond value with a readable unit.
+    static std::string formatNs(uint64_t ns) {
+        std::ostringstream out;
+        out << std::setprecision(3);
+        if (ns >= 1000000) out << ns / 1e6 << "ms";
+        else if (ns >= 1000) out << ns / 1e3 << "us";
+        else out << ns << "ns";
+        return out.str();
+    }
+
+    /// @return A byte count with a binary unit.
+    static std::string formatBytes(uint64_t bytes) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1);
+        if (bytes >= (1ull << 30)) out << bytes / double(1ull << 30) << "G";
+        else if (bytes >= (1ull << 20)) out << bytes / double(1ull << 20) << "M";
+        else out << bytes / 1024.0 << "K";
+        return out.str();
+    }
+
+    int numReaders;                  /**< Number of reader threads. */
+    int numWriters;                  /**< Number of writer threads. */
+    std::string lockName;            /**< Lock under test: `shared` or `standard`. */
+    std::chrono::seconds duration;   /**< Total run time. */
+    std::chrono::seconds interval;   /**< Time between samples. */
+
+    std::vector<Slot> readerSlots;   /**< Interval counters of the readers. */
+    std::vector<Slot> writerSlots;   /**< Interval counters of the writers. */
+    std::atomic<bool> stop{false};   /**< Set when the soak duration has passed. */
+    std::atomic<bool> priorityWarned{false}; /**< Set once a thread failed to apply its scheduling. */
+
+    SharedData sharedData;           /**< Shared data accessed by readers and writers. */
+    std::shared_mutex sharedMutex;   /**< Lock used when `lockName` is `shared`. */
+    std::mutex standardMutex;        /**< Lock used when `lockName` is `standard`. */
+};
+
+/**
+ * @struct SimulationCosts
+ * @brief Cost model of the simulated machine, in nanoseconds.
+ *
+ * `calibrate()` measures every cost the local box can show: the critical sections, atomic
+ * operations, futex park and wake, thread creation and the per-operation instrumentation.
+ * The cache-line transfer latency needs two CPUs; on a single-CPU box, or to model a larger
+ * machine with slower interconnect, it is taken from the command line.
+ */
+struct SimulationCosts {
+    double readNs = 0;          /**< Read critical section with the payload in the core's cache. */
+    double writeNs = 0;         /**< Write critical section: generating and installing a payload. */
+    double payloadMissNs = 0;   /**< Extra read time after another core replaced the payload. */
+    double localRmwNs = 0;      /**< Atomic read-modify-write on a cache line the core already owns. */
+    double transferNs = 100;    /**< Atomic read-modify-write that pulls the line from another core. */
+    double parkNs = 0;          /**< From a failed acquire until the thread sleeps in the kernel. */
+    double wakeNs = 0;          /**< Cost to the releasing thread of waking one sleeper. */
+    double wakeLatencyNs = 0;   /**< From the wake until the woken thread runs, or a context switch. */
+    double spawnNs = 0;         /**< Creating one thread; a test creates its threads one after another. */
+    double overheadNs = 0;      /**< Work per operation outside the lock (clock reads, histograms). */
+    double quantumNs = 3e6;     /**< Scheduler time slice when threads outnumber cores. */
+
+    /// Cache lines the reader copy misses on are fetched this many at a time.
+    static constexpr double kMemoryParallelism = 8;
+
+    /**
+     * @brief Measures the cost model on the local box.
+     * @param transferNs Cache-line transfer latency to use; 0 measures it when two CPUs are available.
+     * @return The calibrated costs.
+     */
+    static SimulationCosts calibrate(double transferNs) {
+        using Clock = std::chrono::steady_clock;
+        auto perOp = [](Clock::time_point start, int count) {
+            return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+        };
+        SimulationCosts costs;
+
+        SharedData data;
+        LockTester::writeOperation(data);
+        auto start = Clock::now();
+        for (int i = 0; i < 2000; ++i) LockTester::readOperation(data);
+        costs.readNs = perOp(start, 2000);
+        start = Clock::now();
+        for (int i = 0; i < 200; ++i) LockTester::writeOperation(data);
+        costs.writeNs = perOp(start, 200);
+
+        std::atomic<uint64_t> word{0};
+        start = Clock::now();
+        for (int i = 0; i < 1000000; ++i) word.fetch_add(1);
+        costs.localRmwNs = perOp(start, 1000000);
+
+        std::vector<int> cpus = allowedCpus();
+        costs.transferNs = transferNs > 0 ? transferNs : cpus.size() >= 2 ? measureTransfer(cpus[0], cpus[1]) : costs.transferNs;
+        costs.payloadMissNs = LockTester::kPayloadSize / 64.0 * costs.transferNs / kMemoryParallelism;
+
+        // A wait on a stale value and a wake without sleepers are the syscall costs of both sides
+        std::atomic<uint32_t> futexWord{0};
+        start = Clock::now();
+        for (int i = 0; i < 100000; ++i) Futex::wait(futexWord, 1);
+        costs.parkNs = perOp(start, 100000);
+        start = Clock::now();
+        for (int i = 0; i < 100000; ++i) Futex::wake(futexWord, 1);
+        costs.wakeNs = perOp(start, 100000);
+        costs.wakeLatencyNs = std::max(0.0, measureFutexHandoff() - costs.parkNs - costs.wakeNs);
+
+        start = Clock::now();
+        for (int i = 0; i < 200; ++i) std::thread([] {}).join();
+        costs.spawnNs = perOp(start, 200);
+
+        LatencyHistogram histogram;
+        start = Clock::now();
+        for (int i = 0; i < 100000; ++i) {
+            auto a = Clock::now(), b = Clock::now(), c = Clock::now();
+            histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(c - a).count());
+            histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count());
+            histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(c - b).count());
+        }
+        costs.overheadNs = perOp(start, 100000);
+        return costs;
+    }
+
+    /// @return The CPUs the process may run on.
+    static std::vector<int> allowedCpus() {
+        std::vector<int> allowed;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0)
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &set)) allowed.push_back(cpu);
+        return allowed;
+    }
+
+private:
+    /**
+     * @brief Measures one cache-line transfer by bouncing a line between two pinned threads.
+     * @param first CPU of the first thread.
+     * @param second CPU of the second thread.
+     * @return Half of the average round trip, in nanoseconds.
+     */
+    static double measureTransfer(int first, int second) {
+        constexpr int kRoundTrips = 100000;
+        std::atomic<uint32_t> turn{0};
+        auto pin = [](int cpu) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        };
+        std::chrono::steady_clock::time_point start;
+        std::thread partner([&] {
+            pin(second);
+            for (int i = 0; i < kRoundTrips; ++i) {
+                while (turn.load(std::memory_order_acquire) != 1) {}
+                turn.store(0, std::memory_order_release);
+            }
+        });
+        std::thread self([&] {
+            pin(first);
+            start = std::chrono::steady_clock::now();
+            for (int i = 0; i < kRoundTrips; ++i) {
+                turn.store(1, std::memory_order_release);
+                while (turn.load(std::memory_order_acquire) != 0) {}
+            }
+        });
+        self.join();
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        partner.join();
+        return elapsed / kRoundTrips / 2;
+    }
+
+    /**
+     * @brief Measures a futex handoff by waking a partner thread back and forth.
+     * @return Half of the average round trip, in nanoseconds.
+     */
+    static double measureFutexHandoff() {
+        constexpr int kRoundTrips = 20000;
+        std::atomic<uint32_t> ping{0}, pong{0};
+        std::thread partner([&] {
+            for (int i = 0; i < kRoundTrips; ++i) {
+                while (ping.load() != 1) Futex::wait(ping, 0);
+                ping.store(0);
+                pong.store(1);
+                Futex::wake(pong, 1);
+            }
+        });
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < kRoundTrips; ++i) {
+            ping.store(1);
+            Futex::wake(ping, 1);
+            while (pong.load() != 1) Futex::wait(pong, 0);
+            pong.store(0);
+        }
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        partner.join();
+        return elapsed / kRoundTrips / 2;
+    }
+};
+
+/**
+ * @class SimulatedLock
+ * @brief Protocol model of one lock of the benchmark family for `LockSimulator`.
+ *
+ * A model only keeps the logical lock state and its sleepers; the simulator charges the
+ * atomic operations on the lock word, parking and waking according to `SimulationCosts`.
+ * Every acquire and every release is one read-modify-write of the lock's cache line.
+ */
+class SimulatedLock {
+public:
+    virtual ~SimulatedLock() = default;
+
+    /**
+     * @brief Tries to take the lock with the atomic operation the thread just completed.
+     * @param exclusive Whether a writer asks for the lock.
+     * @return Whether the lock was taken.
+     */
+    virtual bool tryAcquire(bool exclusive) = 0;
+
+    /**
+     * @brief Checks whether an acquire would succeed, as the kernel does before a futex wait sleeps.
+     * @param exclusive Whether a writer asks for the lock.
+     * @return Whether the lock is free for the asking thread.
+     */
+    virtual bool available(bool exclusive) const = 0;
+
+    /**
+     * @brief Puts a thread to sleep on the lock.
+     * @param thread Simulator index of the thread.
+     * @param exclusive Whether the thread is a writer.
+     */
+    virtual void park(int thread, bool exclusive) = 0;
+
+    /**
+     * @brief Releases the lock.
+     * @param exclusive Whether a writer releases it.
+     * @param wake Receives the sleepers the releasing thread wakes.
+     */
+    virtual void release(bool exclusive, std::vector<int>& wake) = 0;
+
+    /**
+     * @brief Creates a fresh model of a lock of the family.
+     * @param lockName A name from `LockTester::lockNames()`.
+     * @return The model, or null if the lock has no model.
+     */
+    static std::unique_ptr<SimulatedLock> create(const std::string& lockName);
+};
+
+/**
+ * @class SimulatedMutex
+ * @brief Model of glibc's futex-based `std::mutex`: no spinning, released locks can be barged.
+ *
+ * A failed acquire sleeps at once. Unlock wakes one sleeper, which then competes again with
+ * every running thread; if it loses it goes back to sleep at the end of the queue.
+ */
+class SimulatedMutex final : public SimulatedLock {
+public:
+    bool tryAcquire(bool) override {
+        if (held) return false;
+        held = true;
+        return true;
+    }
+
+    bool available(bool) const override { return !held; }
+
+    void park(int thread, bool) override { sleepers.push_back(thread); }
+
+    void release(bool, std::vector<int>& wake) override {
+        held = false;
+        if (!sleepers.empty()) {
+            wake.push_back(sleepers.front());
+            sleepers.pop_front();
+        }
+    }
+
+private:
+    bool held = false;        /**< Whether a thread holds the mutex. */
+    std::deque<int> sleepers; /**< Threads sleeping in futex wait, oldest first. */
+};
+
+/**
+ * @class SimulatedSharedMutex
+ * @brief Model of glibc's `pthread_rwlock_t` behind `std::shared_mutex` (reader preference).
+ *
+ * Readers enter whenever no writer holds the lock, even if writers wait. The last reader out
+ * wakes one writer; a writer wakes every sleeping reader and one writer.
+ */
+class SimulatedSharedMutex final : public SimulatedLock {
+public:
+    bool tryAcquire(bool exclusive) override {
+        if (!available(exclusive)) return false;
+        if (exclusive) writer = true;
+        else ++readers;
+        return true;
+    }
+
+    bool available(bool exclusive) const override { return !writer && (!exclusive || readers == 0); }
+
+    void park(int thread, bool exclusive) override { (exclusive ? sleepingWriters : sleepingReaders).push_back(thread); }
+
+    void release(bool exclusive, std::vector<int>& wake) override {
+        if (exclusive) {
+            writer = false;
+            wake.insert(wake.end(), sleepingReaders.begin(), sleepingReaders.end());
+            sleepingReaders.clear();
+        } else if (--readers > 0) {
+            return;
+        }
+        if (!sleepingWriters.empty()) {
+            wake.push_back(sleepingWriters.front());
+            sleepingWriters.pop_front();
+        }
+    }
+
+private:
+    bool writer = false;             /**< Whether a writer holds the lock. */
+    int readers = 0;                 /**< Readers holding the lock. */
+    std::deque<int> sleepingReaders; /**< Readers sleeping until the writer leaves. */
+    std::deque<int> sleepingWriters; /**< Writers sleeping until the lock is free, oldest first. */
+};
+
+std::unique_ptr<SimulatedLock> SimulatedLock::create(const std::string& lockName) {
+    if (lockName == "Shared Mutex") return std::make_unique<SimulatedSharedMutex>();
+    if (lockName == "Standard Mutex") return std::make_unique<SimulatedMutex>();
+    return nullptr;
+}
+
+/**
+ * @class LockSimulator
+ * @brief Discrete-event simulation of one LockTester test case in virtual time.
+ *
+ * Every reader and writer is a state machine that runs the same loop as `LockTester`:
+ * instrumentation, an atomic on the lock word, the critical section, an atomic to release
+ * and possibly a futex wake. Atomics on the lock word are serialized on its cache line, which
+ * costs a transfer whenever the previous owner was another core. A reader pays the payload
+ * misses once after every write by another core. Threads that fail to acquire park and are
+ * woken as the lock model decides. When threads outnumber cores, cores are time-sliced with
+ * a FIFO run queue, so a holder can be preempted inside its critical section as on a real box.
+ */
+class LockSimulator final {
+public:
+    /**
+     * @struct Result
+     * @brief Outcome of one simulated test.
+     */
+    struct Result {
+        double elapsedNs = 0;    /**< Virtual time from the first thread creation to the last thread's exit. */
+        uint64_t operations = 0; /**< Completed reads and updates. */
+        uint64_t transfers = 0;  /**< Lock-word cache-line transfers between cores. */
+        uint64_t parks = 0;      /**< Times a thread slept on the lock. */
+
+        /// @return Operations per second of virtual time.
+        double throughput() const { return elapsedNs > 0 ? operations * 1e9 / elapsedNs : 0.0; }
+    };
+
+    /**
+     * @brief Constructs a simulator of a machine.
+     * @param costs The cost model.
+     * @param cores Number of cores of the simulated machine.
+     */
+    LockSimulator(const SimulationCosts& costs, int cores) : costs(costs), cores(std::max(1, cores)) {}
+
+    /**
+     * @brief Simulates one lock of a test case.
+     * @param lockName A name from `LockTester::lockNames()`.
+     * @param numReaders Reader threads.
+     * @param numWriters Writer threads.
+     * @param numReads Reads per reader.
+     * @param numUpdates Updates per writer.
+     * @return Virtual time and counters of the run.
+     * @throws std::invalid_argument If the lock has no model.
+     */
+    Result run(const std::string& lockName, int numReaders, int numWriters, int numReads, int numUpdates) {
+        lock = SimulatedLock::create(lockName);
+        if (!lock) throw std::invalid_argument("no simulation model for " + lockName);
+        threads.assign(numReaders + numWriters, Thread{});
+        for (int i = 0; i < numReaders + numWriters; ++i) {
+            threads[i].writer = i >= numReaders;
+            threads[i].remaining = threads[i].writer ? numUpdates : numReads;
+        }
+        events = decltype(events)();
+        runQueue.clear();
+        freeCores.clear();
+        for (int core = cores - 1; core >= 0; --core) freeCores.push_back(core);
+        coreVersion.assign(cores, 0);
+        result = Result{};
+        order = 0;
+        now = 0;
+        lineOwner = -1;
+        lineFree = 0;
+        payloadVersion = 1;
+
+        // The test creates readers first, then writers, one after another
+        for (size_t i = 0; i < threads.size(); ++i) schedule(i * costs.spawnNs, static_cast<int>(i), Step::Runnable);
+
+        while (!events.empty()) {
+            Event event = events.top();
+            events.pop();
+            now = event.time;
+            step(event.thread, event.step);
+        }
+        result.elapsedNs = now;
+        return result;
+    }
+
+private:
+    /// The points of the reader and writer loop at which a thread's next action is decided.
+    enum class Step { Runnable, Begin, Acquire, Attempt, Park, Release, Released, Preempt, Finish };
+
+    /**
+     * @struct Thread
+     * @brief State of one simulated reader or writer.
+     */
+    struct Thread {
+        bool writer = false;        /**< Whether the thread updates the payload. */
+        int remaining = 0;          /**< Operations still to perform. */
+        int core = -1;              /**< Core the thread runs on, or -1 while it sleeps or waits for a core. */
+        double sliceEnd = 0;        /**< End of the thread's current time slice. */
+        Step pending = Step::Begin; /**< Step to run after `pendingNs` more work. */
+        double pendingNs = 0;       /**< Work left before `pending`. */
+    };
+
+    /**
+     * @struct Event
+     * @brief A step of a thread due at a point in virtual time.
+     */
+    struct Event {
+        double time;    /**< Virtual time in nanoseconds. */
+        uint64_t order; /**< Tie breaker keeping simultaneous events in scheduling order. */
+        int thread;     /**< Index of the thread. */
+        Step step;      /**< Step to run. */
+
+        bool operator>(const Event& other) const { return time != other.time ? time > other.time : order > other.order; }
+    };
+
+    /// Queues a step of a thread at a point in virtual time.
+    void schedule(double time, int thread, Step next) { events.push(Event{time, order++, thread, next}); }
+
+    /**
+     * @brief Lets a running thread work for a while, then continues with the next step.
+     * @param index The thread.
+     * @param ns Work in nanoseconds.
+     * @param next Step after the work.
+     *
+     * If the work outlasts the time slice, the thread is preempted at the end of the slice
+     * and finishes the rest when it gets a core again.
+     */
+    void work(int index, double ns, Step next) {
+        Thread& thread = threads[index];
+        if (static_cast<int>(threads.size()) <= cores || now + ns <= thread.sliceEnd) {
+            schedule(now + ns, index, next);
+            return;
+        }
+        thread.pendingNs = now + ns - thread.sliceEnd;
+        thread.pending = next;
+        schedule(thread.sliceEnd, index, Step::Preempt);
+    }
+
+    /// Gives a core to a thread and resumes its pending work after the switch.
+    void dispatch(int index, int core, double switchNs) {
+        Thread& thread = threads[index];
+        thread.core = core;
+        thread.sliceEnd = now + switchNs + costs.quantumNs;
+        work(index, switchNs + thread.pendingNs, thread.pending);
+    }
+
+    /// Takes the core from a thread and hands it to the next runnable thread, if any.
+    void releaseCore(int index) {
+        int core = threads[index].core;
+        threads[index].core = -1;
+        if (runQueue.empty()) {
+            freeCores.push_back(core);
+            return;
+        }
+        int next = runQueue.front();
+        runQueue.pop_front();
+        dispatch(next, core, costs.wakeLatencyNs);
+    }
+
+    /**
+     * @brief Performs an atomic read-modify-write on the lock word from a core.
+     * @param core The core.
+     * @return Virtual time at which the operation completes.
+     *
+     * The line serves one atomic at a time; a core that does not own it pays a transfer.
+     */
+    double lineAccess(int core) {
+        double start = std::max(now, lineFree);
+        bool transfer = lineOwner != core;
+        if (transfer) ++result.transfers;
+        lineOwner = core;
+        lineFree = start + (transfer ? costs.transferNs : costs.localRmwNs);
+        return lineFree;
+    }
+
+    /// Runs one step of a thread at the current virtual time.
+    void step(int index, Step current) {
+        Thread& thread = threads[index];
+        switch (current) {
+        case Step::Runnable:
+            if (freeCores.empty()) {
+                runQueue.push_back(index);
+            } else {
+                int core = freeCores.back();
+                freeCores.pop_back();
+                dispatch(index, core, 0);
+            }
+            break;
+        case Step::Begin:
+            if (thread.remaining == 0) work(index, 0, Step::Finish);
+            else work(index, costs.overheadNs, Step::Acquire);
+            break;
+        case Step::Acquire:
+            work(index, lineAccess(thread.core) - now, Step::Attempt);
+            break;
+        case Step::Attempt:
+            if (lock->tryAcquire(thread.writer)) {
+                double critical = costs.writeNs;
+                if (!thread.writer) {
+                    critical = costs.readNs + (coreVersion[thread.core] != payloadVersion ? costs.payloadMissNs : 0);
+                    coreVersion[thread.core] = payloadVersion;
+                }
+                work(index, critical, Step::Release);
+            } else {
+                ++result.parks;
+                work(index, costs.parkNs, Step::Park);
+            }
+            break;
+        case Step::Park:
+            // The futex wait returns at once if the lock changed since the failed attempt
+            if (lock->available(thread.writer)) {
+                work(index, 0, Step::Acquire);
+            } else {
+                lock->park(index, thread.writer);
+                thread.pending = Step::Acquire;
+                thread.pendingNs = 0;
+                releaseCore(index);
+            }
+            break;
+        case Step::Release:
+            work(index, lineAccess(thread.core) - now, Step::Released);
+            break;
+        case Step::Released: {
+            if (thread.writer) coreVersion[thread.core] = ++payloadVersion;
+            std::vector<int> woken;
+            lock->release(thread.writer, woken);
+            for (int sleeper : woken) schedule(now + costs.wakeLatencyNs, sleeper, Step::Runnable);
+            --thread.remaining;
+            ++result.operations;
+            work(index, costs.wakeNs * woken.size(), Step::Begin);
+            break;
+        }
+        case Step::Preempt:
+            if (runQueue.empty()) {
+                thread.sliceEnd = now + costs.quantumNs;
+                work(index, thread.pendingNs, thread.pending);
+            } else {
+                runQueue.push_back(index);
+                releaseCore(index);
+            }
+            break;
+        case Step::Finish:
+            releaseCore(index);
+            break;
+        }
+    }
+
+    SimulationCosts costs; /**< The cost model. */
+    int cores;             /**< Cores of the simulated machine. */
+
+    std::unique_ptr<SimulatedLock> lock; /**< Protocol model of the lock under test. */
+    std::vector<Thread> threads;         /**< Readers first, then writers. */
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events; /**< Pending steps by time. */
+    std::deque<int> runQueue;            /**< Runnable threads waiting for a core. */
+    std::vector<int> freeCores;          /**< Idle cores. */
+    std::vector<uint64_t> coreVersion;   /**< Payload version each core has cached. */
+    Result result;                       /**< Counters of the current run. */
+    uint64_t order = 0;                  /**< Next event tie breaker. */
+    double now = 0;                      /**< Current virtual time. */
+    int lineOwner = -1;                  /**< Core that owns the lock word's cache line. */
+    double lineFree = 0;                 /**< Time at which the lock word's line is next available. */
+    uint64_t payloadVersion = 1;         /**< Incremented by every completed write. */
+};
+
+/**
+ * @class ScalingStudy
+ * @brief Calibrates `LockSimulator` on the local box and predicts the test cases on larger machines.
+ *
+ * Each test case is scaled down to a bounded number of operations per thread so the study
+ * runs in seconds; throughput is a steady-state rate, so fewer operations predict the same
+ * rate. The scaled cases first run for real and in simulation at the local core count. The
+ * ratio of measured to simulated time per lock is the calibration factor applied to the
+ * predictions, which keep the reader/writer mix of each case with one thread per core and
+ * start all threads together to show the steady-state rate.
+ */
+class ScalingStudy final {
+public:
+    /**
+     * @brief Constructs a study.
+     * @param testCases (readers, writers, reads per reader, updates per writer) of each test case.
+     * @param coreCounts Core counts of the machines to predict.
+     * @param opsPerThread Upper bound of reads or updates per thread.
+     * @param transferNs Cache-line transfer latency; 0 measures it if possible.
+     */
+    ScalingStudy(std::vector<std::tuple<int, int, int, int>> testCases, std::vector<int> coreCounts, int opsPerThread, double transferNs)
+        : testCases(std::move(testCases)), coreCounts(std::move(coreCounts)), opsPerThread(std::max(1, opsPerThread)),
+          transferNs(transferNs) {}
+
+    /// Calibrates, prints the cost model, the calibration and the predictions.
+    void run() {
+        SimulationCosts costs = SimulationCosts::calibrate(transferNs);
+        int localCores = static_cast<int>(std::max<size_t>(1, SimulationCosts::allowedCpus().size()));
+        printCosts(costs);
+
+        std::vector<std::string> locks;
+        for (const std::string& lock : LockTester::lockNames())
+            if (SimulatedLock::create(lock)) locks.push_back(lock);
+        std::map<std::string, double> logRatioSum;
+        TextTable calibration({"Case", "Scaled ops", "Lock", "Measured", "Simulated", "Error"});
+        LockSimulator local(costs, localCores);
+        for (const auto& testCase : testCases) {
+            int readers, writers, reads, updates;
+            std::tie(readers, writers, reads, updates) = scaled(testCase);
+            LockTester tester(readers, writers, reads, updates);
+            tester.testSharedMutex();
+            tester.testStandardMutex();
+            for (const std::string& lock : locks) {
+                double operations = static_cast<double>(readers) * reads + static_cast<double>(writers) * updates;
+                double measuredNs = operations * 1e9 / tester.metrics.value(LockTester::definitions().locks.at(lock).throughput);
+                double simulatedNs = local.run(lock, readers, writers, reads, updates).elapsedNs;
+                logRatioSum[lock] += std::log(measuredNs / simulatedNs);
+                calibration.addRow({describe(testCase), std::to_string(reads) + "/" + std::to_string(updates), lock,
+                                    LatencyHistogram::format(static_cast<uint64_t>(measuredNs)),
+                                    LatencyHistogram::format(static_cast<uint64_t>(simulatedNs)),
+                                    percent(simulatedNs / measuredNs - 1)});
+            }
+        }
+        std::cout << "\nCalibration on this box (" << localCores << " cores)\n";
+        calibration.print();
+
+        std::map<std::string, double> factor;
+        for (const std::string& lock : locks) {
+            factor[lock] = std::exp(logRatioSum[lock] / testCases.size());
+            std::cout << lock << " calibration factor (measured / simulated time): " << std::fixed << std::setprecision(2)
+                      << factor[lock] << std::defaultfloat << "\n";
+        }
+
+        std::vector<std::string> headers = {"Case", "Lock"};
+        for (int cores : coreCounts) headers.push_back(std::to_string(cores) + " cores");
+        TextTable prediction(headers);
+        std::vector<std::string> winnerHeaders = {"Case"};
+        for (int cores : coreCounts) winnerHeaders.push_back(std::to_string(cores) + " cores");
+        TextTable winners(winnerHeaders);
+        // Creating a thousand threads one by one would dominate the prediction; they start together
+        SimulationCosts steady = costs;
+        steady.spawnNs = 0;
+        for (const auto& testCase : testCases) {
+            std::map<std::string, std::vector<double>> rates, rawRates;
+            for (int cores : coreCounts) {
+                LockSimulator machine(steady, cores);
+                int writers = std::get<1>(testCase) > 0 ? std::max(1, static_cast<int>(std::lround(
+                                  std::get<1>(testCase) * static_cast<double>(cores) / (std::get<0>(testCase) + std::get<1>(testCase))))) : 0;
+                int readers = std::max(1, cores - writers);
+                int reads, updates;
+                std::tie(std::ignore, std::ignore, reads, updates) = scaled(testCase);
+                for (const std::string& lock : locks) {
+                    rawRates[lock].push_back(machine.run(lock, readers, writers, reads, updates).throughput());
+                    rates[lock].push_back(rawRates[lock].back() / factor[lock]);
+                }
+            }
+            // Winners are picked from the model alone, so the per-lock factors cannot decide a tie
+            std::vector<std::string> winnerRow = {describe(testCase)};
+            for (size_t column = 0; column < coreCounts.size(); ++column) {
+                auto best = std::max_element(locks.begin(), locks.end(), [&](const std::string& a, const std::string& b) {
+                    return rawRates[a][column] < rawRates[b][column];
+                });
+                double runnerUp = 0;
+                for (const std::string& lock : locks)
+                    if (lock != *best) runnerUp = std::max(runnerUp, rawRates[lock][column]);
+                double lead = runnerUp > 0 ? rawRates[*best][column] / runnerUp : 0;
+                std::ostringstream cell;
+                if (lead > 0 && lead < kTieRatio) cell << "tie";
+                else cell << *best;
+                if (lead > 0) cell << " (" << std::fixed << std::setprecision(2) << lead << "x)";
+                winnerRow.push_back(cell.str());
+            }
+            for (const std::string& lock : locks) {
+                std::vector<std::string> row = {describe(testCase), lock};
+                for (double rate : rates[lock]) row.push_back(formatRate(rate));
+                prediction.addRow(row);
+            }
+            winners.addRow(winnerRow);
+        }
+        std::cout << "\nPredicted throughput, one thread per core, reader/writer mix of each case (calibrated)\n";
+        prediction.print();
+        std::cout << "\nFastest lock per core count (simulated lead over the runner-up)\n";
+        winners.print();
+    }
+
+    /// @return A test case as `READERSr/WRITERSw READS/UPDATES`.
+    static std::string describe(const std::tuple<int, int, int, int>& testCase) {
+        return std::to_string(std::get<0>(testCase)) + "r/" + std::to_string(std::get<1>(testCase)) + "w " +
+               std::to_string(std::get<2>(testCase)) + "/" + std::to_string(std::get<3>(testCase));
+    }
+
+    /// @return An operation rate such as `1.25 M ops/s`.
+    static std::string formatRate(double rate) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(2);
+        if (rate >= 1e6) out << rate / 1e6 << " M ops/s";
+        else if (rate >= 1e3) out << rate / 1e3 << " k ops/s";
+        else out << rate << " ops/s";
+        return out.str();
+    }
+
+private:
+    /// Leads below this ratio are within the model's error and reported as a tie.
+    static constexpr double kTieRatio = 1.02;
+
+    /// @return The test case with reads and updates per thread scaled to at most `opsPerThread`.
+    std::tuple<int, int, int, int> scaled(const std::tuple<int, int, int, int>& testCase) const {
+        int readers, writers, reads, updates;
+        std::tie(readers, writers, reads, updates) = testCase;
+        double scale = std::min(1.0, static_cast<double>(opsPerThread) / std::max(1, std::max(reads, updates)));
+        auto shrink = [scale](int ops) { return ops > 0 ? std::max(1, static_cast<int>(std::lround(ops * scale))) : 0; };
+        return std::make_tuple(readers, writers, shrink(reads), shrink(updates));
+    }
+
+    /// @return A signed percentage such as `+12.5%`.
+    static std::string percent(double fraction) {
+        std::ostringstream out;
+        out << std::showpos << std::fixed << std::setprecision(1) << fraction * 100 << "%";
+        return out.str();
+    }
+
+    /// Prints the calibrated cost model.
+    static void printCosts(const SimulationCosts& costs) {
+        TextTable table({"Cost", "Value"});
+        auto row = [&table](const std::string& name, double ns) {
+            std::ostringstream value;
+            value << std::fixed << std::setprecision(1) << ns << " ns";
+            table.addRow({name, value.str()});
+        };
+        row("Read critical section", costs.readNs);
+        row("Write critical section", costs.writeNs);
+        row("Payload misses after a write", costs.payloadMissNs);
+        row("Local atomic", costs.localRmwNs);
+        row("Cache-line transfer", costs.transferNs);
+        row("Park (futex wait)", costs.parkNs);
+        row("Wake (futex wake)", costs.wakeNs);
+        row("Wake-up latency", costs.wakeLatencyNs);
+        row("Thread creation", costs.spawnNs);
+        row("Instrumentation per operation", costs.overheadNs);
+        row("Time slice", costs.quantumNs);
+        std::cout << "Simulation cost model\n";
+        table.print();
+    }
+
+    std::vector<std::tuple<int, int, int, int>> testCases; /**< Test cases to calibrate and predict. */
+    std::vector<int> coreCounts; /**< Core counts of the predicted machines. */
+    int opsPerThread;            /**< Upper bound of reads or updates per thread. */
+    double transferNs;           /**< Cache-line transfer latency, 0 to measure. */
+};
+
+/**
+ * @class InterferenceStudy
+ * @brief Runs several LockTester instances at once and reports how each slows down versus running alone.
+ *
+ * Every instance has its own SharedData and locks, so the instances never contend for the
+ * same lock; whatever slows them down is shared hardware and kernel state: cores, last-level
+ * cache, memory bandwidth and futex hash buckets. The shared and standard mutexes always run,
+ * the others as the benchmark's `--pi`, `--parking` and `--lease` enable them, the lease lock
+ * again only in read-dominated cases. Each test case and lock first runs alone,
+ * then `instances` copies start together through a barrier. Threads are pinned: with
+ * `disjoint` instance `k` gets the CPUs after those of instance `k - 1`, wrapping around the
+ * allowed CPUs; otherwise all instances use the same CPUs. When the instances of a test case
+ * need more CPUs than are allowed, the wrap makes them share cores, and its rows are marked
+ * as overlapping. An instance that finishes early
+ * stops interfering, so the slowdown of the fastest instance is the conservative one.
+ */
+class InterferenceStudy final {
+public:
+    /**
+     * @brief Constructs a study.
+     * @param testCases (readers, writers, reads per reader, updates per writer) of each test case.
+     * @param instances Testers running at once.
+     * @param disjoint Give each instance its own CPUs instead of the same ones.
+     * @param seed Seed from which every instance's seed is derived.
+     * @param locks Locks to run, names from `LockTester::lockNames()` except `Node Replicated`.
+     * @param leaseTime Lease length of the lease lock.
+     * @throws std::invalid_argument For a lock this study cannot run.
+     */
+    InterferenceStudy(std::vector<std::tuple<int, int, int, int>> testCases, int instances, bool disjoint, uint64_t seed,
+                      std::vector<std::string> locks, std::chrono::microseconds leaseTime)
+        : testCases(std::move(testCases)), instances(std::max(2, instances)), disjoint(disjoint), seed(seed),
+          locks(std::move(locks)), leaseTime(leaseTime) {
+        for (const std::string& lock : this->locks)
+            if (!tests().count(lock)) throw std::invalid_argument("interfere cannot run lock '" + lock + "'");
+    }
+
+    /// Runs every test case alone and concurrently and prints the slowdowns.
+    void run() {
+        int cpus = static_cast<int>(std::max<size_t>(1, SimulationCosts::allowedCpus().size()));
+        TextTable table({"Case", "Lock", "CPUs", "Alone", "Concurrent mean", "Concurrent min", "Slowdown", "Worst slowdown"});
+        bool overlapped = false;
+        for (size_t c = 0; c < testCases.size(); ++c) {
+            int threads = std::get<0>(testCases[c]) + std::get<1>(testCases[c]);
+            bool overlapping = disjoint && instances * threads > cpus;
+            overlapped |= overlapping;
+            std::string placement = !disjoint ? "same" : overlapping ? "overlapping (" + std::to_string(instances * threads) + " threads)" : "disjoint";
+            for (const std::string& lock : locks) {
+                if (lock == "Lease Lock" && !LockTester::readDominated(std::get<0>(testCases[c]), std::get<1>(testCases[c]),
+                                                                       std::get<2>(testCases[c]), std::get<3>(testCases[c])))
+                    continue;
+                double alone = runInstances(testCases[c], lock, 1).front();
+                std::vector<double> together = runInstances(testCases[c], lock, instances);
+                double sum = 0;
+                for (double rate : together) sum += rate;
+                double mean = sum / together.size();
+                double worst = *std::min_element(together.begin(), together.end());
+                table.addRow({ScalingStudy::describe(testCases[c]), lock, placement, ScalingStudy::formatRate(alone),
+                              ScalingStudy::formatRate(mean), ScalingStudy::formatRate(worst), slowdown(alone, mean), slowdown(alone, worst)});
+            }
+        }
+        if (overlapped)
+            std::cerr << "Warning: " << instances << " instances do not fit on " << cpus
+                      << " allowed CPUs in every case; rows marked overlapping share cores" << std::endl;
+        std::cout << "\nInterference of " << instances << " concurrent instances on "
+                  << (disjoint ? "disjoint" : "the same") << " CPUs" << (overlapped ? " where they fit" : "") << " (" << cpus
+                  << " allowed), throughput per instance:" << std::endl;
+        table.print();
+    }
+
+private:
+    /**
+     * @brief Runs one test case and lock on `count` testers at once.
+     * @return The throughput of each tester, in operations per second.
+     */
+    std::vector<double> runInstances(const std::tuple<int, int, int, int>& testCase, const std::string& lock, int count) const {
+        int readers, writers, reads, updates;
+        std::tie(readers, writers, reads, updates) = testCase;
+        std::vector<std::unique_ptr<LockTester>> testers;
+        for (int k = 0; k < count; ++k) {
+            testers.push_back(std::make_unique<LockTester>(readers, writers, reads, updates));
+            testers.back()->seed = RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(k)});
+            testers.back()->pinThreads = true;
+            testers.back()->cpuOffset = disjoint ? k * (readers + writers) : 0;
+            testers.back()->leaseTime = leaseTime;
+        }
+        std::atomic<int> ready{0};
+        std::vector<std::thread> runners;
+        for (int k = 0; k < count; ++k) {
+            runners.emplace_back([&, k] {
+                ready.fetch_add(1);
+                while (ready.load() < count) std::this_thread::yield();
+                (testers[k].get()->*tests().at(lock))();
+            });
+        }
+        for (auto& t : runners) t.join();
+        std::vector<double> rates;
+        for (const auto& tester : testers) rates.push_back(tester->metrics.value(LockTester::definitions().locks.at(lock).throughput));
+        return rates;
+    }
+
+    /// @return The test of every lock this study can run, by name.
+    static const std::map<std::string, void (LockTester::*)()>& tests() {
+        static const std::map<std::string, void (LockTester::*)()> byName = {
+            {"Shared Mutex", &LockTester::testSharedMutex},   {"Standard Mutex", &LockTester::testStandardMutex},
+            {"PI Mutex", &LockTester::testPiMutex},           {"Futex PI", &LockTester::testFutexPi},
+            {"Lease Lock", &LockTester::testLeaseLock},       {"Parking Mutex", &LockTester::testParkingMutex},
+            {"Parking Shared", &LockTester::testParkingShared}};
+        return byName;
+    }
+
+    /// @return How much slower `rate` is than `alone`, in percent.
+    static std::string slowdown(double alone, double rate) {
+        std::ostringstream out;
+        out << std::fixed << std::setprecision(1) << (alone > 0 ? 100.0 * (1 - rate / alone) : 0.0) << "%";
+        return out.str();
+    }
+
+    std::vector<std::tuple<int, int, int, int>> testCases; /**< Test cases to run. */
+    int instances;  /**< Testers running at once. */
+    bool disjoint;  /**< Whether instances get their own CPUs. */
+    uint64_t seed;  /**< Seed of the instances. */
+    std::vector<std::string> locks;     /**< Locks to run, in report order. */
+    std::chrono::microseconds leaseTime; /**< Lease length of the lease lock. */
+};
+
+/**
+ * @class ZipfianGenerator
+ * @brief Draws ranks 0..n-1 with Zipfian popularity, rank 0 being the most popular.
+ *
+ * Uses the rejection-free method of Gray et al. ("Quickly generating billion-record synthetic
+ * databases") that YCSB uses; the zeta constant is computed once in O(n).
+ */
+class ZipfianGenerator final {
+public:
+    /**
+     * @brief Constructs a generator.
+     * @param items Number of ranks.
+     * @param theta Skew in (0, 1); 0.99 is the YCSB default.
+     * @throws std::invalid_argument If theta is outside (0, 1) or there are no items.
+     */
+    ZipfianGenerator(uint64_t items, double theta) : items(items), theta(theta) {
+        if (items == 0 || theta <= 0 || theta >= 1) throw std::invalid_argument("Zipfian skew must be in (0, 1)");
+        double zeta2 = 1 + std::pow(0.5, theta);
+        for (uint64_t i = 1; i <= items; ++i) zetaN += 1 / std::pow(static_cast<double>(i), theta);
+        alpha = 1 / (1 - theta);
+        eta = (1 - std::pow(2.0 / items, 1 - theta)) / (1 - zeta2 / zetaN);
+    }
+
+    /**
+     * @brief Draws the next rank.
+     * @param engine Random engine of the calling thread.
+     * @return A rank in [0, items).
+     */
+    uint64_t next(std::mt19937_64& engine) const {
+        double u = std::uniform_real_distribution<double>(0, 1)(engine);
+        double uz = u * zetaN;
+        if (uz < 1) return 0;
+        if (uz < 1 + std::pow(0.5, theta)) return 1;
+        return std::min(items - 1, static_cast<uint64_t>(items * std::pow(eta * u - eta + 1, alpha)));
+    }
+
+private:
+    uint64_t items;    /**< Number of ranks. */
+    double theta;      /**< Skew. */
+    double zetaN = 0;  /**< Sum of 1/i^theta over all ranks. */
+    double alpha = 0;  /**< 1 / (1 - theta). */
+    double eta = 0;    /**< Scale of the inverse transform. */
+};
+
+/**
+ * @class AdaptiveShardedStore
+ * @brief A keyed store of `SharedData` entries whose lock stripes split when hot and merge when cold.
+ *
+ * The key space is divided into a fixed number of slots, and a stripe guards a contiguous
+ * range of slots with one `std::shared_mutex`. A directory maps every slot to its stripe.
+ * Accessors first try the lock and count a failed try as contention. With `adaptive` set, a
+ * rebalancer thread looks at each stripe's contention every interval and splits stripes
+ * whose contended share exceeds `splitThreshold` into two halves. It merges neighbours that
+ * saw little traffic and no contention.
+ *
+ * Resize protocol: the rebalancer locks the old stripes exclusively, points the directory at
+ * the new stripes, marks the old ones retired and unlocks them. An accessor that read the
+ * directory before the switch then finds its stripe retired once it gets the lock, and
+ * retries with a fresh directory entry. So no thread ever holds an old and a new stripe for
+ * the same slot at once. Retired stripes stay allocated until the store is destroyed, which
+ * keeps stale directory reads safe without hazard pointers.
+ */
+class AdaptiveShardedStore final {
+public:
+    /**
+     * @struct Config
+     * @brief Size and resize policy of a store.
+     */
+    struct Config {
+        size_t keys = 100000;          /**< Number of entries. */
+        size_t slots = 1024;           /**< Finest striping granularity. */
+        size_t initialStripes = 16;    /**< Stripes at construction; also the fixed count without `adaptive`. */
+        size_t payloadSize = 256;      /**< Characters of each entry's text. */
+        bool adaptive = true;          /**< Whether the rebalancer splits and merges stripes. */
+        double splitThreshold = 0.01;  /**< Contended share of acquisitions above which a stripe splits. */
+        uint64_t minSamples = 100;     /**< Acquisitions per interval a stripe needs before it is judged. */
+        std::chrono::milliseconds interval{20}; /**< Time between rebalancing passes. */
+    };
+
+    /**
+     * @brief Creates the entries and the initial stripes and starts the rebalancer if adaptive.
+     * @param config Size and resize policy.
+     */
+    explicit AdaptiveShardedStore(const Config& config)
+        : config(config), entries(config.keys), directory(std::max<size_t>(1, config.slots)) {
+        for (SharedData& entry : entries) entry.text.assign(config.payloadSize, '.');
+        size_t slots = directory.size();
+        size_t count = std::min(slots, std::max<size_t>(1, config.initialStripes));
+        for (size_t i = 0; i < count; ++i) {
+            Stripe* stripe = newStripe(i * slots / count, (i + 1) * slots / count);
+            for (size_t slot = stripe->firstSlot; slot < stripe->lastSlot; ++slot) directory[slot].store(stripe);
+        }
+        liveStripes = count;
+        if (config.adaptive) rebalancer = std::thread([this] { rebalanceLoop(); });
+    }
+
+    ~AdaptiveShardedStore() {
+        {
+            std::lock_guard<std::mutex> lock(stopMutex);
+            stopping = true;
+        }
+        stopSignal.notify_all();
+        if (rebalancer.joinable()) rebalancer.join();
+    }
+
+    AdaptiveShardedStore(const AdaptiveShardedStore&) = delete; /**< Deleted copy constructor. */
+    AdaptiveShardedStore& operator=(const AdaptiveShardedStore&) = delete; /**< Deleted copy assignment operator. */
+
+    /**
+     * @brief Reads an entry under its stripe's shared lock.
+     * @param key Key in [0, keys).
+     * @param reader Called with the entry.
+     * @return Whether the stripe was contended.
+     */
+    template <typename Reader>
+    bool read(uint64_t key, Reader&& reader) {
+        return access<std::shared_lock<std::shared_mutex>>(key, [&] { reader(static_cast<const SharedData&>(entries[key])); });
+    }
+
+    /**
+     * @brief Reads a batch of entries, taking each stripe's shared lock once.
+     * @param keys Keys in [0, keys); duplicates are read once per occurrence.
+     * @param reader Called with the position of the key in `keys` and its entry, in key order.
+     * @return The number of stripe locks taken.
+     *
+     * The keys are visited in ascending order, so the keys of a stripe, a contiguous range of
+     * slots, are consecutive and read under one hold. The visit is software-pipelined: the
+     * entry `2 * kPrefetchDistance` keys ahead is prefetched, and once its stripe is held, the
+     * payload of the entry `kPrefetchDistance` ahead, whose text pointer is then already
+     * cached. Payload prefetches stay within the held stripe, as reading the text pointer of
+     * an entry needs its lock.
+     */
+    template <typename Reader>
+    size_t readMany(const std::vector<uint64_t>& keys, Reader&& reader) {
+        thread_local std::vector<uint32_t> order;
+        order.resize(keys.size());
+        for (uint32_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::sort(order.begin(), order.end(), [&keys](uint32_t a, uint32_t b) { return keys[a] < keys[b]; });
+        auto entryAt = [&](size_t i) -> SharedData& { return entries[keys[order[i]]]; };
+        for (size_t i = 0; i < std::min(order.size(), 2 * kPrefetchDistance); ++i) __builtin_prefetch(&entryAt(i));
+
+        size_t locks = 0;
+        for (size_t begin = 0; begin < order.size();) {
+            Stripe* stripe = directory[slotOf(keys[order[begin]])].load(std::memory_order_acquire);
+            std::shared_lock<std::shared_mutex> guard(stripe->lock, std::try_to_lock);
+            if (!guard.owns_lock()) {
+                stripe->contended.fetch_add(1, std::memory_order_relaxed);
+                guard.lock();
+            }
+            if (stripe->retired) continue;
+            stripe->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            ++locks;
+            size_t end = begin;
+            while (end < order.size() && slotOf(keys[order[end]]) < stripe->lastSlot) ++end;
+            for (size_t i = begin; i < std::min(end, begin + kPrefetchDistance); ++i) __builtin_prefetch(entryAt(i).text.data());
+            for (size_t i = begin; i < end; ++i) {
+                if (i + 2 * kPrefetchDistance < order.size()) __builtin_prefetch(&entryAt(i + 2 * kPrefetchDistance));
+                if (i + kPrefetchDistance < end) __builtin_prefetch(entryAt(i + kPrefetchDistance).text.data());
+                reader(static_cast<size_t>(order[i]), static_cast<const SharedData&>(entryAt(i)));
+            }
+            begin = end;
+        }
+        return locks;
+    }
+
+    /**
+     * @brief Updates an entry under its stripe's exclusive lock.
+     * @param key Key in [0, keys).
+     * @param writer Called with the entry.
+     * @return Whether the stripe was contended.
+     */
+    template <typename Writer>
+    bool update(uint64_t key, Writer&& writer) {
+        return access<std::unique_lock<std::shared_mutex>>(key, [&] { writer(entries[key]); });
+    }
+
+    /// @return The number of stripes currently in use.
+    size_t stripeCount() const { return liveStripes.load(std::memory_order_relaxed); }
+
+    /// @return Splits performed so far.
+    uint64_t splits() const { return splitCount.load(std::memory_order_relaxed); }
+
+    /// @return Merges performed so far.
+    uint64_t merges() const { return mergeCount.load(std::memory_order_relaxed); }
+
+    /// @return The number of entries.
+    size_t size() const { return entries.size(); }
+
+    /// @return Characters of each entry's text at construction.
+    size_t payloadSize() const { return config.payloadSize; }
+
+private:
+    /**
+     * @struct Stripe
+     * @brief A lock over a range of slots with its contention counters, on its own cache lines.
+     */
+    struct alignas(64) Stripe {
+        std::shared_mutex lock;                 /**< Guards the entries of slots [firstSlot, lastSlot). */
+        std::atomic<uint32_t> acquisitions{0};  /**< Acquisitions since the last rebalancing pass. */
+        std::atomic<uint32_t> contended{0};     /**< Acquisitions whose first try failed. */
+        bool retired = false;                   /**< Set under the exclusive lock when the stripe is replaced. */
+        size_t firstSlot = 0;                   /**< First slot guarded. */
+        size_t lastSlot = 0;                    /**< One past the last slot guarded. */
+    };
+
+    /// Keys between the one read and the one whose payload `readMany()` prefetches.
+    static constexpr size_t kPrefetchDistance = 4;
+
+    /// @return The slot of a key.
+    size_t slotOf(uint64_t key) const { return static_cast<size_t>(key * directory.size() / entries.size()); }
+
+    /**
+     * @brief Locks the stripe of a key, retrying if it was retired meanwhile, and runs a body.
+     * @tparam Guard `std::shared_lock` or `std::unique_lock` of `std::shared_mutex`.
+     * @return Whether any try to lock failed.
+     */
+    template <typename Guard, typename Body>
+    bool access(uint64_t key, Body&& body) {
+        bool contended = false;
+        for (;;) {
+            Stripe* stripe = directory[slotOf(key)].load(std::memory_order_acquire);
+            Guard guard(stripe->lock, std::try_to_lock);
+            if (!guard.owns_lock()) {
+                contended = true;
+                stripe->contended.fetch_add(1, std::memory_order_relaxed);
+                guard.lock();
+            }
+            if (stripe->retired) continue;
+            stripe->acquisitions.fetch_add(1, std::memory_order_relaxed);
+            body();
+            return contended;
+        }
+    }
+
+    /// Allocates a stripe over [first, last); the store owns it until destruction.
+    Stripe* newStripe(size_t first, size_t last) {
+        stripes.push_back(std::make_unique<Stripe>());
+        stripes.back()->firstSlot = first;
+        stripes.back()->lastSlot = last;
+        return stripes.back().get();
+    }
+
+    /// Runs rebalancing passes until the store is destroyed.
+    void rebalanceLoop() {
+        std::unique_lock<std::mutex> lock(stopMutex);
+        while (!stopSignal.wait_for(lock, config.interval, [this] { return stopping; })) rebalance();
+    }
+
+    /**
+     * @brief One rebalancing pass: split contended stripes, merge cold neighbours.
+     *
+     * A stripe is cold when it saw no contention and less than an eighth of its fair share of
+     * the acquisitions; two cold neighbours are merged into one stripe.
+     */
+    void rebalance() {
+        std::vector<Stripe*> live;
+        for (size_t slot = 0; slot < directory.size(); slot = live.back()->lastSlot) live.push_back(directory[slot].load());
+        std::vector<uint32_t> acquisitions(live.size()), contended(live.size());
+        for (size_t i = 0; i < live.size(); ++i) {
+            acquisitions[i] = live[i]->acquisitions.exchange(0, std::memory_order_relaxed);
+            contended[i] = live[i]->contended.exchange(0, std::memory_order_relaxed);
+        }
+        uint64_t total = 0;
+        for (uint32_t count : acquisitions) total += count;
+        auto cold = [&](size_t i) { return contended[i] == 0 && acquisitions[i] * 8 * live.size() < total; };
+        for (size_t i = 0; i < live.size(); ++i) {
+            if (acquisitions[i] >= config.minSamples && contended[i] > config.splitThreshold * acquisitions[i] &&
+                live[i]->lastSlot - live[i]->firstSlot >= 2) {
+                split(live[i]);
+            } else if (i + 1 < live.size() && cold(i) && cold(i + 1)) {
+                merge(live[i], live[i + 1]);
+                ++i;
+            }
+        }
+    }
+
+    /// Replaces a stripe by two stripes over the halves of its slots.
+    void split(Stripe* stripe) {
+        size_t middle = (stripe->firstSlot + stripe->lastSlot) / 2;
+        Stripe* low = newStripe(stripe->firstSlot, middle);
+        Stripe* high = newStripe(middle, stripe->lastSlot);
+        std::unique_lock<std::shared_mutex> lock(stripe->lock);
+        for (size_t slot = low->firstSlot; slot < low->lastSlot; ++slot) directory[slot].store(low, std::memory_order_release);
+        for (size_t slot = high->firstSlot; slot < high->lastSlot; ++slot) directory[slot].store(high, std::memory_order_release);
+        stripe->retired = true;
+        liveStripes.fetch_add(1, std::memory_order_relaxed);
+        splitCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /// Replaces two neighbouring stripes, locked in slot order, by one stripe over both ranges.
+    void merge(Stripe* low, Stripe* high) {
+        Stripe* merged = newStripe(low->firstSlot, high->lastSlot);
+        std::unique_lock<std::shared_mutex> lowLock(low->lock);
+        std::unique_lock<std::shared_mutex> highLock(high->lock);
+        for (size_t slot = merged->firstSlot; slot < merged->lastSlot; ++slot) directory[slot].store(merged, std::memory_order_release);
+        low->retired = true;
+        high->retired = true;
+        liveStripes.fetch_sub(1, std::memory_order_relaxed);
+        mergeCount.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    Config config;                                  /**< Size and resize policy. */
+    std::vector<SharedData> entries;                /**< The entries, indexed by key. */
+    std::vector<std::atomic<Stripe*>> directory;    /**< Stripe of every slot. */
+    std::vector<std::unique_ptr<Stripe>> stripes;   /**< Every stripe ever created, live or retired. */
+    std::atomic<size_t> liveStripes{0};             /**< Stripes the directory points to. */
+    std::atomic<uint64_t> splitCount{0};            /**< Splits performed. */
+    std::atomic<uint64_t> mergeCount{0};            /**< Merges performed. */
+    std::thread rebalancer;                         /**< Rebalancer thread of an adaptive store. */
+    std::mutex stopMutex;                           /**< Guards `stopping`. */
+    std::condition_variable stopSignal;             /**< Wakes the rebalancer for shutdown. */
+    bool stopping = false;                          /**< Set when the store is destroyed. */
+};
+
+/**
+ * @class StripingBenchmark
+ * @brief Compares static and adaptive lock striping on a Zipfian workload whose hot set moves.
+ *
+ * Readers and writers pick keys by Zipfian rank; the rank is offset by a shift that jumps to
+ * a different part of the key space at every phase, so the hot keys suddenly fall into other
+ * stripes. A sampler records throughput and the share of contended acquisitions per window.
+ * After each shift the settle time is the time until the contended share stays at or below
+ * the store's split threshold for three windows in a row.
+ */
+class StripingBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param numReaders Reader threads.
+     * @param numWriters Writer threads.
+     * @param keys Number of entries in the store.
+     * @param theta Zipfian skew.
+     * @param phases Number of hot-set positions.
+     * @param phaseTime Duration of each phase.
+     * @param splitThreshold Contended share of acquisitions above which a stripe splits.
+     * @param seed Seed from which every thread's key sequence is derived.
+     */
+    StripingBenchmark(int numReaders, int numWriters, size_t keys, double theta, int phases, std::chrono::seconds phaseTime,
+                      double splitThreshold, uint64_t seed)
+        : numReaders(numReaders), numWriters(numWriters), keys(keys), zipf(keys, theta), phases(std::max(1, phases)),
+          phaseTime(phaseTime), splitThreshold(splitThreshold), seed(seed) {}
+
+    /// Runs the workload on a static and an adaptive store and prints the per-phase reports.
+    void run() {
+        for (bool adaptive : {false, true}) {
+            AdaptiveShardedStore::Config config;
+            config.keys = keys;
+            config.adaptive = adaptive;
+            config.splitThreshold = splitThreshold;
+            std::vector<Window> windows = runStore(config);
+            report(adaptive ? "Adaptive striping" : "Static striping", config, windows);
+        }
+    }
+
+private:
+    /**
+     * @struct Window
+     * @brief Measurements of one sampling window.
+     */
+    struct Window {
+        double startSec = 0;      /**< Start of the window since the run began. */
+        int phase = 0;            /**< Phase the window belongs to. */
+        uint64_t operations = 0;  /**< Completed reads and updates. */
+        uint64_t contended = 0;   /**< Operations whose first lock try failed. */
+        size_t stripes = 0;       /**< Stripes in use at the end of the window. */
+    };
+
+    /**
+     * @struct Counters
+     * @brief Running totals of one thread, read by the sampler.
+     */
+    struct alignas(64) Counters {
+        std::atomic<uint64_t> operations{0}; /**< Completed operations. */
+        std::atomic<uint64_t> contended{0};  /**< Contended operations. */
+    };
+
+    /// Sampling window length.
+    static constexpr std::chrono::milliseconds kWindow{50};
+
+    /// Runs every phase on one store and returns the sampled windows.
+    std::vector<Window> runStore(const AdaptiveShardedStore::Config& config) {
+        AdaptiveShardedStore store(config);
+        std::vector<Counters> counters(numReaders + numWriters);
+        std::atomic<uint64_t> shift{0};
+        std::atomic<bool> stop{false};
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numReaders + numWriters; ++i) {
+            bool writer = i >= numReaders;
+            threads.emplace_back([&, i, writer] {
+                std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(i)}));
+                std::string payload(config.payloadSize, 'w');
+                while (!stop.load(std::memory_order_relaxed)) {
+                    uint64_t key = (zipf.next(engine) + shift.load(std::memory_order_relaxed)) % keys;
+                    bool contended = writer ? store.update(key, [&payload](SharedData& data) {
+                                                  data.counter++;
+                                                  data.text.assign(payload);
+                                              })
+                                            : store.read(key, [](const SharedData& data) { LockTester::readOperation(data); });
+                    counters[i].operations.fetch_add(1, std::memory_order_relaxed);
+                    if (contended) counters[i].contended.fetch_add(1, std::memory_order_relaxed);
+                }
+            });
+        }
+
+        std::vector<Window> windows;
+        auto start = std::chrono::steady_clock::now();
+        uint64_t lastOps = 0, lastContended = 0;
+        for (int phase = 0; phase < phases; ++phase) {
+            // Each phase moves the hot keys to a different region of the key space
+            shift.store(keys * phase / phases + keys / (2 * phases));
+            auto phaseEnd = start + phaseTime * (phase + 1);
+            while (std::chrono::steady_clock::now() < phaseEnd) {
+                Window window;
+                window.startSec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                window.phase = phase;
+                std::this_thread::sleep_for(kWindow);
+                uint64_t ops = 0, contended = 0;
+                for (const Counters& c : counters) {
+                    ops += c.operations.load(std::memory_order_relaxed);
+                    contended += c.contended.load(std::memory_order_relaxed);
+                }
+                window.operations = ops - lastOps;
+                window.contended = contended - lastContended;
+                window.stripes = store.stripeCount();
+                lastOps = ops;
+                lastContended = contended;
+                windows.push_back(window);
+            }
+        }
+        stop = true;
+        for (auto& t : threads) t.join();
+        std::cout << (config.adaptive ? "Adaptive" : "Static") << " store: " << store.splits() << " splits, "
+                  << store.merges() << " merges, " << store.stripeCount() << " stripes at the end" << std::endl;
+        return windows;
+    }
+
+    /// Prints one row per phase: throughput, peak and settled contention, settle time and stripes.
+    void report(const std::string& title, const AdaptiveShardedStore::Config& config, const std::vector<Window>& windows) const {
+        std::cout << "\n" << title << " (" << numReaders << " readers, " << numWriters << " writers, " << keys
+                  << " keys, hot set moves every " << phaseTime.count() << " s):" << std::endl;
+        TextTable table({"Phase", "Throughput", "Peak contention", "Contention at end", "Settle time", "Stripes at end"});
+        auto share = [](uint64_t part, uint64_t whole) {
+            std::ostringstream out;
+            out << std::fixed << std::setprecision(2) << (whole ? 100.0 * part / whole : 0.0) << "%";
+            return out.str();
+        };
+        for (int phase = 0; phase < phases; ++phase) {
+            std::vector<const Window*> phaseWindows;
+            for (const Window& window : windows)
+                if (window.phase == phase) phaseWindows.push_back(&window);
+            if (phaseWindows.empty()) continue;
+            uint64_t ops = 0;
+            double peak = 0;
+            std::string peakText = "0.00%";
+            for (const Window* window : phaseWindows) {
+                ops += window->operations;
+                double rate = window->operations ? static_cast<double>(window->contended) / window->operations : 0;
+                if (rate >= peak) {
+                    peak = rate;
+                    peakText = share(window->contended, window->operations);
+                }
+            }
+            // Settled once three consecutive windows stay at or below the split threshold
+            std::string settle = "not settled";
+            for (size_t i = 0; i + 2 < phaseWindows.size(); ++i) {
+                bool calm = true;
+                for (size_t j = i; j < i + 3; ++j)
+                    calm = calm && phaseWindows[j]->contended <= config.splitThreshold * phaseWindows[j]->operations;
+                if (calm) {
+                    settle = LatencyHistogram::format(static_cast<uint64_t>((phaseWindows[i]->startSec - phaseWindows.front()->startSec) * 1e9));
+                    break;
+                }
+            }
+            double seconds = phaseWindows.size() * kWindow.count() / 1000.0;
+            std::ostringstream throughput;
+            throughput << std::fixed << std::setprecision(0) << ops / seconds << " ops/s";
+            table.addRow({std::to_string(phase + 1), throughput.str(), peakText,
+                          share(phaseWindows.back()->contended, phaseWindows.back()->operations), settle,
+                          std::to_string(phaseWindows.back()->stripes)});
+        }
+        table.print();
+    }
+
+    int numReaders;                   /**< Reader threads. */
+    int numWriters;                   /**< Writer threads. */
+    size_t keys;                      /**< Entries in the store. */
+    ZipfianGenerator zipf;            /**< Popularity of the keys. */
+    int phases;                       /**< Number of hot-set positions. */
+    std::chrono::seconds phaseTime;   /**< Duration of each phase. */
+    double splitThreshold;            /**< Contended share above which a stripe splits. */
+    uint64_t seed;                    /**< Seed of the key sequences. */
+};
+
+/**
+ * @class MultiGetBenchmark
+ * @brief Compares batched lookups with independent reads on the sharded store.
+ *
+ * Every request reads K keys drawn from a Zipfian distribution over the store, as a request
+ * handler reading related objects would. With independent reads each key takes and releases
+ * its stripe's shared lock on its own, the pattern of `LockTester::readerSharedLock()`; a
+ * multi-get hands all K keys to `AdaptiveShardedStore::readMany()`. Writers update random
+ * keys meanwhile. The stripes are static so both modes see the same lock layout.
+ */
+class MultiGetBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param numReaders Reader threads issuing requests.
+     * @param numWriters Writer threads.
+     * @param keys Entries in the store.
+     * @param theta Zipfian skew of the requested keys.
+     * @param batchSizes Keys per request to compare.
+     * @param requests Requests per reader and batch size.
+     * @param seed Seed of the key sequences.
+     */
+    MultiGetBenchmark(int numReaders, int numWriters, size_t keys, double theta, std::vector<int> batchSizes, int requests, uint64_t seed)
+        : numReaders(std::max(1, numReaders)), numWriters(numWriters), keys(keys), zipf(keys, theta),
+          batchSizes(std::move(batchSizes)), requests(std::max(1, requests)), seed(seed) {}
+
+    /// Runs both modes for every batch size and prints the comparison.
+    void run() {
+        AdaptiveShardedStore::Config config;
+        config.keys = keys;
+        config.adaptive = false;
+        AdaptiveShardedStore store(config);
+        TextTable table({"Keys", "Mode", "Requests/s", "Locks per request", "p50", "p99", "Max", "Speedup"});
+        for (int batch : batchSizes) {
+            Result independent = runMode(store, batch, false);
+            Result batched = runMode(store, batch, true);
+            for (const Result* result : {&independent, &batched}) {
+                std::ostringstream rate, locks, speedup;
+                rate << std::fixed << std::setprecision(0) << result->rate() << " req/s";
+                locks << std::fixed << std::setprecision(1) << static_cast<double>(result->locks) / std::max<uint64_t>(1, result->latency.count());
+                speedup << std::fixed << std::setprecision(2) << result->rate() / independent.rate() << "x";
+                table.addRow({std::to_string(batch), result == &batched ? "Multi-get" : "Independent reads", rate.str(), locks.str(),
+                              LatencyHistogram::format(result->latency.percentile(0.5)),
+                              LatencyHistogram::format(result->latency.percentile(0.99)),
+                              LatencyHistogram::format(result->latency.max()), speedup.str()});
+            }
+        }
+        std::cout << "\nMulti-get (" << numReaders << " readers, " << numWriters << " writers, " << keys << " keys, "
+                  << store.stripeCount() << " stripes, " << requests << " requests per reader):" << std::endl;
+        table.print();
+    }
+
+private:
+    /**
+     * @struct Result
+     * @brief Measurements of one mode and batch size.
+     */
+    struct Result {
+        uint64_t elapsedNs = 0;    /**< Until the last reader finished. */
+        uint64_t locks = 0;        /**< Stripe locks taken by the readers. */
+        LatencyHistogram latency;  /**< Duration of each request. */
+
+        /// @return Completed requests per second.
+        double rate() const { return latency.count() * 1e9 / std::max<uint64_t>(1, elapsedNs); }
+    };
+
+    /// Runs the readers of one mode and batch size while the writers update.
+    Result runMode(AdaptiveShardedStore& store, int batch, bool batched) {
+        std::vector<Result> results(numReaders);
+        std::atomic<int> running{numReaders};
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numReaders; ++i) {
+            threads.emplace_back([&, i] {
+                // Both modes of a batch size request the same keys
+                std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(batch), static_cast<uint64_t>(i)}));
+                std::vector<uint64_t> request(batch);
+                Result& result = results[i];
+                auto read = [](size_t, const SharedData& data) { LockTester::readOperation(data); };
+                for (int n = 0; n < requests; ++n) {
+                    for (uint64_t& key : request) key = zipf.next(engine) % keys;
+                    auto begin = std::chrono::steady_clock::now();
+                    if (batched) {
+                        result.locks += store.readMany(request, read);
+                    } else {
+                        for (size_t k = 0; k < request.size(); ++k) store.read(request[k], [&](const SharedData& data) { read(k, data); });
+                        result.locks += request.size();
+                    }
+                    result.latency.record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()));
+                }
+                running.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        for (int i = 0; i < numWriters; ++i) {
+            threads.emplace_back([&, i] {
+                std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {~0ull, static_cast<uint64_t>(i)}));
+                std::string payload(store.payloadSize(), 'w');
+                while (running.load(std::memory_order_acquire) > 0) {
+                    store.update(zipf.next(engine) % keys, [&payload](SharedData& data) {
+                        data.counter++;
+                        data.text.assign(payload);
+                    });
+                    std::this_thread::yield();
+                }
+            });
+        }
+        for (int i = 0; i < numReaders; ++i) threads[i].join();
+        Result total;
+        total.elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        for (size_t i = numReaders; i < threads.size(); ++i) threads[i].join();
+        for (const Result& result : results) {
+            total.locks += result.locks;
+            total.latency.merge(result.latency);
+        }
+        return total;
+    }
+
+    int numReaders;               /**< Reader threads. */
+    int numWriters;               /**< Writer threads. */
+    size_t keys;                  /**< Entries in the store. */
+    ZipfianGenerator zipf;        /**< Popularity of the keys. */
+    std::vector<int> batchSizes;  /**< Keys per request. */
+    int requests;                 /**< Requests per reader and batch size. */
+    uint64_t seed;                /**< Seed of the key sequences. */
+};
+
+/**
+ * @class EventLoopBenchmark
+ * @brief Event-loop threads that mix simulated I/O completions with SharedData reads.
+ *
+ * Every loop owns an io_uring and keeps a fixed number of requests in flight. A request waits
+ * for a simulated I/O, a ring timeout of random length, then reads SharedData under a shared
+ * hold and starts over, while writer threads update SharedData. The modes differ only in what
+ * a loop does when the read lock is taken:
+ *  - Blocking wait: sleeps in the futex system call, stalling every other request of the loop.
+ *  - io_uring futex wait: submits `IORING_OP_FUTEX_WAIT` and retries on its completion.
+ *  - Eventfd park: parks the loop's eventfd on the lock and retries once it is signalled; the
+ *    fallback on kernels without io_uring futex operations.
+ *  - Coroutine handoff: queues a continuation that the unlocking thread grants the lock to and
+ *    posts back to the loop through its eventfd.
+ * I/O lag is how late a loop handled an I/O completion after it was due, which is what a loop
+ * that blocks pays on all its other requests.
+ */
+class EventLoopBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param numLoops Event-loop threads.
+     * @param numWriters Writer threads.
+     * @param inFlight Requests each loop keeps in flight.
+     * @param ioTime Mean duration of a simulated I/O.
+     * @param modeTime Run time of each mode.
+     * @param seed Seed from which the I/O durations of every loop are derived.
+     */
+    EventLoopBenchmark(int numLoops, int numWriters, int inFlight, std::chrono::microseconds ioTime,
+                       std::chrono::seconds modeTime, uint64_t seed)
+        : numLoops(std::max(1, numLoops)), numWriters(numWriters), inFlight(std::max(1, inFlight)), ioTime(ioTime),
+          modeTime(modeTime), seed(seed) {}
+
+    /**
+     * @brief Runs every mode and prints the comparison.
+     * @throws std::runtime_error If io_uring is unavailable.
+     */
+    void run() {
+        bool futexOps = IoUring(4).supports(IoUring::kOpFutexWait);
+        if (!futexOps)
+            std::cout << "This kernel has no io_uring futex operations; eventfd parking is the fallback" << std::endl;
+        TextTable table({"Mode", "Requests/s", "Contended", "Lock wait p50", "Lock wait p99", "I/O lag p50", "I/O lag p99"});
+        for (Mode mode : {Mode::Blocking, Mode::RingFutex, Mode::EventFd, Mode::Handoff}) {
+            if (mode == Mode::RingFutex && !futexOps) continue;
+            Result result = runMode(mode);
+            std::ostringstream rate, contended;
+            rate << std::fixed << std::setprecision(0) << result.requests / static_cast<double>(modeTime.count()) << " req/s";
+            contended << std::fixed << std::setprecision(2)
+                      << (result.requests ? 100.0 * result.contended / result.requests : 0.0) << "%";
+            table.addRow({modeName(mode), rate.str(), contended.str(), LatencyHistogram::format(result.lockWait.percentile(0.5)),
+                          LatencyHistogram::format(result.lockWait.percentile(0.99)),
+                          LatencyHistogram::format(result.ioLag.percentile(0.5)),
+                          LatencyHistogram::format(result.ioLag.percentile(0.99))});
+        }
+        std::cout << "\nEvent loops (" << numLoops << " loops x " << inFlight << " requests, " << numWriters << " writers, "
+                  << ioTime.count() << " us simulated I/O):" << std::endl;
+        table.print();
+    }
+
+private:
+    /// What a loop does when the read lock is taken.
+    enum class Mode { Blocking, RingFutex, EventFd, Handoff };
+
+    /// Kinds of ring completions; the low 32 bits of the user data hold the request index.
+    enum Event : uint64_t { kIo = 1, kLockWait = 2, kWake = 3 };
+
+    /// Pause of a writer between updates.
+    static constexpr std::chrono::microseconds kWriterPause{200};
+
+    /**
+     * @struct Request
+     * @brief One request of a loop.
+     */
+    struct Request {
+        __kernel_timespec delay{}; /**< Duration of the pending simulated I/O; read by the kernel. */
+        int64_t dueNs = 0;         /**< When the simulated I/O completes. */
+        int64_t readyNs = 0;       /**< When the request started waiting for the lock. */
+    };
+
+    /**
+     * @struct Result
+     * @brief Measurements of one loop, or of all loops of a mode.
+     */
+    struct Result {
+        uint64_t requests = 0;      /**< Requests that read SharedData. */
+        uint64_t contended = 0;     /**< Requests whose first lock try failed. */
+        LatencyHistogram lockWait;  /**< From the I/O completion to holding the lock. */
+        LatencyHistogram ioLag;     /**< From the due time of an I/O to its handling. */
+    };
+
+    /**
+     * @struct Shared
+     * @brief State shared by the loops and writers of one mode.
+     */
+    struct Shared {
+        SharedData data;                /**< The data requests read. */
+        AsyncSharedLock lock;           /**< Lock of every mode but handoff. */
+        HandoffSharedLock handoff;      /**< Lock of the handoff mode. */
+        std::atomic<bool> stop{false};  /**< Ends the mode. */
+    };
+
+    /**
+     * @struct Loop
+     * @brief The ring, requests and wake-up channel of one event-loop thread.
+     */
+    struct Loop {
+        explicit Loop(int inFlight) : ring(static_cast<unsigned>(inFlight) + 2), requests(inFlight), eventFd(eventfd(0, EFD_CLOEXEC)) {
+            if (eventFd < 0) throw std::runtime_error(std::string("eventfd failed: ") + std::strerror(errno));
+        }
+        ~Loop() { close(eventFd); }
+
+        IoUring ring;                    /**< Carries the I/O, futex waits and eventfd reads. */
+        std::vector<Request> requests;   /**< Requests in flight. */
+        int eventFd;                     /**< Signalled by parked unlocks and handoff grants. */
+        uint64_t eventValue = 0;         /**< Buffer of the pending eventfd read. */
+        bool wakeArmed = false;          /**< Whether an eventfd read is pending. */
+        bool parked = false;             /**< Whether the eventfd is parked on the lock. */
+        int waiting = 0;                 /**< Requests waiting for the lock. */
+        unsigned outstanding = 0;        /**< Ring operations not completed yet. */
+        std::vector<int> parkedRequests; /**< Requests to retry once the parked eventfd is signalled. */
+        std::mutex inboxMutex;           /**< Guards `inbox`. */
+        std::vector<int> inbox;          /**< Requests granted the lock by a handoff. */
+        Result result;                   /**< Measurements of the loop. */
+    };
+
+    /// @return The name of `mode` in the report.
+    static const char* modeName(Mode mode) {
+        switch (mode) {
+        case Mode::Blocking: return "Blocking wait";
+        case Mode::RingFutex: return "io_uring futex wait";
+        case Mode::EventFd: return "Eventfd park";
+        case Mode::Handoff: return "Coroutine handoff";
+        }
+        return "";
+    }
+
+    /// @return Nanoseconds on the steady clock.
+    static int64_t steadyNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /// @return The reserved submission entry; the queue is sized so that it never runs full.
+    static io_uring_sqe* reserve(Loop& loop, Event event, int request) {
+        io_uring_sqe* sqe = loop.ring.next(static_cast<uint64_t>(event) << 32 | static_cast<uint32_t>(request));
+        if (!sqe) throw std::runtime_error("io_uring submission queue full");
+        ++loop.outstanding;
+        return sqe;
+    }
+
+    /// Runs the loops and writers of one mode and returns the merged measurements.
+    Result runMode(Mode mode) {
+        Shared shared;
+        shared.data.text = RandomStringGenerator::generate(LockTester::kPayloadSize);
+        std::vector<std::unique_ptr<Loop>> loops;
+        for (int i = 0; i < numLoops; ++i) loops.push_back(std::make_unique<Loop>(inFlight));
+
+        std::vector<std::thread> threads;
+        for (int i = 0; i < numLoops; ++i) threads.emplace_back([&, i] { runLoop(*loops[i], mode, i, shared); });
+        for (int i = 0; i < numWriters; ++i) {
+            threads.emplace_back([&] {
+                while (!shared.stop.load(std::memory_order_relaxed)) {
+                    if (mode == Mode::Handoff) {
+                        shared.handoff.lock();
+                        LockTester::writeOperation(shared.data);
+                        shared.handoff.unlock();
+                    } else {
+                        shared.lock.lock();
+                        LockTester::writeOperation(shared.data);
+                        shared.lock.unlock();
+                    }
+                    std::this_thread::sleep_for(kWriterPause);
+                }
+            });
+        }
+        std::this_thread::sleep_for(modeTime);
+        shared.stop = true;
+        for (auto& t : threads) t.join();
+
+        Result total;
+        for (const auto& loop : loops) {
+            total.requests += loop->result.requests;
+            total.contended += loop->result.contended;
+            total.lockWait.merge(loop->result.lockWait);
+            total.ioLag.merge(loop->result.ioLag);
+        }
+        return total;
+    }
+
+    /**
+     * @brief The event loop: handles completions until the mode stops and nothing is in flight.
+     * @param loop The loop's state.
+     * @param mode How contended reads wait.
+     * @param index Index of the loop, for its seed.
+     * @param shared State shared with the writers.
+     */
+    void runLoop(Loop& loop, Mode mode, int index, Shared& shared) {
+        std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(index)}));
+        int64_t meanNs = std::chrono::duration_cast<std::chrono::nanoseconds>(ioTime).count();
+        std::uniform_int_distribution<int64_t> ioDelay(meanNs / 2, meanNs * 3 / 2);
+        bool stopping = false;
+
+        auto startIo = [&](int i) {
+            Request& request = loop.requests[i];
+            int64_t delay = ioDelay(engine);
+            request.delay.tv_sec = delay / 1000000000;
+            request.delay.tv_nsec = delay % 1000000000;
+            request.dueNs = steadyNanos() + delay;
+            io_uring_sqe* sqe = reserve(loop, kIo, i);
+            sqe->opcode = IORING_OP_TIMEOUT;
+            sqe->addr = reinterpret_cast<uintptr_t>(&request.delay);
+            sqe->len = 1;
+        };
+        auto armWake = [&] {
+            if (loop.wakeArmed) return;
+            io_uring_sqe* sqe = reserve(loop, kWake, 0);
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = loop.eventFd;
+            sqe->addr = reinterpret_cast<uintptr_t>(&loop.eventValue);
+            sqe->len = sizeof(loop.eventValue);
+            loop.wakeArmed = true;
+        };
+        // Runs with the shared hold taken: reads, releases and starts the next I/O
+        auto serve = [&](int i) {
+            loop.result.lockWait.record(static_cast<uint64_t>(std::max<int64_t>(0, steadyNanos() - loop.requests[i].readyNs)));
+            LockTester::readOperation(shared.data);
+            if (mode == Mode::Handoff) shared.handoff.unlockShared();
+            else shared.lock.unlockShared();
+            ++loop.result.requests;
+            if (!stopping) startIo(i);
+        };
+        // Takes the shared hold for request i or arranges for a completion that retries or grants it
+        auto acquire = [&](int i, bool retry) {
+            switch (mode) {
+            case Mode::Blocking:
+                if (!shared.lock.tryLockShared()) {
+                    ++loop.result.contended;
+                    shared.lock.lockShared();
+                }
+                serve(i);
+                return;
+            case Mode::RingFutex:
+                for (;;) {
+                    if (shared.lock.tryLockShared()) {
+                        if (retry) --loop.waiting;
+                        serve(i);
+                        return;
+                    }
+                    uint32_t expected;
+                    if (shared.lock.prepareWait(expected, false)) {
+                        if (!retry) {
+                            ++loop.result.contended;
+                            ++loop.waiting;
+                        }
+                        IoUring::prepareFutexWait(reserve(loop, kLockWait, i), shared.lock.futexWord(), expected);
+                        return;
+                    }
+                }
+            case Mode::EventFd:
+                for (;;) {
+                    if (shared.lock.tryLockShared()) {
+                        if (retry) --loop.waiting;
+                        serve(i);
+                        return;
+                    }
+                    if (loop.parked || shared.lock.park(loop.eventFd)) {
+                        if (!retry) {
+                            ++loop.result.contended;
+                            ++loop.waiting;
+                        }
+                        loop.parked = true;
+                        loop.parkedRequests.push_back(i);
+                        armWake();
+                        return;
+                    }
+                }
+            case Mode::Handoff:
+                if (shared.handoff.lockShared([&loop, i] {
+                        std::lock_guard<std::mutex> guard(loop.inboxMutex);
+                        loop.inbox.push_back(i);
+                        uint64_t one = 1;
+                        if (write(loop.eventFd, &one, sizeof(one)) < 0) return;
+                    })) {
+                    serve(i);
+                    return;
+                }
+                ++loop.result.contended;
+                ++loop.waiting;
+                armWake();
+                return;
+            }
+        };
+        auto handle = [&](uint64_t userData, int32_t) {
+            --loop.outstanding;
+            int i = static_cast<int>(userData & 0xffffffffu);
+            switch (static_cast<Event>(userData >> 32)) {
+            case kIo: {
+                int64_t now = steadyNanos();
+                loop.result.ioLag.record(static_cast<uint64_t>(std::max<int64_t>(0, now - loop.requests[i].dueNs)));
+                loop.requests[i].readyNs = now;
+                acquire(i, false);
+                break;
+            }
+            case kLockWait:
+                acquire(i, true);
+                break;
+            case kWake: {
+                loop.wakeArmed = false;
+                if (mode == Mode::EventFd) {
+                    loop.parked = false;
+                    std::vector<int> retries;
+                    retries.swap(loop.parkedRequests);
+                    for (int request : retries) acquire(request, true);
+                } else {
+                    std::vector<int> granted;
+                    {
+                        std::lock_guard<std::mutex> guard(loop.inboxMutex);
+                        granted.swap(loop.inbox);
+                    }
+                    loop.waiting -= static_cast<int>(granted.size());
+                    for (int request : granted) serve(request);
+                    if (loop.waiting > 0) armWake();
+                }
+                break;
+            }
+            }
+        };
+
+        for (int i = 0; i < inFlight; ++i) startIo(i);
+        for (;;) {
+            stopping = stopping || shared.stop.load(std::memory_order_relaxed);
+            if (stopping && loop.outstanding == 0) break;
+            // A pending eventfd read with nobody waiting would never complete on its own
+            if (stopping && loop.waiting == 0 && loop.wakeArmed && loop.outstanding == 1) {
+                uint64_t one = 1;
+                if (write(loop.eventFd, &one, sizeof(one)) < 0) break;
+            }
+            loop.ring.submit(1);
+            loop.ring.reap(handle);
+        }
+    }
+
+    int numLoops;                       /**< Event-loop threads. */
+    int numWriters;                     /**< Writer threads. */
+    int inFlight;                       /**< Requests per loop. */
+    std::chrono::microseconds ioTime;   /**< Mean simulated I/O duration. */
+    std::chrono::seconds modeTime;      /**< Run time of each mode. */
+    uint64_t seed;                      /**< Seed of the I/O durations. */
+};
+
+/**
+ * @class AnyReplicaBenchmark
+ * @brief Readers served by any free replica of SharedData versus readers queueing on their own.
+ *
+ * Writers update every replica in turn and hold each exclusively for one update, so at any
+ * moment some replicas are busy while others are free. A home reader always reads its own
+ * replica and sleeps while a writer holds it. An any-replica reader tries its own replica and
+ * then the others, and only if all of them are taken sleeps on all lock words at once with
+ * `WaitAny`, through `futex_waitv` or through its polling fallback.
+ */
+class AnyReplicaBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param numReaders Reader threads.
+     * @param numWriters Writer threads.
+     * @param replicas Copies of SharedData.
+     * @param reads Reads per reader.
+     * @param seed Seed of the writers' payloads.
+     */
+    AnyReplicaBenchmark(int numReaders, int numWriters, int replicas, int reads, uint64_t seed)
+        : numReaders(std::max(1, numReaders)), numWriters(numWriters),
+          replicas(std::min(std::max(1, replicas), FUTEX_WAITV_MAX)), reads(std::max(1, reads)), seed(seed) {}
+
+    /// Runs every mode and prints the comparison.
+    void run() {
+        if (!Futex::hasWaitv()) std::cout << "This kernel has no futex_waitv; only the polling fallback is measured" << std::endl;
+        TextTable table({"Mode", "Elapsed", "Reads/s", "Not home", "Waits on all", "Read p50", "Read p99", "Read max"});
+        for (Mode mode : {Mode::Home, Mode::AnyWaitv, Mode::AnyPoll}) {
+            if (mode == Mode::AnyWaitv && !Futex::hasWaitv()) continue;
+            Result result = runMode(mode);
+            uint64_t total = result.latency.count();
+            std::ostringstream rate, away;
+            rate << std::fixed << std::setprecision(0) << total * 1e9 / std::max<uint64_t>(1, result.elapsedNs) << " reads/s";
+            away << std::fixed << std::setprecision(2) << (total ? 100.0 * result.notHome / total : 0.0) << "%";
+            table.addRow({modeName(mode), LatencyHistogram::format(result.elapsedNs), rate.str(), away.str(),
+                          std::to_string(result.waits), LatencyHistogram::format(result.latency.percentile(0.5)),
+                          LatencyHistogram::format(result.latency.percentile(0.99)), LatencyHistogram::format(result.latency.max())});
+        }
+        std::cout << "\nReplicated reads (" << numReaders << " readers, " << numWriters << " writers, " << replicas
+                  << " replicas, " << reads << " reads per reader):" << std::endl;
+        table.print();
+    }
+
+private:
+    /// Which replica a reader reads.
+    enum class Mode { Home, AnyWaitv, AnyPoll };
+
+    /// Pause of a writer between rounds over all replicas.
+    static constexpr std::chrono::microseconds kWriterPause{200};
+
+    /**
+     * @struct Replica
+     * @brief One copy of the data with its lock.
+     */
+    struct Replica {
+        AsyncSharedLock lock; /**< Shared for reads, exclusive for updates. */
+        SharedData data;      /**< The copy. */
+    };
+
+    /**
+     * @struct Result
+     * @brief Measurements of one mode.
+     */
+    struct Result {
+        uint64_t elapsedNs = 0;    /**< Until the last reader finished. */
+        uint64_t notHome = 0;      /**< Reads served by another replica than the reader's own. */
+        uint64_t waits = 0;        /**< Sleeps on all replicas at once. */
+        LatencyHistogram latency;  /**< Time to get a replica and read it. */
+    };
+
+    /// @return The name of `mode` in the report.
+    static const char* modeName(Mode mode) {
+        switch (mode) {
+        case Mode::Home: return "Home replica";
+        case Mode::AnyWaitv: return "Any replica (futex_waitv)";
+        case Mode::AnyPoll: return "Any replica (polling)";
+        }
+        return "";
+    }
+
+    /**
+     * @brief Takes a shared hold on some replica, preferring `home`.
+     * @param set The replicas.
+     * @param home The reader's own replica.
+     * @param waiter Reused wait set of the reader.
+     * @param waits Incremented for every sleep on all replicas.
+     * @return Index of the replica now held.
+     */
+    static int acquireAny(std::vector<Replica>& set, int home, WaitAny& waiter, uint64_t& waits) {
+        int count = static_cast<int>(set.size());
+        for (;;) {
+            for (int k = 0; k < count; ++k) {
+                int r = (home + k) % count;
+                if (set[r].lock.tryLockShared()) return r;
+            }
+            // Every replica is being updated: sleep until any of them is released
+            waiter.clear();
+            bool armed = true;
+            for (int r = 0; r < count && armed; ++r) armed = waiter.add(set[r].lock, false);
+            if (!armed) continue;
+            ++waits;
+            waiter.wait();
+        }
+    }
+
+    /// Runs the readers and writers of one mode.
+    Result runMode(Mode mode) {
+        std::vector<Replica> set(replicas);
+        for (Replica& replica : set) replica.data.text = RandomStringGenerator::generate(LockTester::kPayloadSize);
+        std::vector<Result> results(numReaders);
+        std::atomic<int> running{numReaders};
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < numReaders; ++i) {
+            threads.emplace_back([&, i] {
+                Result& result = results[i];
+                int home = i % replicas;
+                WaitAny waiter(mode == Mode::AnyPoll);
+                for (int n = 0; n < reads; ++n) {
+                    auto begin = std::chrono::steady_clock::now();
+                    int r = home;
+                    if (mode == Mode::Home) set[home].lock.lockShared();
+                    else r = acquireAny(set, home, waiter, result.waits);
+                    LockTester::readOperation(set[r].data);
+                    set[r].lock.unlockShared();
+                    result.latency.record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - begin).count()));
+                    if (r != home) ++result.notHome;
+                }
+                running.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        for (int i = 0; i < numWriters; ++i) {
+            threads.emplace_back([&, i] {
+                RandomStringGenerator::seed(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(mode), static_cast<uint64_t>(i)}));
+                while (running.load(std::memory_order_acquire) > 0) {
+                    for (Replica& replica : set) {
+                        replica.lock.lock();
+                        LockTester::writeOperation(replica.data);
+                        replica.lock.unlock();
+                    }
+                    std::this_thread::sleep_for(kWriterPause);
+                }
+            });
+        }
+        for (int i = 0; i < numReaders; ++i) threads[i].join();
+        Result total;
+        total.elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        for (size_t i = numReaders; i < threads.size(); ++i) threads[i].join();
+        for (const Result& result : results) {
+            total.notHome += result.notHome;
+            total.waits += result.waits;
+            total.latency.merge(result.latency);
+        }
+        return total;
+    }
+
+    int numReaders;  /**< Reader threads. */
+    int numWriters;  /**< Writer threads. */
+    int replicas;    /**< Copies of SharedData. */
+    int reads;       /**< Reads per reader. */
+    uint64_t seed;   /**< Seed of the writers' payloads. */
+};
+
+/**
+ * @class ThreadPerCoreBenchmark
+ * @brief Compares a shared-nothing, thread-per-core design with lock-based sharing at equal core counts.
+ *
+ * The keys are split into one partition per core. In the shared-nothing mode each core's
+ * thread alone touches its partition: it runs operations on its own keys inline and sends
+ * operations on other keys as messages through a single-producer single-consumer queue per
+ * pair of cores, then serves the requests other cores sent it, so no lock is taken anywhere.
+ * Like an asynchronous server it keeps up to `inFlight` operations outstanding. The lock-based
+ * modes run the same operation stream with one thread per core, one operation at a time,
+ * under a single `std::shared_mutex`, a single `std::mutex`, or one `std::shared_mutex` per
+ * partition. Every mode uses `LockTester::readOperation()` and `LockTester::writeOperation()`
+ * and pins thread `i` to the `i`-th allowed CPU. Latency is from issuing an operation to its
+ * completion, so it includes the queueing of the shared-nothing mode.
+ */
+class ThreadPerCoreBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param shards Cores, i.e. partitions and threads; 0 uses every allowed CPU, at least 2.
+     * @param operations Operations issued per core.
+     * @param writePercent Share of updates among the operations, in percent.
+     * @param inFlight Operations each core keeps outstanding in the shared-nothing mode.
+     * @param seed Seed of the key sequences and payloads.
+     */
+    ThreadPerCoreBenchmark(int shards, int operations, double writePercent, int inFlight, uint64_t seed)
+        : shards(shards > 0 ? shards : std::max<int>(2, static_cast<int>(SimulationCosts::allowedCpus().size()))),
+          operations(std::max(1, operations)), writeShare(std::min(100.0, std::max(0.0, writePercent)) / 100.0),
+          inFlight(std::max(1, inFlight)), seed(seed) {}
+
+    /// @return The number of cores, i.e. threads of every mode.
+    int cores() const { return shards; }
+
+    /// Runs every mode and prints the comparison against the best lock-based mode.
+    void run() {
+        std::vector<std::pair<std::string, Result>> results;
+        for (Mode mode : {Mode::SharedMutex, Mode::StandardMutex, Mode::StripedSharedMutex, Mode::SharedNothing})
+            results.emplace_back(modeName(mode), mode == Mode::SharedNothing ? runSharedNothing() : runLocked(mode));
+        const Result* best = nullptr;
+        for (const auto& entry : results)
+            if (entry.first != modeName(Mode::SharedNothing) && (!best || entry.second.rate() > best->rate())) best = &entry.second;
+
+        TextTable table({"Mode", "Throughput", "vs best lock", "Remote", "p50", "p99", "p99.9", "Max"});
+        for (const auto& entry : results) {
+            const Result& result = entry.second;
+            std::ostringstream rate, ratio, remote;
+            rate << std::fixed << std::setprecision(0) << result.rate() << " ops/s";
+            ratio << std::fixed << std::setprecision(2) << result.rate() / best->rate() << "x";
+            remote << std::fixed << std::setprecision(1) << 100.0 * result.remote / std::max<uint64_t>(1, result.latency.count()) << "%";
+            table.addRow({entry.first, rate.str(), ratio.str(), entry.first == modeName(Mode::SharedNothing) ? remote.str() : "-",
+                          LatencyHistogram::format(result.latency.percentile(0.5)),
+                          LatencyHistogram::format(result.latency.percentile(0.99)),
+                          LatencyHistogram::format(result.latency.percentile(0.999)),
+                          LatencyHistogram::format(result.latency.max())});
+        }
+        std::cout << "\nThread per core (" << shards << " cores, " << shards * kKeysPerShard << " keys, " << operations
+                  << " operations per core, " << std::setprecision(3) << writeShare * 100 << "% updates, " << inFlight
+                  << " in flight):" << std::endl;
+        table.print();
+    }
+
+private:
+    /// How the partitions are protected.
+    enum class Mode { SharedMutex, StandardMutex, StripedSharedMutex, SharedNothing };
+
+    /// Keys in each core's partition.
+    static constexpr int kKeysPerShard = 64;
+
+    /**
+     * @struct Result
+     * @brief Measurements of one mode.
+     */
+    struct Result {
+        uint64_t elapsedNs = 0;    /**< Until every core completed its operations. */
+        uint64_t remote = 0;       /**< Operations sent to another core. */
+        LatencyHistogram latency;  /**< Issue to completion of each operation. */
+
+        /// @return Completed operations per second.
+        double rate() const { return latency.count() * 1e9 / std::max<uint64_t>(1, elapsedNs); }
+    };
+
+    /**
+     * @struct Message
+     * @brief A request to the owner of a key, sent back unchanged as its completion.
+     */
+    struct Message {
+        uint32_t key = 0;       /**< Global key. */
+        bool update = false;    /**< Whether the operation writes. */
+        uint64_t issuedNs = 0;  /**< Issue time on the requester's clock. */
+    };
+
+    /**
+     * @struct Operation
+     * @brief One step of a core's operation stream.
+     */
+    struct Operation {
+        uint32_t key;  /**< Global key. */
+        bool update;   /**< Whether it writes. */
+    };
+
+    /// @return The name of `mode` in the report.
+    static const char* modeName(Mode mode) {
+        switch (mode) {
+        case Mode::SharedMutex: return "Shared Mutex";
+        case Mode::StandardMutex: return "Standard Mutex";
+        case Mode::StripedSharedMutex: return "Shared Mutex per partition";
+        case Mode::SharedNothing: return "Shared nothing";
+        }
+        return "";
+    }
+
+    /// @return The nanoseconds of the steady clock.
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /// Pins the calling thread to the `index`-th allowed CPU, wrapping around.
+    static void pin(int index) {
+        static const std::vector<int> cpus = SimulationCosts::allowedCpus();
+        if (cpus.empty()) return;
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpus[index % cpus.size()], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    /// @return The operation stream of core `shard`; the same in every mode.
+    std::vector<Operation> stream(int shard) const {
+        std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(shard)}));
+        std::uniform_int_distribution<uint32_t> key(0, static_cast<uint32_t>(shards * kKeysPerShard - 1));
+        std::bernoulli_distribution update(writeShare);
+        std::vector<Operation> ops(operations);
+        for (Operation& op : ops) op = {key(engine), update(engine)};
+        return ops;
+    }
+
+    /// @return One entry per key with a full payload.
+    std::vector<SharedData> makeEntries(size_t count) const {
+        std::vector<SharedData> entries(count);
+        for (SharedData& entry : entries) entry.text = RandomStringGenerator::generate(LockTester::kPayloadSize);
+        return entries;
+    }
+
+    /// Runs one thread per core on shared entries under the locks of `mode`.
+    Result runLocked(Mode mode) {
+        std::vector<SharedData> entries = makeEntries(static_cast<size_t>(shards) * kKeysPerShard);
+        std::shared_mutex global;
+        std::mutex standard;
+        std::vector<std::shared_mutex> partitions(shards);
+        std::vector<Result> results(shards);
+        std::vector<std::thread> threads;
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+        for (int i = 0; i < shards; ++i) {
+            threads.emplace_back([&, i] {
+                pin(i);
+                RandomStringGenerator::seed(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(mode), static_cast<uint64_t>(i)}));
+                std::vector<Operation> ops = stream(i);
+                ready.fetch_add(1);
+                while (!go.load()) std::this_thread::yield();
+                for (const Operation& op : ops) {
+                    uint64_t begin = nowNs();
+                    SharedData& entry = entries[op.key];
+                    if (mode == Mode::StandardMutex) {
+                        std::lock_guard<std::mutex> lock(standard);
+                        op.update ? LockTester::writeOperation(entry) : LockTester::readOperation(entry);
+                    } else {
+                        std::shared_mutex& lock = mode == Mode::SharedMutex ? global : partitions[op.key / kKeysPerShard];
+                        if (op.update) {
+                            std::unique_lock<std::shared_mutex> guard(lock);
+                            LockTester::writeOperation(entry);
+                        } else {
+                            std::shared_lock<std::shared_mutex> guard(lock);
+                            LockTester::readOperation(entry);
+                        }
+                    }
+                    results[i].latency.record(nowNs() - begin);
+                }
+            });
+        }
+        return collect(threads, results, release(ready, go));
+    }
+
+    /**
+     * @brief Runs one thread per core, each the only one to touch its partition.
+     *
+     * Queue `q[from * shards + to]` carries requests from core `from` to core `to`, and a second
+     * set the completions back. A core never has more than `inFlight` requests outstanding, so
+     * no ring holds more than that and a push never fails; the cores therefore need no flow
+     * control and cannot deadlock on full rings.
+     */
+    Result runSharedNothing() {
+        std::vector<std::vector<SharedData>> partitions(shards);
+        std::vector<std::unique_ptr<SpscQueue<Message>>> requests, completions;
+        for (int i = 0; i < shards * shards; ++i) {
+            requests.push_back(std::make_unique<SpscQueue<Message>>(inFlight));
+            completions.push_back(std::make_unique<SpscQueue<Message>>(inFlight));
+        }
+        std::vector<Result> results(shards);
+        std::vector<std::thread> threads;
+        std::atomic<int> ready{0}, finished{0};
+        std::atomic<bool> go{false};
+        for (int i = 0; i < shards; ++i) {
+            threads.emplace_back([&, i] {
+                pin(i);
+                RandomStringGenerator::seed(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(Mode::SharedNothing), static_cast<uint64_t>(i)}));
+                // Each core allocates and first touches its own partition
+                std::vector<SharedData>& local = partitions[i] = makeEntries(kKeysPerShard);
+                std::vector<Operation> ops = stream(i);
+                Result& result = results[i];
+                auto execute = [&](const Message& message) {
+                    SharedData& entry = local[message.key % kKeysPerShard];
+                    message.update ? LockTester::writeOperation(entry) : LockTester::readOperation(entry);
+                };
+                ready.fetch_add(1);
+                while (!go.load()) std::this_thread::yield();
+
+                size_t issued = 0, completed = 0;
+                int outstanding = 0;
+                bool done = false;
+                while (!done || finished.load(std::memory_order_acquire) < shards) {
+                    bool progress = false;
+                    for (; issued < ops.size() && outstanding < inFlight; ++issued) {
+                        Message message{ops[issued].key, ops[issued].update, nowNs()};
+                        int owner = static_cast<int>(message.key / kKeysPerShard);
+                        if (owner == i) {
+                            execute(message);
+                            result.latency.record(nowNs() - message.issuedNs);
+                            ++completed;
+                        } else {
+                            requests[i * shards + owner]->push(message);
+                            ++outstanding;
+                            ++result.remote;
+                        }
+                        progress = true;
+                    }
+                    Message message;
+                    for (int from = 0; from < shards; ++from) {
+                        while (requests[from * shards + i]->pop(message)) {
+                            execute(message);
+                            completions[i * shards + from]->push(message);
+                            progress = true;
+                        }
+                        while (completions[from * shards + i]->pop(message)) {
+                            result.latency.record(nowNs() - message.issuedNs);
+                            --outstanding;
+                            ++completed;
+                            progress = true;
+                        }
+                    }
+                    if (!done && completed == ops.size()) {
+                        done = true;
+                        finished.fetch_add(1, std::memory_order_release);
+                    }
+                    // Cores share CPUs when there are more shards than CPUs
+                    if (!progress) std::this_thread::yield();
+                }
+            });
+        }
+        return collect(threads, results, release(ready, go));
+    }
+
+    /// Waits until every thread prepared its operations, then starts them; @return The start time.
+    std::chrono::steady_clock::time_point release(std::atomic<int>& ready, std::atomic<bool>& go) const {
+        while (ready.load() < shards) std::this_thread::yield();
+        auto start = std::chrono::steady_clock::now();
+        go = true;
+        return start;
+    }
+
+    /// Joins the threads and merges their results.
+    Result collect(std::vector<std::thread>& threads, const std::vector<Result>& results, std::chrono::steady_clock::time_point start) const {
+        for (auto& t : threads) t.join();
+        Result total;
+        total.elapsedNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+        for (const Result& result : results) {
+            total.remote += result.remote;
+            total.latency.merge(result.latency);
+        }
+        return total;
+    }
+
+    int shards;         /**< Cores, partitions and threads. */
+    int operations;     /**< Operations per core. */
+    double writeShare;  /**< Share of updates. */
+    int inFlight;       /**< Outstanding operations per core in the shared-nothing mode. */
+    uint64_t seed;      /**< Seed of the key sequences and payloads. */
+};
+
+/**
+ * @class CopyBenchmark
+ * @brief Compares the streaming copy and fill kernels with `memcpy` and `memset` across payload sizes.
+ *
+ * For every size and kernel it measures copy and fill bandwidth, and how much of a victim
+ * working set the copy evicted. The victim stands for the other threads' data and the lock
+ * lines: it is read, one payload is copied, and the victim is read again while the counter
+ * counts last-level cache misses. Without hardware counters the second read is timed and
+ * compared with a read that followed no copy. Only the destination bypasses the cache; the
+ * source is still loaded through it.
+ */
+class CopyBenchmark final {
+public:
+    /// @param maxSize Largest payload; 0 picks twice the last-level cache, between 64 MiB and 256 MiB.
+    explicit CopyBenchmark(size_t maxSize = 0) : maxSize(maxSize) {}
+
+    /// Runs every size and kernel and prints the table.
+    void run() {
+        long llc = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        size_t cacheSize = llc > 0 ? static_cast<size_t>(llc) : 0;
+        size_t largest = maxSize ? maxSize : std::min<size_t>(256 << 20, std::max<size_t>(64 << 20, 2 * cacheSize));
+        std::vector<char> victim(cacheSize ? std::min<size_t>(std::max<size_t>(cacheSize / 4, 256 << 10), 8 << 20) : 4 << 20, 1);
+        CacheMissCounter counter;
+
+        uint64_t warmNs = median([&] {
+            touch(victim);
+            auto start = std::chrono::steady_clock::now();
+            touch(victim);
+            return nanosSince(start);
+        });
+        std::cout << "Last-level cache " << (cacheSize ? std::to_string(cacheSize >> 10) + " KiB" : std::string("unknown"))
+                  << ", victim working set " << (victim.size() >> 10) << " KiB, warm re-read "
+                  << LatencyHistogram::format(warmNs) << ", cache-miss counter "
+                  << (counter.available() ? "available" : "unavailable (re-read time only)") << std::endl;
+
+        TextTable table({"Size", "Kernel", "Copy", "Fill", "Victim re-read", "Victim LLC misses"});
+        for (size_t size = 4 << 10; size <= largest; size *= 8) {
+            std::vector<char> source(size, 'x'), destination(size, 0);
+            for (const StreamingCopy::Kernels& kernels : StreamingCopy::available()) {
+                int rounds = static_cast<int>(std::max<size_t>(3, std::min<size_t>(100000, (256 << 20) / size)));
+                auto bandwidth = [&](auto operation) {
+                    auto start = std::chrono::steady_clock::now();
+                    for (int i = 0; i < rounds; ++i) operation();
+                    double seconds = nanosSince(start) / 1e9;
+                    std::ostringstream out;
+                    out << std::fixed << std::setprecision(1) << size * static_cast<double>(rounds) / seconds / 1e9 << " GB/s";
+                    return out.str();
+                };
+                std::string copy = bandwidth([&] { kernels.copy(destination.data(), source.data(), size); });
+                std::string fill = bandwidth([&] { kernels.fill(destination.data(), 'y', size); });
+                std::vector<uint64_t> misses;
+                uint64_t rereadNs = median([&] {
+                    touch(victim);
+                    kernels.copy(destination.data(), source.data(), size);
+                    counter.start();
+                    auto start = std::chrono::steady_clock::now();
+                    touch(victim);
+                    uint64_t elapsed = nanosSince(start);
+                    misses.push_back(counter.stop());
+                    return elapsed;
+                });
+                std::ostringstream reread;
+                reread << LatencyHistogram::format(rereadNs) << " (" << std::fixed << std::setprecision(1)
+                       << (warmNs ? static_cast<double>(rereadNs) / warmNs : 0.0) << "x warm)";
+                table.addRow({formatSize(size), kernels.name, copy, fill, reread.str(),
+                              counter.available() ? std::to_string(medianOf(misses)) : std::string("n/a")});
+            }
+        }
+        table.print();
+    }
+
+private:
+    /// Reads one byte of every cache line of `buffer`.
+    static void touch(const std::vector<char>& buffer) {
+        unsigned sum = 0;
+        for (size_t i = 0; i < buffer.size(); i += 64) sum += static_cast<unsigned char>(buffer[i]);
+        volatile unsigned sink = sum;
+        (void)sink;
+    }
+
+    /// @return The median of five runs of `trial`, each returning nanoseconds.
+    template <typename Trial>
+    static uint64_t median(Trial&& trial) {
+        std::vector<uint64_t> samples;
+        for (int i = 0; i < 5; ++i) samples.push_back(trial());
+        return medianOf(samples);
+    }
+
+    /// @return The median of `samples`, which it reorders.
+    static uint64_t medianOf(std::vector<uint64_t>& samples) {
+        std::sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    /// @return The nanoseconds elapsed since `start`.
+    static uint64_t nanosSince(std::chrono::steady_clock::time_point start) {
+        return static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    }
+
+    /// @return `size` in KiB or MiB.
+    static std::string formatSize(size_t size) {
+        return size >= (1 << 20) ? std::to_string(size >> 20) + " MiB" : std::to_string(size >> 10) + " KiB";
+    }
+
+    size_t maxSize; /**< Largest payload size, or 0 for automatic. */
+};
+
+/**
+ * @class ManyLocksBenchmark
+ * @brief Measures the footprint and speed of millions of mostly uncontended locks, one per object.
+ *
+ * Every object is a lock next to a 64-bit value. Threads pick objects at random, so almost
+ * every acquisition is uncontended, except for a small share of operations that go to a few
+ * hot objects and exercise the slow paths. The shared mutexes read under a shared hold and
+ * update under an exclusive one; the mutexes take every operation exclusively. The report
+ * shows the size of the lock and of the object, the memory of the whole table, the time to
+ * construct it, the throughput and how often threads parked in the `ParkingLot`.
+ */
+class ManyLocksBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param objects Objects, each with its own lock.
+     * @param threads Threads operating on them.
+     * @param operations Operations per thread.
+     * @param seed Seed of the object choices.
+     */
+    ManyLocksBenchmark(size_t objects, int threads, int operations, uint64_t seed)
+        : objects(std::max<size_t>(kHotObjects, objects)), threads(std::max(1, threads)), operations(std::max(1, operations)),
+          seed(seed) {}
+
+    /// Runs every lock type and prints the comparison.
+    void run() {
+        std::vector<Result> results;
+        results.push_back(runLock<std::mutex>("std::mutex", false));
+        results.push_back(runLock<ParkingMutex>("Parking Mutex", false));
+        results.push_back(runLock<std::shared_mutex>("std::shared_mutex", true));
+        results.push_back(runLock<ParkingSharedMutex>("Parking Shared", true));
+
+        TextTable table({"Lock", "Lock size", "Object size", "Memory", "Setup", "Throughput", "vs std", "Parks"});
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+            const Result& baseline = results[i & ~size_t(1)];
+            std::ostringstream ratio;
+            ratio << std::fixed << std::setprecision(2) << result.rate / baseline.rate << "x";
+            table.addRow({result.name, std::to_string(result.lockSize) + " B", std::to_string(result.objectSize) + " B",
+                          std::to_string((result.objectSize * objects) >> 20) + " MiB", LatencyHistogram::format(result.setupNs),
+                          ScalingStudy::formatRate(result.rate), ratio.str(), std::to_string(result.parks)});
+        }
+        std::cout << "\nMany locks (" << objects << " objects, " << threads << " threads, " << operations
+                  << " operations per thread, " << kHotShare * 100 << "% on " << kHotObjects << " hot objects):" << std::endl;
+        table.print();
+    }
+
+private:
+    /// Objects that take the contended share of the operations.
+    static constexpr size_t kHotObjects = 16;
+    /// Share of the operations on the hot objects.
+    static constexpr double kHotShare = 0.01;
+    /// Share of the operations of the shared mutexes that update.
+    static constexpr double kUpdateShare = 0.1;
+
+    /**
+     * @struct Result
+     * @brief Measurements of one lock type.
+     */
+    struct Result {
+        std::string name;       /**< Lock type. */
+        size_t lockSize = 0;    /**< Bytes of one lock. */
+        size_t objectSize = 0;  /**< Bytes of one object, padding included. */
+        uint64_t setupNs = 0;   /**< Time to construct every object. */
+        double rate = 0;        /**< Operations per second of all threads. */
+        uint64_t parks = 0;     /**< Threads parked in the `ParkingLot` meanwhile. */
+    };
+
+    /**
+     * @struct Object
+     * @brief A value with its own lock.
+     */
+    template <typename Lock>
+    struct Object {
+        Lock lock;           /**< Guards `value`. */
+        uint64_t value = 0;  /**< The protected value. */
+    };
+
+    /// Constructs the objects and runs the threads on one lock type.
+    template <typename Lock>
+    Result runLock(const std::string& name, bool shared) {
+        Result result;
+        result.name = name;
+        result.lockSize = sizeof(Lock);
+        result.objectSize = sizeof(Object<Lock>);
+        auto setupStart = std::chrono::steady_clock::now();
+        std::unique_ptr<Object<Lock>[]> table(new Object<Lock>[objects]);
+        result.setupNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - setupStart).count());
+
+        uint64_t parksBefore = ParkingLot::parkCount();
+        std::atomic<int> ready{0};
+        std::vector<std::thread> workers;
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(t)}));
+                std::uniform_int_distribution<size_t> any(0, objects - 1), hot(0, kHotObjects - 1);
+                std::bernoulli_distribution hotPick(kHotShare), update(shared ? kUpdateShare : 1.0);
+                ready.fetch_add(1);
+                while (ready.load() < threads) std::this_thread::yield();
+                uint64_t sink = 0;
+                for (int n = 0; n < operations; ++n) {
+                    Object<Lock>& object = table[hotPick(engine) ? hot(engine) : any(engine)];
+                    if (update(engine)) {
+                        std::lock_guard<Lock> guard(object.lock);
+                        ++object.value;
+                    } else {
+                        readShared(object, sink);
+                    }
+                }
+                volatile uint64_t keep = sink;
+                (void)keep;
+            });
+        }
+        for (auto& worker : workers) worker.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        result.rate = static_cast<double>(threads) * operations / seconds;
+        result.parks = ParkingLot::parkCount() - parksBefore;
+        return result;
+    }
+
+    /// Reads an object under a shared hold; mutexes never get here.
+    template <typename Lock>
+    static void readShared(Object<Lock>& object, uint64_t& sink) {
+        if constexpr (std::is_same<Lock, std::shared_mutex>::value || std::is_same<Lock, ParkingSharedMutex>::value) {
+            std::shared_lock<Lock> guard(object.lock);
+            sink += object.value;
+        }
+    }
+
+    size_t objects;   /**< Objects, each with its own lock. */
+    int threads;      /**< Worker threads. */
+    int operations;   /**< Operations per thread. */
+    uint64_t seed;    /**< Seed of the object choices. */
+};
+
+/**
+ * @class KvServerBenchmark
+ * @brief A loopback key-value server over SharedData entries, driven by a closed-loop client.
+ *
+ * The server keeps its entries behind one lock of the lock family and serves fixed-size get
+ * and put requests from a pool of worker threads, each with its own epoll instance and a
+ * share of the connections. Client threads each own a connection and keep one request in
+ * flight, over a Unix domain socket or loopback TCP. Gets take a shared hold where the lock
+ * has one. Per lock the report gives the request rate and end-to-end latency percentiles as
+ * the client sees them, next to the server's lock wait, so that a lock that wins in
+ * `LockTester` can be checked against the socket and scheduling costs around it.
+ */
+class KvServerBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param workers Server threads.
+     * @param clients Client threads, each with its own connection.
+     * @param keys Entries in the store.
+     * @param writePercent Share of puts, in percent.
+     * @param tcp Whether to use loopback TCP instead of a Unix domain socket.
+     * @param lockTime Run time of each lock.
+     * @param seed Seed of the keys and operations of every client.
+     */
+    KvServerBenchmark(int workers, int clients, size_t keys, double writePercent, bool tcp, std::chrono::seconds lockTime,
+                      uint64_t seed)
+        : workers(std::max(1, workers)), clients(std::max(1, clients)), keys(std::max<size_t>(1, keys)),
+          writePercent(writePercent), tcp(tcp), lockTime(lockTime), seed(seed) {}
+
+    /**
+     * @brief Runs every lock type and prints the comparison.
+     * @throws std::runtime_error If the sockets cannot be set up.
+     */
+    void run() {
+        std::vector<Result> results;
+        results.push_back(runLock<std::mutex>("Standard Mutex"));
+        results.push_back(runLock<std::shared_mutex>("Shared Mutex"));
+        results.push_back(runLock<PiMutex>("PI Mutex"));
+        results.push_back(runLock<FutexPiMutex>("Futex PI Mutex"));
+        results.push_back(runLock<ParkingMutex>("Parking Mutex"));
+        results.push_back(runLock<ParkingSharedMutex>("Parking Shared"));
+
+        auto ns = LatencyHistogram::format;
+        TextTable table({"Lock", "Requests/s", "p50", "p90", "p99", "p99.9", "Lock wait p99", "Lock share"});
+        for (const Result& result : results) {
+            std::ostringstream share;
+            share << std::fixed << std::setprecision(2)
+                  << (result.latency.mean() > 0 ? 100 * result.lockWait.mean() / result.latency.mean() : 0.0) << "%";
+            table.addRow({result.name, ScalingStudy::formatRate(result.rate), ns(result.latency.percentile(0.5)),
+                          ns(result.latency.percentile(0.9)), ns(result.latency.percentile(0.99)),
+                          ns(result.latency.percentile(0.999)), ns(result.lockWait.percentile(0.99)), share.str()});
+        }
+        std::cout << "\nKey-value server over " << (tcp ? "loopback TCP" : "a Unix domain socket") << " (" << workers
+                  << " workers, " << clients << " clients, " << keys << " keys, " << writePercent << "% puts, "
+                  << lockTime.count() << " s per lock):" << std::endl;
+        table.print();
+        std::cout << "Lock share is the mean server lock wait over the mean end-to-end latency." << std::endl;
+    }
+
+private:
+    /// Bytes of a value; requests and responses are fixed-size.
+    static constexpr size_t kValueSize = 56;
+
+    /// Request operations.
+    enum Op : uint32_t { kGet = 0, kPut = 1 };
+
+    /**
+     * @struct Request
+     * @brief A get or put as it travels from the client to the server.
+     */
+    struct Request {
+        uint32_t op = kGet;        /**< `kGet` or `kPut`. */
+        uint32_t key = 0;          /**< Entry index. */
+        char value[kValueSize];    /**< Value a put stores. */
+    };
+
+    /**
+     * @struct Response
+     * @brief The entry as the server read or left it.
+     */
+    struct Response {
+        int32_t counter = 0;       /**< Updates of the entry so far. */
+        uint32_t length = 0;       /**< Bytes of `value` in use. */
+        char value[kValueSize];    /**< Value of the entry. */
+    };
+
+    /**
+     * @struct Connection
+     * @brief The server end of a connection and the request it is reading.
+     */
+    struct Connection {
+        explicit Connection(int fd) : fd(fd) {}
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+        ~Connection() { if (fd >= 0) close(fd); }
+
+        int fd;                /**< Server socket. */
+        Request request{};     /**< Request being read. */
+        size_t filled = 0;     /**< Bytes of `request` read so far. */
+    };
+
+    /**
+     * @struct Result
+     * @brief Measurements of one lock type.
+     */
+    struct Result {
+        std::string name;            /**< Lock type. */
+        double rate = 0;             /**< Requests per second of all clients. */
+        LatencyHistogram latency;    /**< End-to-end latency seen by the clients. */
+        LatencyHistogram lockWait;   /**< Time the server waited for the lock per request. */
+    };
+
+    /// @return Whether the lock type has a shared mode for gets.
+    template <typename Lock>
+    static constexpr bool hasSharedMode() {
+        return std::is_same<Lock, std::shared_mutex>::value || std::is_same<Lock, ParkingSharedMutex>::value;
+    }
+
+    /// Starts the server and clients on one lock type and measures them for `lockTime`.
+    template <typename Lock>
+    Result runLock(const std::string& name) {
+        Lock lock;
+        std::vector<SharedData> entries(keys);
+        for (SharedData& entry : entries) entry.text.assign(kValueSize, 'v');
+
+        std::vector<int> clientFds;
+        std::vector<std::vector<std::unique_ptr<Connection>>> shares(workers);
+        for (const auto& pair : connectAll()) {
+            clientFds.push_back(pair.first);
+            shares[clientFds.size() % workers].push_back(std::make_unique<Connection>(pair.second));
+        }
+
+        std::vector<LatencyHistogram> lockWaits(workers);
+        std::vector<std::thread> servers;
+        for (int w = 0; w < workers; ++w) {
+            servers.emplace_back([&, w] {
+                serve([&](const Request& request, Response& response) {
+                    handle(lock, entries, request, response, lockWaits[w]);
+                }, shares[w]);
+            });
+        }
+
+        std::vector<LatencyHistogram> latencies(clients);
+        std::vector<uint64_t> requests(clients, 0);
+        std::atomic<int> ready{0};
+        std::atomic<bool> go{false};
+        std::vector<std::thread> clientThreads;
+        for (int c = 0; c < clients; ++c) {
+            clientThreads.emplace_back([&, c] {
+                std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {static_cast<uint64_t>(c)}));
+                std::uniform_int_distribution<uint32_t> key(0, static_cast<uint32_t>(keys - 1));
+                std::bernoulli_distribution put(writePercent / 100);
+                Request request;
+                std::memset(request.value, 'a' + c % 26, kValueSize);
+                Response response;
+                ready.fetch_add(1);
+                while (!go.load()) std::this_thread::yield();
+                auto deadline = std::chrono::steady_clock::now() + lockTime;
+                for (;;) {
+                    request.op = put(engine) ? kPut : kGet;
+                    request.key = key(engine);
+                    auto start = std::chrono::steady_clock::now();
+                    if (start >= deadline) break;
+                    if (!transfer(clientFds[c], &request, sizeof(request), true) ||
+                        !transfer(clientFds[c], &response, sizeof(response), false))
+                        break;
+                    latencies[c].record(static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+                    ++requests[c];
+                }
+                // Closing the connection is what lets its worker finish
+                close(clientFds[c]);
+            });
+        }
+        while (ready.load() < clients) std::this_thread::yield();
+        auto start = std::chrono::steady_clock::now();
+        go.store(true);
+        for (auto& thread : clientThreads) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        for (auto& thread : servers) thread.join();
+
+        Result result;
+        result.name = name;
+        uint64_t total = 0;
+        for (int c = 0; c < clients; ++c) {
+            result.latency.merge(latencies[c]);
+            total += requests[c];
+        }
+        for (const auto& wait : lockWaits) result.lockWait.merge(wait);
+        result.rate = static_cast<double>(total) / seconds;
+        return result;
+    }
+
+    /// Serves one request under the lock, recording how long the lock took.
+    template <typename Lock>
+    static void handle(Lock& lock, std::vector<SharedData>& entries, const Request& request, Response& response,
+                       LatencyHistogram& lockWait) {
+        SharedData& entry = entries[request.key % entries.size()];
+        auto start = std::chrono::steady_clock::now();
+        auto waited = [&] {
+            lockWait.record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+        };
+        auto copyOut = [&] {
+            response.counter = entry.counter;
+            response.length = static_cast<uint32_t>(std::min(entry.text.size(), kValueSize));
+            std::memcpy(response.value, entry.text.data(), response.length);
+        };
+        if (request.op == kPut) {
+            std::lock_guard<Lock> guard(lock);
+            waited();
+            ++entry.counter;
+            entry.text.assign(request.value, kValueSize);
+            copyOut();
+        } else if constexpr (hasSharedMode<Lock>()) {
+            std::shared_lock<Lock> guard(lock);
+            waited();
+            copyOut();
+        } else {
+            std::lock_guard<Lock> guard(lock);
+            waited();
+            copyOut();
+        }
+    }
+
+    /**
+     * @brief Runs one worker: reads requests from its connections and answers them until all are closed.
+     * @param handler Serves a complete request.
+     * @param connections The worker's connections.
+     *
+     * Reads do not block, so a partial request only waits for the next readiness. Responses
+     * are written blocking; a client has at most one request in flight, so the socket buffer
+     * always has room for its response. Every connection is closed on return, including on
+     * failure, so no client is left blocked on a response that will never come.
+     */
+    template <typename Handler>
+    static void serve(Handler&& handler, std::vector<std::unique_ptr<Connection>>& connections) {
+        int epoll = epoll_create1(EPOLL_CLOEXEC);
+        if (epoll < 0) {
+            std::cerr << "Warning: epoll_create1 failed: " << std::strerror(errno) << std::endl;
+            connections.clear();
+            return;
+        }
+        size_t open = 0;
+        for (auto& connection : connections) {
+            epoll_event event{};
+            event.events = EPOLLIN;
+            event.data.ptr = connection.get();
+            if (epoll_ctl(epoll, EPOLL_CTL_ADD, connection->fd, &event) == 0) ++open;
+        }
+        epoll_event events[64];
+        Response response;
+        while (open > 0) {
+            int count = epoll_wait(epoll, events, 64, -1);
+            if (count < 0 && errno == EINTR) continue;
+            if (count < 0) break;
+            for (int i = 0; i < count; ++i) {
+                Connection& connection = *static_cast<Connection*>(events[i].data.ptr);
+                ssize_t got = recv(connection.fd, reinterpret_cast<char*>(&connection.request) + connection.filled,
+                                   sizeof(Request) - connection.filled, MSG_DONTWAIT);
+                if (got < 0 && (errno == EAGAIN || errno == EINTR)) continue;
+                if (got > 0) connection.filled += static_cast<size_t>(got);
+                if (got > 0 && connection.filled < sizeof(Request)) continue;
+                if (got > 0) {
+                    connection.filled = 0;
+                    handler(connection.request, response);
+                    if (transfer(connection.fd, &response, sizeof(response), true)) continue;
+                }
+                // End of stream or a failed connection
+                epoll_ctl(epoll, EPOLL_CTL_DEL, connection.fd, nullptr);
+                --open;
+            }
+        }
+        close(epoll);
+        // Connections epoll never took or an epoll_wait failure left behind
+        connections.clear();
+    }
+
+    /**
+     * @brief Sends or receives a whole buffer on a blocking socket.
+     * @return False if the peer closed the connection or it failed.
+     */
+    static bool transfer(int fd, void* buffer, size_t size, bool send) {
+        char* bytes = static_cast<char*>(buffer);
+        for (size_t done = 0; done < size;) {
+            ssize_t n = send ? ::send(fd, bytes + done, size - done, MSG_NOSIGNAL) : recv(fd, bytes + done, size - done, 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            done += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Opens a listening socket and connects every client to it.
+     * @return The client and server socket of each connection.
+     * @throws std::runtime_error If a socket cannot be created, bound or connected.
+     */
+    std::vector<std::pair<int, int>> connectAll() const {
+        std::vector<std::pair<int, int>> pairs;
+        int listener = -1;
+        auto fail = [&](const std::string& what) {
+            std::string message = what + ": " + std::strerror(errno);
+            for (const auto& pair : pairs) {
+                close(pair.first);
+                close(pair.second);
+            }
+            if (listener >= 0) close(listener);
+            throw std::runtime_error(message);
+        };
+
+        sockaddr_storage address{};
+        socklen_t length = 0;
+        if (tcp) {
+            auto* inet = reinterpret_cast<sockaddr_in*>(&address);
+            inet->sin_family = AF_INET;
+            inet->sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            length = sizeof(sockaddr_in);
+        } else {
+            // An abstract address needs no file and disappears with the socket
+            auto* local = reinterpret_cast<sockaddr_un*>(&address);
+            local->sun_family = AF_UNIX;
+            std::string name = "lock-bench-kv-" + std::to_string(getpid());
+            std::memcpy(local->sun_path + 1, name.data(), name.size());
+            length = static_cast<socklen_t>(offsetof(sockaddr_un, sun_path) + 1 + name.size());
+        }
+        listener = socket(address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (listener < 0) fail("cannot create the listening socket");
+        if (bind(listener, reinterpret_cast<sockaddr*>(&address), length) != 0) fail("cannot bind the listening socket");
+        if (listen(listener, clients) != 0) fail("cannot listen");
+        // The kernel picked the TCP port
+        if (getsockname(listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) fail("getsockname failed");
+
+        int noDelay = 1;
+        for (int c = 0; c < clients; ++c) {
+            int client = socket(address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if (client < 0) fail("cannot create a client socket");
+            if (connect(client, reinterpret_cast<sockaddr*>(&address), length) != 0) {
+                close(client);
+                fail("cannot connect to the server");
+            }
+            int server = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+            if (server < 0) {
+                close(client);
+                fail("cannot accept a connection");
+            }
+            pairs.emplace_back(client, server);
+            if (tcp) {
+                setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+                setsockopt(server, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+            }
+        }
+        close(listener);
+        return pairs;
+    }
+
+    int workers;                    /**< Server threads. */
+    int clients;                    /**< Client threads and connections. */
+    size_t keys;                    /**< Entries in the store. */
+    double writePercent;            /**< Share of puts, in percent. */
+    bool tcp;                       /**< Loopback TCP instead of a Unix domain socket. */
+    std::chrono::seconds lockTime;  /**< Run time of each lock. */
+    uint64_t seed;                  /**< Seed of the client requests. */
+};
+
+/**
+ * @class FutexBucketBenchmark
+ * @brief Measures futex operations while very many waiters sit in the kernel's futex hash.
+ *
+ * The kernel hashes every futex word to a bucket with a spinlock and a chain of the waiters
+ * queued in it, so with a large population of parked locks an operation on one word walks and
+ * locks past waiters of unrelated words. For each word count N the benchmark parks waiters on
+ * N distinct words, 128 per thread with `futex_waitv`, and then, on as many other words:
+ *  - probes: threads issue wakes that find nobody and waits whose value no longer matches,
+ *    each of which takes a bucket lock, in a loop; the rate is the throughput;
+ *  - wake latency: a waker wakes a thread parked on a random word and measures until it runs.
+ * Both private futexes (`FUTEX_PRIVATE_FLAG`) and shared ones on a `MAP_SHARED` mapping are
+ * compared; the latter are keyed by page and always live in the global table, while recent
+ * kernels give each process a private hash of its own. Probes and wakes stop early after
+ * `kPhaseBudget`, as operations slow down by orders of magnitude once the chains are long.
+ */
+class FutexBucketBenchmark final {
+public:
+    /**
+     * @brief Constructs the benchmark.
+     * @param wordCounts Numbers of parked words to compare.
+     * @param probes Threads issuing probe operations.
+     * @param operations Probe operations per thread.
+     * @param wakes Wakes measured per word count.
+     * @param seed Seed of the word choices.
+     */
+    FutexBucketBenchmark(std::vector<size_t> wordCounts, int probes, int operations, int wakes, uint64_t seed)
+        : wordCounts(std::move(wordCounts)), probes(std::max(1, probes)), operations(std::max(1, operations)),
+          wakes(std::max(1, wakes)), seed(seed) {}
+
+    /**
+     * @brief Runs every word count with private and shared futexes and prints the comparison.
+     * @throws std::runtime_error If the kernel has no `futex_waitv` or waiters cannot be parked.
+     */
+    void run() {
+        if (!Futex::hasWaitv()) throw std::runtime_error("parking many waiters needs futex_waitv (Linux 5.16)");
+        TextTable table({"Futexes", "Words", "Parked threads", "Setup", "Wake p50", "Wake p99", "Probe rate", "vs fewest"});
+        for (bool shared : {false, true}) {
+            double baseline = 0;
+            for (size_t words : wordCounts) {
+                Result result = runCase(words, shared);
+                if (baseline == 0) baseline = result.rate;
+                std::ostringstream ratio;
+                ratio << std::fixed << std::setprecision(3) << result.rate / baseline << "x";
+                table.addRow({shared ? "Shared" : "Private", std::to_string(words), std::to_string(result.parkers),
+                              LatencyHistogram::format(result.setupNs), LatencyHistogram::format(result.wake.percentile(0.5)),
+                              LatencyHistogram::format(result.wake.percentile(0.99)), ScalingStudy::formatRate(result.rate),
+                              ratio.str()});
+            }
+        }
+        std::cout << "\nFutex hash buckets (" << probes << " probe threads x up to " << operations << " operations and up to "
+                  << wakes << " wakes per row, at most " << kPhaseBudget.count() << " s each):" << std::endl;
+        table.print();
+    }
+
+private:
+    /// Stack of a parking thread; it only holds one `futex_waitv` vector.
+    static constexpr size_t kParkerStack = 64 * 1024;
+    /// Longest the probes or the wakes of one row run, so that crowded buckets end early.
+    static constexpr std::chrono::seconds kPhaseBudget{2};
+
+    /**
+     * @struct Result
+     * @brief Measurements of one word count and futex kind.
+     */
+    struct Result {
+        size_t parkers = 0;          /**< Threads parked on the words. */
+        uint64_t setupNs = 0;        /**< Time to start the threads and see them all asleep. */
+        LatencyHistogram wake;       /**< From the wake call to the woken thread running. */
+        double rate = 0;             /**< Probe operations per second of all probe threads. */
+    };
+
+    /**
+     * @struct Parker
+     * @brief A thread parked on up to `FUTEX_WAITV_MAX` words.
+     */
+    struct Parker {
+        uint32_t* words = nullptr;         /**< Table of parked and probe words. */
+        size_t first = 0;                  /**< First parked word, counted in parked words. */
+        size_t count = 0;                  /**< Parked words of this thread. */
+        bool shared = false;               /**< Whether the words are shared futexes. */
+        const std::atomic<bool>* stop = nullptr; /**< Set when the thread should exit. */
+        std::atomic<pid_t> tid{0};         /**< Kernel thread id once started. */
+        std::atomic<int> error{0};         /**< `errno` of a failed wait. */
+        pthread_t thread{};                /**< The thread. */
+    };
+
+    /// @return Parked word `index` of the table; parked words are the even ones.
+    static uint32_t* parkedWord(uint32_t* words, size_t index) { return words + 2 * index; }
+
+    /// @return Probe word `index` of the table, next to the parked word of the same index.
+    static uint32_t* probeWord(uint32_t* words, size_t index) { return words + 2 * index + 1; }
+
+    /// @return The futex system call on `word`, private unless `shared`.
+    static long futex(uint32_t* word, int op, uint32_t value, bool shared) {
+        return syscall(SYS_futex, word, shared ? op : op | FUTEX_PRIVATE_FLAG, value, nullptr, nullptr, 0);
+    }
+
+    /// Body of a parking thread: waits on all its words until told to stop.
+    static void* park(void* argument) {
+        Parker& parker = *static_cast<Parker*>(argument);
+        std::array<futex_waitv, FUTEX_WAITV_MAX> vector{};
+        for (size_t i = 0; i < parker.count; ++i) {
+            vector[i].uaddr = reinterpret_cast<uintptr_t>(parkedWord(parker.words, parker.first + i));
+            vector[i].flags = parker.shared ? FUTEX_32 : FUTEX_32 | FUTEX_PRIVATE_FLAG;
+        }
+        parker.tid.store(static_cast<pid_t>(syscall(SYS_gettid)));
+        while (!parker.stop->load()) {
+            if (syscall(SYS_futex_waitv, vector.data(), parker.count, 0, nullptr, CLOCK_MONOTONIC) >= 0) continue;
+            if (errno == EAGAIN || errno == EINTR) continue;
+            parker.error.store(errno);
+            break;
+        }
+        return nullptr;
+    }
+
+    /// @return Whether a thread of this process is asleep, as its `/proc` state says.
+    static bool asleep(pid_t tid) {
+        std::ifstream stat("/proc/self/task/" + std::to_string(tid) + "/stat");
+        std::string text((std::istreambuf_iterator<char>(stat)), std::istreambuf_iterator<char>());
+        size_t end = text.rfind(')');
+        return end != std::string::npos && end + 2 < text.size() && text[end + 2] == 'S';
+    }
+
+    /**
+     * @brief Parks waiters on `words` words, measures probes and wakes beside them and releases them.
+     * @throws std::runtime_error If the table cannot be mapped or a thread cannot be started or parked.
+     */
+    Result runCase(size_t words, bool shared) {
+        size_t bytes = 2 * words * sizeof(uint32_t);
+        void* memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, (shared ? MAP_SHARED : MAP_PRIVATE) | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) throw std::runtime_error(std::string("cannot map futex words: ") + std::strerror(errno));
+        uint32_t* table = static_cast<uint32_t*>(memory);
+
+        Result result;
+        std::atomic<bool> stop{false};
+        std::vector<std::unique_ptr<Parker>> parkers;
+        std::string failure;
+        auto setupStart = std::chrono::steady_clock::now();
+        pthread_attr_t attributes;
+        pthread_attr_init(&attributes);
+        pthread_attr_setstacksize(&attributes, kParkerStack);
+        for (size_t first = 0; first < words && failure.empty(); first += FUTEX_WAITV_MAX) {
+            auto parker = std::make_unique<Parker>();
+            parker->words = table;
+            parker->first = first;
+            parker->count = std::min<size_t>(FUTEX_WAITV_MAX, words - first);
+            parker->shared = shared;
+            parker->stop = &stop;
+            int error = pthread_create(&parker->thread, &attributes, park, parker.get());
+            if (error) failure = std::string("cannot start a parking thread: ") + std::strerror(error);
+            else parkers.push_back(std::move(parker));
+        }
+        pthread_attr_destroy(&attributes);
+        for (size_t i = 0; i < parkers.size() && failure.empty();) {
+            const Parker& parker = *parkers[i];
+            if (parker.error.load()) failure = std::string("futex_waitv failed: ") + std::strerror(parker.error.load());
+            else if (parker.tid.load() && asleep(parker.tid.load())) ++i;
+            else std::this_thread::yield();
+        }
+        result.parkers = parkers.size();
+        result.setupNs = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - setupStart).count());
+
+        if (failure.empty()) {
+            result.rate = probe(table, words, shared);
+            result.wake = measureWakes(table, words, shared);
+        }
+
+        // A parker between waits sees the changed word and checks the stop flag
+        stop.store(true);
+        for (auto& parker : parkers) {
+            uint32_t* word = parkedWord(table, parker->first);
+            __atomic_store_n(word, 1u, __ATOMIC_RELEASE);
+            futex(word, FUTEX_WAKE, 1, shared);
+        }
+        for (auto& parker : parkers) pthread_join(parker->thread, nullptr);
+        munmap(memory, bytes);
+        if (!failure.empty()) throw std::runtime_error(failure);
+        return result;
+    }
+
+    /// @return Probe operations per second: alternating empty wakes and stale waits on random probe words.
+    double probe(uint32_t* table, size_t words, bool shared) const {
+        std::atomic<int> ready{0};
+        std::atomic<uint64_t> total{0};
+        std::vector<std::thread> threads;
+        auto start = std::chrono::steady_clock::now();
+        auto deadline = start + kPhaseBudget;
+        for (int t = 0; t < probes; ++t) {
+            threads.emplace_back([&, t] {
+                std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {words, shared, static_cast<uint64_t>(t)}));
+                std::uniform_int_distribution<size_t> pick(0, words - 1);
+                ready.fetch_add(1);
+                while (ready.load() < probes) std::this_thread::yield();
+                int n = 0;
+                for (; n < operations && (n & 255 || std::chrono::steady_clock::now() < deadline); ++n) {
+                    uint32_t* word = probeWord(table, pick(engine));
+                    // The word holds 0, so waiting for 1 fails with EAGAIN once the bucket is locked
+                    if (n & 1) futex(word, FUTEX_WAIT, 1, shared);
+                    else futex(word, FUTEX_WAKE, 1, shared);
+                }
+                total.fetch_add(static_cast<uint64_t>(n));
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return static_cast<double>(total.load()) / seconds;
+    }
+
+    /// @return Latencies of waking a thread parked on a random probe word among the parked ones.
+    LatencyHistogram measureWakes(uint32_t* table, size_t words, bool shared) const {
+        LatencyHistogram latencies;
+        std::atomic<uint32_t*> target{nullptr};
+        std::atomic<int> round{0}, done{0};
+        std::atomic<int64_t> wokeAt{0};
+        auto nowNs = [] {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        };
+        std::thread waiter([&] {
+            for (int r = 1;; ++r) {
+                while (round.load() != r && round.load() >= 0) std::this_thread::yield();
+                if (round.load() < 0) break;
+                // Only the waker's wake ends this wait; the word stays 0
+                while (futex(target.load(), FUTEX_WAIT, 0, shared) != 0) {}
+                wokeAt.store(nowNs());
+                done.store(r);
+            }
+        });
+        std::mt19937_64 engine(RandomStringGenerator::deriveSeed(seed, {words, shared, ~0ull}));
+        std::uniform_int_distribution<size_t> pick(0, words - 1);
+        auto deadline = std::chrono::steady_clock::now() + kPhaseBudget;
+        for (int r = 1; r <= wakes && std::chrono::steady_clock::now() < deadline; ++r) {
+            uint32_t* word = probeWord(table, pick(engine));
+            target.store(word);
+            round.store(r);
+            int64_t wakeAt = 0;
+            // Retry until the waiter is queued on the word
+            do {
+                std::this_thread::yield();
+                wakeAt = nowNs();
+            } while (futex(word, FUTEX_WAKE, 1, shared) != 1);
+            while (done.load() != r) std::this_thread::yield();
+            latencies.record(static_cast<uint64_t>(std::max<int64_t>(0, wokeAt.load() - wakeAt)));
+        }
+        round.store(-1);
+        waiter.join();
+        return latencies;
+    }
+
+    std::vector<size_t> wordCounts; /**< Numbers of parked words to compare. */
+    int probes;                     /**< Probe threads. */
+    int operations;                 /**< Probe operations per thread. */
+    int wakes;                      /**< Wakes measured per row. */
+    uint64_t seed;                  /**< Seed of the word choices. */
+};
+
+/**
+ * @class EnvironmentInfo
+ * @brief Captures the machine and build conditions that influence benchmark results.
+ *
+ * Collected once at start-up and embedded into every result (history file, HTML report), so
+ * that a change in the numbers can be told apart from a change in the environment: CPU model
+ * and microcode, frequency governor and turbo, SMT, isolated and tickless CPUs, kernel and
+ * glibc versions, compiler and flags, transparent huge pages and the load average.
+ */
+class EnvironmentInfo final {
+public:
+    /**
+     * @brief Reads the current environment from `/proc`, `/sys` and the build configuration.
+     * @return The collected information; unavailable items are reported as `unknown`.
+     */
+    static EnvironmentInfo collect() {
+        EnvironmentInfo info;
+        info.cpuModel = cpuinfoField("model name");
+        info.microcode = cpuinfoField("microcode");
+        info.onlineCpus = static_cast<int>(std::thread::hardware_concurrency());
+        info.governor = readFirstLine("/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor");
+
+        std::string noTurbo = readFirstLine("/sys/devices/system/cpu/intel_pstate/no_turbo");
+        std::string boost = readFirstLine("/sys/devices/system/cpu/cpufreq/boost");
+        if (noTurbo != kUnknown) info.turbo = noTurbo == "0" ? "on" : "off";
+        else if (boost != kUnknown) info.turbo = boost == "1" ? "on" : "off";
+
+        std::string smt = readFirstLine("/sys/devices/system/cpu/smt/active");
+        if (smt != kUnknown) info.smt = smt == "1" ? "on" : "off";
+
+        info.isolatedCpus = readFirstLine("/sys/devices/system/cpu/isolated");
+        info.nohzFullCpus = readFirstLine("/sys/devices/system/cpu/nohz_full");
+        if (info.isolatedCpus.empty()) info.isolatedCpus = "none";
+        if (info.nohzFullCpus.empty() || info.nohzFullCpus == "(null)") info.nohzFullCpus = "none";
+
+        utsname uts{};
+        if (uname(&uts) == 0) info.kernel = std::string(uts.release) + " " + uts.version;
+        info.glibc = gnu_get_libc_version();
+        info.compiler = __VERSION__;
+        info.compilerFlags = BUILD_FLAGS;
+
+        std::string thp = readFirstLine("/sys/kernel/mm/transparent_hugepage/enabled");
+        auto open = thp.find('['), close = thp.find(']');
+        info.transparentHugePages = open != std::string::npos && close > open ? thp.substr(open + 1, close - open - 1) : thp;
+
+        double load[3];
+        if (getloadavg(load, 3) == 3) info.loadAverage = load[0];
+        return info;
+    }
+
+    /**
+     * @brief Returns the information as ordered key/value pairs for results and reports.
+     * @return Attributes prefixed with `env.`.
+     */
+    std::vector<std::pair<std::string, std::string>> attributes() const {
+        std::ostringstream load;
+        load << std::fixed << std::setprecision(2) << loadAverage;
+        return {
+            {"env.cpu_model", cpuModel},
+            {"env.microcode", microcode},
+            {"env.online_cpus", std::to_string(onlineCpus)},
+            {"env.governor", governor},
+            {"env.turbo", turbo},
+            {"env.smt", smt},
+            {"env.isolcpus", isolatedCpus},
+            {"env.nohz_full", nohzFullCpus},
+            {"env.kernel", kernel},
+            {"env.glibc", glibc},
+            {"env.compiler", compiler},
+            {"env.cxxflags", compilerFlags},
+            {"env.thp", transparentHugePages},
+            {"env.loadavg_1m", load.str()},
+        };
+    }
+
+    /**
+     * @brief Lists the conditions that are likely to add noise to the measurements.
+     * @param maxThreads The largest number of threads any configured test case runs at once.
+     * @return Human-readable warnings; empty when the environment looks quiet.
+     */
+    std::vector<std::string> warnings(int maxThreads) const {
+        std::vector<std::string> result;
+        if (governor == "powersave" || governor == "conservative" || governor == "ondemand" || governor == "schedutil")
+            result.push_back("CPU frequency governor is '" + governor + "'; use 'performance' for stable clocks");
+        if (turbo == "on")
+            result.push_back("turbo boost is enabled; clock speed will vary with temperature and active cores");
+        if (smt == "on")
+            result.push_back("SMT is active; sibling hyperthreads share execution units and caches");
+        if (loadAverage > std::max(1.0, onlineCpus * 0.1)) {
+            std::ostringstream load;
+            load << std::fixed << std::setprecision(2) << loadAverage;
+            result.push_back("1-minute load average is " + load.str() + "; other work is competing for the CPUs");
+        }
+        if (onlineCpus > 0 && maxThreads > onlineCpus)
+            result.push_back("test cases run up to " + std::to_string(maxThreads) + " threads on " +
+                             std::to_string(onlineCpus) + " CPUs; results measure time-slicing as much as locking");
+        if (transparentHugePages == "always")
+            result.push_back("transparent huge pages are 'always'; khugepaged compaction can add latency spikes");
+#ifndef __OPTIMIZE__
+        result.push_back("binary was built without optimization");
+#endif
+        return result;
+    }
+
+    std::string cpuModel = kUnknown;             /**< CPU model name. */
+    std::string microcode = kUnknown;            /**< Microcode revision. */
+    int onlineCpus = 0;                          /**< Number of online logical CPUs. */
+    std::string governor = kUnknown;             /**< cpufreq scaling governor of CPU 0. */
+    std::string turbo = kUnknown;                /**< Turbo/boost state: `on`, `off` or `unknown`. */
+    std::string smt = kUnknown;                  /**< SMT state: `on`, `off` or `unknown`. */
+    std::string isolatedCpus = kUnknown;         /**< CPUs isolated with `isolcpus`. */
+    std::string nohzFullCpus = kUnknown;         /**< CPUs running tickless with `nohz_full`. */
+    std::string kernel = kUnknown;               /**< Kernel release and version. */
+    std::string glibc = kUnknown;                /**< glibc version. */
+    std::string compiler = kUnknown;             /**< Compiler version string. */
+    std::string compilerFlags = kUnknown;        /**< Compiler flags the binary was built with. */
+    std::string transparentHugePages = kUnknown; /**< Active THP mode. */
+    double loadAverage = 0;                      /**< 1-minute load average at start. */
+
+private:
+    static constexpr const char* kUnknown = "unknown"; /**< Placeholder for unavailable items. */
+
+    /**
+     * @brief Reads the first line of a (usually sysfs) file.
+     * @param path The file to read.
+     * @return The line, or `unknown` if the file does not exist.
+     */
+    static std::string readFirstLine(const std::string& path) {
+        std::ifstream in(path);
+        std::string line;
+        if (!in || !std::getline(in, line)) return kUnknown;
+        return line;
+    }
+
+    /**
+     * @brief Looks up a field of the first CPU in `/proc/cpuinfo`.
+     * @param name Field name, e.g. `model name`.
+     * @return The field value, or `unknown` if absent.
+     */
+    static std::string cpuinfoField(const std::string& name) {
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.rfind(name, 0) != 0) continue;
+            auto colon = line.find(':');
+            if (colon == std::string::npos) continue;
+            auto start = line.find_first_not_of(" \t", colon + 1);
+            return start != std::string::npos ? line.substr(start) : kUnknown;
+        }
+        return kUnknown;
+    }
+};
+
+/**
+ * @class ResultsHistory
+ * @brief An append-only, tab-separated store of benchmark results across runs.
+ *
+ * Every run appends one `run` line with its metadata (timestamp, git revision, host fingerprint,
+ * command line) followed by one `metric` line per test case and metric:
+ *
+ * ```
+ * run    <run id>  timestamp=2024-05-01T10:00:00Z  git=1a2b3c4  host=box  host_fp=9f...  args=./main
+ * metric <run id>  50/2/10000/1  Shared Mutex Time  223  ms
+ * ```
+ *
+ * Lines are never rewritten, so the file can be kept across kernel or glibc rollouts and
+ * `printTrendReport()` can show how each metric moved over time and where it stepped.
+ */
+class ResultsHistory final {
+public:
+    /// Ordered key/value metadata attached to a run.
+    using Attributes = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @struct Sample
+     * @brief One metric value of one test case.
+     */
+    struct Sample {
+        std::string caseKey; /**< Test case configuration as `readers/writers/reads/updates`. */
+        std::string metric;  /**< Metric name, e.g. `Shared Mutex Time`. */
+        double value;        /**< Measured value. */
+        std::string unit;    /**< Unit of the value, e.g. `ms`. */
+    };
+
+    /**
+     * @brief Constructs a history bound to the given file.
+     * @param path Path of the history file; it is created on the first append.
+     */
+    explicit ResultsHistory(std::string path) : path(std::move(path)) {}
+
+    /**
+     * @brief Builds the metadata every run carries: timestamp, git revision and host fingerprint.
+     * @param commandLine The command line the benchmark was started with.
+     * @return The run attributes; callers may append further configuration.
+     */
+    static Attributes currentRunAttributes(const std::string& commandLine) {
+        std::time_t now = std::time(nullptr);
+        std::tm utc{};
+        gmtime_r(&now, &utc);
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y-%m-%dT%H:%M:%SZ", &utc);
+
+        char hostname[256] = "unknown";
+        gethostname(hostname, sizeof(hostname) - 1);
+
+        return {
+            {"timestamp", timestamp},
+            {"git", GIT_REVISION},
+            {"host", hostname},
+            {"host_fp", hostFingerprint()},
+            {"args", commandLine},
+        };
+    }
+
+    /**
+     * @brief Appends one run and its samples to the history file.
+     * @param attributes Run metadata as returned by `currentRunAttributes()`.
+     * @param samples The metric values of the run.
+     * @return The identifier assigned to the run.
+     * @throws std::runtime_error If the file cannot be opened for appending.
+     */
+    std::string append(const Attributes& attributes, const std::vector<Sample>& samples) const {
+        std::ofstream out(path, std::ios::app);
+        if (!out) throw std::runtime_error("cannot open history file " + path);
+        out << std::setprecision(12);
+
+        std::string runId = makeRunId(attributes);
+        out << "run\t" << runId;
+        for (const auto& attribute : attributes) out << "\t" << attribute.first << "=" << sanitize(attribute.second);
+        out << "\n";
+        for (const auto& sample : samples) {
+            out << "metric\t" << runId << "\t" << sanitize(sample.caseKey) << "\t" << sanitize(sample.metric)
+                << "\t" << sample.value << "\t" << sanitize(sample.unit) << "\n";
+        }
+        return runId;
+    }
+
+    /**
+     * @brief Looks up the metadata of a recorded run.
+     * @param runId The run identifier printed when the run was appended.
+     * @return The run attributes by key.
+     * @throws std::runtime_error If the file cannot be read or holds no such run.
+     */
+    std::map<std::string, std::string> findRun(const std::string& runId) const {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("cannot open history file " + path);
+        std::string line;
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields = split(line, '\t');
+            if (fields.size() < 2 || fields[0] != "run" || fields[1] != runId) continue;
+            std::map<std::string, std::string> attributes;
+            for (size_t i = 2; i < fields.size(); ++i) {
+                auto eq = fields[i].find('=');
+                if (eq != std::string::npos) attributes[fields[i].substr(0, eq)] = fields[i].substr(eq + 1);
+            }
+            return attributes;
+        }
+        throw std::runtime_error("run " + runId + " not found in " + path);
+    }
+
+    /**
+     * @brief Prints per-metric trends over all recorded runs and flags step changes.
+     * @param stepThreshold Relative change against the trailing median that counts as a step (0.1 = 10%).
+     * @param out The output stream.
+     * @throws std::runtime_error If the history file cannot be read.
+     *
+     * Series are kept apart per host fingerprint, so results from different machines are never
+     * compared with each other. A point is flagged when it deviates from the median of up to
+     * `kBaselineWindow` preceding points by more than `stepThreshold`.
+     */
+    void printTrendReport(double stepThreshold, std::ostream& out = std::cout) const {
+        std::ifstream in(path);
+        if (!in) throw std::runtime_error("cannot open history file " + path);
+
+        std::map<std::string, Run> runs;
+        std::vector<std::string> runOrder;
+        std::map<std::tuple<std::string, std::string, std::string>, std::vector<Point>> series;
+
+        std::string line;
+        while (std::getline(in, line)) {
+            std::vector<std::string> fields = split(line, '\t');
+            if (fields.size() >= 2 && fields[0] == "run") {
+                Run& run = runs[fields[1]];
+                for (size_t i = 2; i < fields.size(); ++i) {
+                    auto eq = fields[i].find('=');
+                    if (eq != std::string::npos) run.attributes[fields[i].substr(0, eq)] = fields[i].substr(eq + 1);
+                }
+                runOrder.push_back(fields[1]);
+            } else if (fields.size() >= 6 && fields[0] == "metric") {
+                auto run = runs.find(fields[1]);
+                if (run == runs.end()) continue;
+                Point point{fields[1], std::strtod(fields[4].c_str(), nullptr), fields[5]};
+                series[{run->second.attributes["host_fp"], fields[2], fields[3]}].push_back(point);
+            }
+        }
+
+        out << "History: " << path << " (" << runOrder.size() << " runs)" << std::endl;
+        std::vector<std::string> steps;
+        std::string currentHost;
+        std::unique_ptr<TextTable> table;
+
+        for (const auto& entry : series) {
+            const std::string& hostFp = std::get<0>(entry.first);
+            if (!table || hostFp != currentHost) {
+                if (table) table->print(out);
+                currentHost = hostFp;
+                const auto& attrs = runs[entry.second.front().runId].attributes;
+                auto host = attrs.find("host");
+                out << "\nHost " << (host != attrs.end() ? host->second : "unknown") << " [" << hostFp << "]" << std::endl;
+                table = std::make_unique<TextTable>(std::vector<std::string>{
+                    "Case (R/W/Reads/Updates)", "Metric", "Runs", "First", "Min", "Max", "Last", "Trend", "Steps"});
+            }
+
+            const auto& points = entry.second;
+            double minValue = points.front().value, maxValue = points.front().value;
+            for (const auto& point : points) {
+                minValue = std::min(minValue, point.value);
+                maxValue = std::max(maxValue, point.value);
+            }
+
+            int stepCount = 0;
+            for (size_t i = 1; i < points.size(); ++i) {
+                std::vector<double> window;
+                for (size_t j = i > kBaselineWindow ? i - kBaselineWindow : 0; j < i; ++j) window.push_back(points[j].value);
+                double baseline = median(window);
+                if (baseline == 0) continue;
+                double change = (points[i].value - baseline) / baseline;
+                if (std::fabs(change) > stepThreshold) {
+                    ++stepCount;
+                    std::ostringstream step;
+                    step << runs[points[i].runId].attributes["timestamp"] << "  " << std::get<1>(entry.first) << "  "
+                         << std::get<2>(entry.first) << ": " << formatValue(baseline) << " -> "
+                         << formatValue(points[i].value) << " " << points[i].unit << " (" << std::showpos
+                         << std::fixed << std::setprecision(1) << change * 100 << "%" << std::noshowpos
+                         << ", git " << runs[points[i].runId].attributes["git"] << ")";
+                    steps.push_back(step.str());
+                }
+            }
+
+            const std::string& unit = points.back().unit;
+            table->addRow({std::get<1>(entry.first), std::get<2>(entry.first), std::to_string(points.size()),
+                           formatValue(points.front().value) + " " + unit, formatValue(minValue) + " " + unit,
+                           formatValue(maxValue) + " " + unit, formatValue(points.back().value) + " " + unit,
+                           sparkline(points, minValue, maxValue), stepCount ? std::to_string(stepCount) : "-"});
+        }
+        if (table) table->print(out);
+
+        out << "\nStep changes (> " << stepThreshold * 100 << "% against trailing median):" << std::endl;
+        if (steps.empty()) out << "  none" << std::endl;
+        for (const auto& step : steps) out << "  " << step << std::endl;
+    }
+
+private:
+    /// Number of preceding points whose median is the baseline for step detection.
+    static constexpr size_t kBaselineWindow = 5;
+    /// Number of most recent points drawn in the trend column.
+    static constexpr size_t kSparklinePoints = 12;
+
+    /**
+     * @struct Run
+     * @brief Metadata of a run read back from the history file.
+     */
+    struct Run {
+        std::map<std::string, std::string> attributes; /**< Key/value metadata of the run. */
+    };
+
+    /**
+     * @struct Point
+     * @brief One value of a metric series.
+     */
+    struct Point {
+        std::string runId; /**< Run the value belongs to. */
+        double value;      /**< Measured value. */
+        std::string unit;  /**< Unit of the value. */
+    };
+
+    /**
+     * @brief Hashes the properties that identify a machine: hostname, CPU model, core count and kernel.
+     * @return A 64-bit FNV-1a hash as a hexadecimal string.
+     */
+    static std::string hostFingerprint() {
+        std::string identity;
+        char hostname[256] = "";
+        gethostname(hostname, sizeof(hostname) - 1);
+        identity += hostname;
+
+        std::ifstream cpuinfo("/proc/cpuinfo");
+        std::string line;
+        while (std::getline(cpuinfo, line)) {
+            if (line.rfind("model name", 0) == 0) {
+                identity += line;
+                break;
+            }
+        }
+        identity += std::to_string(std::thread::hardware_concurrency());
+
+        utsname uts{};
+        if (uname(&uts) == 0) identity += std::string(uts.sysname) + uts.release + uts.machine;
+
+        uint64_t hash = 1469598103934665603ull;
+        for (unsigned char c : identity) {
+            hash ^= c;
+            hash *= 1099511628211ull;
+        }
+        std::ostringstream hex;
+        hex << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return hex.str();
+    }
+
+    /**
+     * @brief Derives a run identifier from the run timestamp and the process id.
+     * @param attributes Run metadata containing `timestamp`.
+     * @return An identifier unique within the history file.
+     */
+    static std::string makeRunId(const Attributes& attributes) {
+        std::string id;
+        for (const auto& attribute : attributes)
+            if (attribute.first == "timestamp") id = attribute.second;
+        id.erase(std::remove_if(id.begin(), id.end(), [](char c) { return c == '-' || c == ':'; }), id.end());
+        return id + "-" + std::to_string(getpid());
+    }
+
+    /**
+     * @brief Replaces separators that would break the line format.
+     * @param value The value to store.
+     * @return The value with tabs and newlines replaced by spaces.
+     */
+    static std::string sanitize(std::string value) {
+        std::replace_if(value.begin(), value.end(), [](char c) { return c == '\t' || c == '\n' || c == '\r'; }, ' ');
+        return value;
+    }
+
+    /**
+     * @brief Splits a line on a delimiter.
+     * @param line The line to split.
+     * @param delimiter The field delimiter.
+     * @return The fields, including empty ones.
+     */
+    static std::vector<std::string> split(const std::string& line, char delimiter) {
+        std::vector<std::string> fields;
+        std::string field;
+        std::istringstream stream(line);
+        while (std::getline(stream, field, delimiter)) fields.push_back(field);
+        return fields;
+    }
+
+    /**
+     * @brief Computes the median of a set of values.
+     * @param values The values; taken by copy because they are partially sorted.
+     * @return The median, or 0 for an empty set.
+     */
+    static double median(std::vector<double> values) {
+        if (values.empty()) return 0;
+        auto middle = values.begin() + values.size() / 2;
+        std::nth_element(values.begin(), middle, values.end());
+        return *middle;
+    }
+
+    /**
+     * @brief Formats a value compactly, without a fractional part for whole numbers.
+     * @param value The value to format.
+     * @return The formatted value.
+     */
+    static std::string formatValue(double value) {
+        std::ostringstream out;
+        if (value == std::floor(value) && std::fabs(value) < 1e15) out << static_cast<long long>(value);
+        else out << std::fixed << std::setprecision(2) << value;
+        return out.str();
+    }
+
+    /**
+     * @brief Draws the most recent points of a series as a row of ASCII levels.
+     * @param points The series.
+     * @param minValue Smallest value of the series.
+     * @param maxValue Largest value of the series.
+     * @return One character per point, from `_` (minimum) to `^` (maximum).
+     */
+    static std::string sparkline(const std::vector<Point>& points, double minValue, double maxValue) {
+        static const char levels[] = "_.-=*^";
+        static const int levelCount = sizeof(levels) - 2;
+        std::string line;
+        size_t first = points.size() > kSparklinePoints ? points.size() - kSparklinePoints : 0;
+        for (size_t i = first; i < points.size(); ++i) {
+            int level = maxValue > minValue
+                ? static_cast<int>(std::lround((points[i].value - minValue) / (maxValue - minValue) * levelCount))
+                : 0;
+            line += levels[level];
+        }
+        return line;
+    }
+
+    std::string path; /**< Path of the history file. */
+};
+
+/**
+ * @class HtmlReport
+ * @brief Renders benchmark results into a single self-contained HTML file with inline SVG charts.
+ *
+ * The report needs no network access or external assets. It contains:
+ * - a throughput-vs-threads chart per lock, one point per test case;
+ * - reader and writer latency CDFs per test case, one curve per lock and role;
+ * - per-thread fairness bars per test case and lock, normalized to the mean thread throughput.
+ */
+class HtmlReport final {
+public:
+    /**
+     * @struct LockResult
+     * @brief Measurements of one lock in one test case.
+     */
+    struct LockResult {
+        std::string lock;                         /**< Lock name, e.g. `Shared Mutex`. */
+        long long timeMs;                         /**< Wall time of the test in milliseconds. */
+        double throughput;                        /**< Completed operations per second. */
+        const LatencyHistogram* readerLatency;    /**< Reader latencies; must outlive the report. */
+        const LatencyHistogram* writerLatency;    /**< Writer latencies; must outlive the report. */
+        std::vector<double> readerThroughputs;    /**< Operations per second of each reader thread. */
+        std::vector<double> writerThroughputs;    /**< Operations per second of each writer thread. */
+    };
+
+    /**
+     * @struct CaseResult
+     * @brief Configuration and measurements of one test case.
+     */
+    struct CaseResult {
+        std::string label;              /**< Human-readable configuration, e.g. `50R/2W 10000x1`. */
+        int threads;                    /**< Total number of reader and writer threads. */
+        std::vector<LockResult> locks;  /**< Results per lock. */
+    };
+
+    /**
+     * @brief Constructs an empty report.
+     * @param title Title shown in the browser tab and page header.
+     */
+    explicit HtmlReport(std::string title) : title(std::move(title)) {}
+
+    /**
+     * @brief Adds a test case to the report.
+     * @param result The test case results.
+     * @return Reference to the HtmlReport object for chaining.
+     */
+    HtmlReport& addCase(CaseResult result) {
+        cases.push_back(std::move(result));
+        return *this;
+    }
+
+    /**
+     * @brief Writes the report to a file.
+     * @param path Output file path.
+     * @param metadata Key/value pairs shown in the report header (revision, host, ...).
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    void write(const std::string& path, const std::vector<std::pair<std::string, std::string>>& metadata) const {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("cannot write report " + path);
+
+        out << "<!DOCTYPE html>\n<html><head><meta charset=\"utf-8\"><title>" << escape(title) << "</title>\n"
+            << "<style>body{font-family:sans-serif;margin:24px;color:#222}h2{margin-top:40px;border-bottom:1px solid #ccc}"
+            << "table{border-collapse:collapse}td,th{border:1px solid #ccc;padding:2px 8px;text-align:right}"
+            << ".charts{display:flex;flex-wrap:wrap;gap:16px}svg{background:#fafafa;border:1px solid #ddd}"
+            << "svg text{font-size:11px}</style></head><body>\n"
+            << "<h1>" << escape(title) << "</h1>\n<table>";
+        for (const auto& entry : metadata)
+            out << "<tr><th>" << escape(entry.first) << "</th><td style=\"text-align:left\">" << escape(entry.second) << "</td></tr>";
+        out << "</table>\n";
+
+        writeSummary(out);
+        writeScaling(out);
+        for (size_t i = 0; i < cases.size(); ++i) writeCase(out, cases[i], i);
+        out << "</body></html>\n";
+    }
+
+private:
+    /**
+     * @class SvgPlot
+     * @brief Maps data coordinates onto an SVG canvas and draws axes, series and a legend.
+     */
+    class SvgPlot {
+    public:
+        /**
+         * @brief Creates a plot for the given data ranges.
+         * @param xMin Smallest x value.
+         * @param xMax Largest x value.
+         * @param yMin Smallest y value.
+         * @param yMax Largest y value.
+         * @param logX Whether the x axis is logarithmic.
+         */
+        SvgPlot(double xMin, double xMax, double yMin, double yMax, bool logX)
+            : xMin(logX ? std::log10(std::max(xMin, 1.0)) : xMin), xMax(logX ? std::log10(std::max(xMax, 1.0)) : xMax),
+              yMin(yMin), yMax(yMax), logX(logX) {
+            if (this->xMax <= this->xMin) this->xMax = this->xMin + 1;
+            if (this->yMax <= this->yMin) this->yMax = this->yMin + 1;
+        }
+
+        /// @return The SVG x coordinate of a data value.
+        double x(double value) const {
+            double v = logX ? std::log10(std::max(value, 1.0)) : value;
+            return kLeft + (v - xMin) / (xMax - xMin) * (kWidth - kLeft - kRight);
+        }
+
+        /// @return The SVG y coordinate of a data value.
+        double y(double value) const {
+            return kHeight - kBottom - (value - yMin) / (yMax - yMin) * (kHeight - kTop - kBottom);
+        }
+
+        /**
+         * @brief Draws the axes with tick labels.
+         * @param out Output stream positioned inside an `<svg>` element.
+         * @param xLabel Caption of the x axis.
+         * @param yLabel Caption of the y axis.
+         * @param xFormat Formatter for x tick labels.
+         * @param yFormat Formatter for y tick labels.
+         */
+        template <typename XFormat, typename YFormat>
+        void axes(std::ostream& out, const std::string& xLabel, const std::string& yLabel,
+                  XFormat xFormat, YFormat yFormat) const {
+            out << "<line x1=\"" << kLeft << "\" y1=\"" << kHeight - kBottom << "\" x2=\"" << kWidth - kRight
+                << "\" y2=\"" << kHeight - kBottom << "\" stroke=\"#444\"/>"
+                << "<line x1=\"" << kLeft << "\" y1=\"" << kTop << "\" x2=\"" << kLeft << "\" y2=\""
+                << kHeight - kBottom << "\" stroke=\"#444\"/>";
+            std::vector<double> xTicks;
+            if (logX) {
+                for (double e = std::ceil(xMin); e <= xMax; ++e) xTicks.push_back(std::pow(10.0, e));
+            } else {
+                xTicks = linearTicks(xMin, xMax);
+            }
+            for (double tick : xTicks) {
+                out << "<line x1=\"" << x(tick) << "\" y1=\"" << kTop << "\" x2=\"" << x(tick) << "\" y2=\""
+                    << kHeight - kBottom << "\" stroke=\"#e4e4e4\"/><text x=\"" << x(tick) << "\" y=\""
+                    << kHeight - kBottom + 14 << "\" text-anchor=\"middle\">" << escape(xFormat(tick)) << "</text>";
+            }
+            for (double tick : linearTicks(yMin, yMax)) {
+                out << "<line x1=\"" << kLeft << "\" y1=\"" << y(tick) << "\" x2=\"" << kWidth - kRight << "\" y2=\""
+                    << y(tick) << "\" stroke=\"#e4e4e4\"/><text x=\"" << kLeft - 4 << "\" y=\"" << y(tick) + 4
+                    << "\" text-anchor=\"end\">" << escape(yFormat(tick)) << "</text>";
+            }
+            out << "<text x=\"" << (kLeft + kWidth - kRight) / 2 << "\" y=\"" << kHeight - 6
+                << "\" text-anchor=\"middle\">" << escape(xLabel) << "</text>"
+                << "<text transform=\"translate(12," << (kTop + kHeight - kBottom) / 2
+                << ") rotate(-90)\" text-anchor=\"middle\">" << escape(yLabel) << "</text>";
+        }
+
+        /**
+         * @brief Draws a series as a polyline with optional point markers.
+         * @param out Output stream positioned inside an `<svg>` element.
+         * @param points Data points in data coordinates.
+         * @param color Stroke color.
+         * @param dashed Whether the line is dashed.
+         * @param markers Whether each point gets a circle marker.
+         */
+        void series(std::ostream& out, const std::vector<std::pair<double, double>>& points, const std::string& color,
+                    bool dashed, bool markers) const {
+            out << "<polyline fill=\"none\" stroke=\"" << color << "\" stroke-width=\"1.5\""
+                << (dashed ? " stroke-dasharray=\"5,3\"" : "") << " points=\"";
+            for (const auto& point : points) out << x(point.first) << "," << y(point.second) << " ";
+            out << "\"/>";
+            if (markers) {
+                for (const auto& point : points)
+                    out << "<circle cx=\"" << x(point.first) << "\" cy=\"" << y(point.second) << "\" r=\"3\" fill=\""
+                        << color << "\"/>";
+            }
+        }
+
+        /**
+         * @brief Draws one legend entry; entries stack from the top-right corner.
+         * @param out Output stream positioned inside an `<svg>` element.
+         * @param index Position of the entry.
+         * @param label Entry text.
+         * @param color Entry color.
+         * @param dashed Whether the sample line is dashed.
+         */
+        void legend(std::ostream& out, int index, const std::string& label, const std::string& color, bool dashed) const {
+            double top = kTop + 6 + index * 14;
+            out << "<line x1=\"" << kWidth - kRight - 150 << "\" y1=\"" << top << "\" x2=\"" << kWidth - kRight - 130
+                << "\" y2=\"" << top << "\" stroke=\"" << color << "\" stroke-width=\"2\""
+                << (dashed ? " stroke-dasharray=\"5,3\"" : "") << "/><text x=\"" << kWidth - kRight - 126
+                << "\" y=\"" << top + 4 << "\">" << escape(label) << "</text>";
+        }
+
+        static constexpr int kWidth = 560;  /**< Canvas width in pixels. */
+        static constexpr int kHeight = 320; /**< Canvas height in pixels. */
+        static constexpr int kLeft = 70;    /**< Left margin, room for y tick labels. */
+        static constexpr int kRight = 12;   /**< Right margin. */
+        static constexpr int kTop = 12;     /**< Top margin. */
+        static constexpr int kBottom = 40;  /**< Bottom margin, room for x tick labels and caption. */
+
+    private:
+        /// @return About five evenly spaced round tick values covering [lo, hi].
+        static std::vector<double> linearTicks(double lo, double hi) {
+            double raw = (hi - lo) / 5;
+            double magnitude = std::pow(10.0, std::floor(std::log10(raw)));
+            double step = magnitude;
+            for (double factor : {2.0, 5.0, 10.0})
+                if (raw > step) step = magnitude * factor;
+            std::vector<double> ticks;
+            for (double tick = std::ceil(lo / step) * step; tick <= hi + step * 1e-9; tick += step) ticks.push_back(tick);
+            return ticks;
+        }
+
+        double xMin, xMax, yMin, yMax; /**< Data ranges (x in log10 units when logarithmic). */
+        bool logX;                     /**< Whether the x axis is logarithmic. */
+    };
+
+    /// @return A distinct color for the series with the given index.
+    static std::string color(size_t index) {
+        static const char* palette[] = {"#1f77b4", "#d62728", "#2ca02c", "#ff7f0e", "#9467bd",
+                                        "#8c564b", "#e377c2", "#7f7f7f", "#bcbd22", "#17becf"};
+        return palette[index % (sizeof(palette) / sizeof(palette[0]))];
+    }
+
+    /// @return The index of a lock name in first-seen order across all cases, for stable colors.
+    size_t lockIndex(const std::string& lock) const {
+        std::vector<std::string> seen;
+        for (const auto& testCase : cases)
+            for (const auto& lockResult : testCase.locks)
+                if (std::find(seen.begin(), seen.end(), lockResult.lock) == seen.end()) seen.push_back(lockResult.lock);
+        return std::find(seen.begin(), seen.end(), lock) - seen.begin();
+    }
+
+    /**
+     * @brief Writes a table with time, throughput and latency percentiles of every case and lock.
+     * @param out The output stream.
+     */
+    void writeSummary(std::ostream& out) const {
+        out << "<h2>Summary</h2><table><tr><th>Case</th><th>Lock</th><th>Time</th><th>Throughput</th>"
+            << "<th>Reader p50</th><th>Reader p99</th><th>Writer p50</th><th>Writer p99</th></tr>\n";
+        for (size_t i = 0; i < cases.size(); ++i) {
+            for (const auto& lock : cases[i].locks) {
+                const LatencyHistogram& readers = *lock.readerLatency;
+                const LatencyHistogram& writers = *lock.writerLatency;
+                out << "<tr><td><a href=\"#case" << i << "\">" << escape(cases[i].label) << "</a></td><td>"
+                    << escape(lock.lock) << "</td><td>" << lock.timeMs << " ms</td><td>"
+                    << formatRate(lock.throughput) << "</td><td>" << formatNs(readers.percentile(0.5)) << "</td><td>"
+                    << formatNs(readers.percentile(0.99)) << "</td><td>" << formatNs(writers.percentile(0.5))
+                    << "</td><td>" << formatNs(writers.percentile(0.99)) << "</td></tr>\n";
+            }
+        }
+        out << "</table>\n";
+    }
+
+    /**
+     * @brief Writes one throughput-vs-threads chart per lock.
+     * @param out The output stream.
+     */
+    void writeScaling(std::ostream& out) const {
+        std::map<std::string, std::vector<std::pair<double, double>>> byLock;
+        std::vector<std::string> order;
+        double maxThreads = 1, maxRate = 1;
+        for (const auto& testCase : cases) {
+            for (const auto& lock : testCase.locks) {
+                if (!byLock.count(lock.lock)) order.push_back(lock.lock);
+                double rate = lock.throughput;
+                byLock[lock.lock].emplace_back(testCase.threads, rate);
+                maxThreads = std::max(maxThreads, static_cast<double>(testCase.threads));
+                maxRate = std::max(maxRate, rate);
+            }
+        }
+
+        out << "<h2>Throughput vs. threads</h2><div class=\"charts\">\n";
+        for (const auto& lock : order) {
+            auto points = byLock[lock];
+            std::sort(points.begin(), points.end());
+            SvgPlot plot(0, maxThreads, 0, maxRate * 1.05, false);
+            out << "<div><h3>" << escape(lock) << "</h3><svg width=\"" << SvgPlot::kWidth << "\" height=\""
+                << SvgPlot::kHeight << "\">";
+            plot.axes(out, "threads (readers + writers)", "operations/s",
+                      [](double v) { return std::to_string(static_cast<long long>(v)); }, formatRate);
+            plot.series(out, points, color(lockIndex(lock)), false, true);
+            out << "</svg></div>\n";
+        }
+        out << "</div>\n";
+    }
+
+    /**
+     * @brief Writes the latency CDFs and fairness bars of one test case.
+     * @param out The output stream.
+     * @param testCase The test case.
+     * @param index Position of the case, used for the anchor.
+     */
+    void writeCase(std::ostream& out, const CaseResult& testCase, size_t index) const {
+        out << "<h2 id=\"case" << index << "\">" << escape(testCase.label) << "</h2><div class=\"charts\">\n";
+
+        // Latency CDFs: one solid curve (readers) and one dashed curve (writers) per lock
+        double maxNs = 1;
+        for (const auto& lock : testCase.locks) {
+            maxNs = std::max({maxNs, static_cast<double>(lock.readerLatency->max()),
+                              static_cast<double>(lock.writerLatency->max())});
+        }
+        SvgPlot cdfPlot(1, maxNs, 0, 1, true);
+        out << "<div><h3>Latency CDF</h3><svg width=\"" << SvgPlot::kWidth << "\" height=\"" << SvgPlot::kHeight << "\">";
+        cdfPlot.axes(out, "operation latency", "fraction of operations", formatNs,
+                     [](double v) { return std::to_string(static_cast<int>(std::lround(v * 100))) + "%"; });
+        int legendIndex = 0;
+        for (const auto& lock : testCase.locks) {
+            for (bool writers : {false, true}) {
+                const LatencyHistogram& histogram = writers ? *lock.writerLatency : *lock.readerLatency;
+                if (!histogram.count()) continue;
+                std::vector<std::pair<double, double>> points;
+                for (const auto& point : histogram.cdf()) points.emplace_back(static_cast<double>(point.first), point.second);
+                cdfPlot.series(out, points, color(lockIndex(lock.lock)), writers, false);
+                cdfPlot.legend(out, legendIndex++, lock.lock + (writers ? " writers" : " readers"),
+                               color(lockIndex(lock.lock)), writers);
+            }
+        }
+        out << "</svg></div>\n";
+
+        for (const auto& lock : testCase.locks) writeFairness(out, lock);
+        out << "</div>\n";
+    }
+
+    /**
+     * @brief Writes a bar per thread showing its throughput relative to the mean of its role.
+     * @param out The output stream.
+     * @param lock The lock results of one test case.
+     *
+     * A perfectly fair lock gives every bar the height 1.0; starved threads stand out as short bars.
+     */
+    void writeFairness(std::ostream& out, const LockResult& lock) const {
+        std::vector<std::pair<double, bool>> bars;
+        for (bool writers : {false, true}) {
+            const auto& threads = writers ? lock.writerThroughputs : lock.readerThroughputs;
+            double mean = 0;
+            for (double thread : threads) mean += thread;
+            mean = threads.empty() ? 0 : mean / threads.size();
+            for (double thread : threads) bars.emplace_back(mean > 0 ? thread / mean : 0, writers);
+        }
+        double maxRatio = 1.0;
+        for (const auto& bar : bars) maxRatio = std::max(maxRatio, bar.first);
+
+        SvgPlot plot(0, static_cast<double>(bars.size()), 0, maxRatio * 1.1, false);
+        out << "<div><h3>Fairness: " << escape(lock.lock) << "</h3><svg width=\"" << SvgPlot::kWidth << "\" height=\""
+            << SvgPlot::kHeight << "\">";
+        plot.axes(out, "thread (readers, then writers)", "throughput / role mean",
+                  [](double v) { return std::to_string(static_cast<long long>(v)); },
+                  [](double v) { std::ostringstream s; s << std::setprecision(2) << v; return s.str(); });
+        double barWidth = std::max(1.0, plot.x(1) - plot.x(0) - 1);
+        for (size_t i = 0; i < bars.size(); ++i) {
+            out << "<rect x=\"" << plot.x(static_cast<double>(i)) << "\" y=\"" << plot.y(bars[i].first) << "\" width=\""
+                << barWidth << "\" height=\"" << plot.y(0) - plot.y(bars[i].first) << "\" fill=\""
+                << (bars[i].second ? "#d62728" : "#1f77b4") << "\"><title>" << (bars[i].second ? "writer " : "reader ")
+                << i << ": " << bars[i].first << "</title></rect>";
+        }
+        out << "<line x1=\"" << plot.x(0) << "\" y1=\"" << plot.y(1) << "\" x2=\"" << plot.x(static_cast<double>(bars.size()))
+            << "\" y2=\"" << plot.y(1) << "\" stroke=\"#444\" stroke-dasharray=\"2,2\"/>";
+        plot.legend(out, 0, "readers", "#1f77b4", false);
+        plot.legend(out, 1, "writers", "#d62728", false);
+        out << "</svg></div>\n";
+    }
+
+    /// @return A nanosecond value with a readable unit.
+    static std::string formatNs(double ns) {
+        std::ostringstream out;
+        out << std::setprecision(3);
+        if (ns >= 1e9) out << ns / 1e9 << " s";
+        else if (ns >= 1e6) out << ns / 1e6 << " ms";
+        else if (ns >= 1e3) out << ns / 1e3 << " us";
+        else out << ns << " ns";
+        return out.str();
+    }
+
+    /// @return An operations-per-second value with a metric suffix.
+    static std::string formatRate(double rate) {
+        std::ostringstream out;
+        out << std::setprecision(3);
+        if (rate >= 1e6) out << rate / 1e6 << "M";
+        else if (rate >= 1e3) out << rate / 1e3 << "k";
+        else out << rate;
+        return out.str();
+    }
+
+    /// @return The text with HTML special characters escaped.
+    static std::string escape(const std::string& text) {
+        std::string escaped;
+        for (char c : text) {
+            switch (c) {
+                case '&': escaped += "&amp;"; break;
+                case '<': escaped += "&lt;"; break;
+                case '>': escaped += "&gt;"; break;
+                case '"': escaped += "&quot;"; break;
+                default: escaped += c;
+            }
+        }
+        return escaped;
+    }
+
+    std::string title;             /**< Report title. */
+    std::vector<CaseResult> cases; /**< Test cases in the order they were added. */
+};
+
+/**
+ * @class Benchmark
+ * @brief A class for adding and running lock test cases, then outputting benchmark results in a formatted table.
+ */
+class Benchmark final {
+public:
+    /**
+     * @brief Adds a new test case with specified reader/writer counts and operations.
+     * @param numReaders Number of reader threads for this test case.
+     * @param numWriters Number of writer threads for this test case.
+     * @param numReads Number of read operations each reader will perform.
+     * @param numUpdates Number of update operations each writer will perform.
+     * @return Reference to the Benchmark object for chaining.
+     *
+     * This method creates a new `LockTester` instance and stores it as a unique pointer in `testCases`.
+     */
+    Benchmark& addTestCase(int numReaders, int numWriters, int numReads, int numUpdates) {
+        testCases.emplace_back(std::make_unique<LockTester>(numReaders, numWriters, numReads, numUpdates));
+        return *this;
+    }
+
+    /**
+     * @brief Returns the largest number of threads any added test case runs at once.
+     * @return Readers plus writers of the biggest test case, or 0 without test cases.
+     */
+    int maxThreads() const {
+        int threads = 0;
+        for (const auto& tester : testCases) threads = std::max(threads, tester->numReaders + tester->numWriters);
+        return threads;
+    }
+
+    /**
+     * @brief Returns the configuration of every added test case.
+     * @return (readers, writers, reads per reader, updates per writer) of each test case, in order.
+     */
+    std::vector<std::tuple<int, int, int, int>> configurations() const {
+        std::vector<std::tuple<int, int, int, int>> configs;
+        for (const auto& tester : testCases)
+            configs.emplace_back(tester->numReaders, tester->numWriters, tester->numReads, tester->numUpdates);
+        return configs;
+    }
+
+    /**
+     * @brief Sets the seed every thread's generator seed is derived from.
+     * @param value The global seed; runs with the same seed generate the same payload sequences.
+     * @return Reference to the Benchmark object for chaining.
+     */
+    Benchmark& setSeed(uint64_t value) {
+        seed = value;
+        return *this;
+    }
+
+    /**
+     * @brief Enables deterministic pinning of reader and writer threads to CPUs.
+     * @param enabled Whether to pin threads.
+     * @return Reference to the Benchmark object for chaining.
+     */
+    Benchmark& setPinning(bool enabled) {
+        pinThreads = enabled;
+        return *this;
+    }
+
+    /**
+     * @brief Sets the scheduling class and nice value of reader and writer threads.
+     * @param readers Priority of every reader thread.
+     * @param writers Priority of every writer thread.
+     * @return Reference to the Benchmark object for chaining.
+     */
+    Benchmark& setPriorities(const ThreadPriority& readers, const ThreadPriority& writers) {
+        readerPriority = readers;
+        writerPriority = writers;
+        return *this;
+    }
+
+    /**
+     * @brief Sets how many replicas node replication uses on single-node machines.
+     * @param groups Number of core groups; multi-node machines use one replica per node.
+     * @return Reference to the Benchmark object for chaining.
+     */
+    Benchmark& setCoreGroups(int groups) {
+        coreGroups = std::max(1, groups);
+        return *this;
+    }
+
+    /**
+     * @brief Sets where SharedData, its text buffer and the lock words are placed in memory.
+     * @param data Placement of SharedData.
+     * @param text Placement of the text buffer.
+     * @param locks Placement of the lock words.
+     * @return Reference to the Benchmark object for chaining.
+     */
+    Benchmark& setPlacement(const MemoryPlacement& data, const MemoryPlacement& text, const MemoryPlacement& locks) {
+        dataPlacement = data;
+        textPlacement = text;
+        lockPlacement = locks;
+        return *this;
+    }
 
     /**
-     * @brief Function executed by writer threads using shared_mutex.
-     *
-     * Each writer acquires an exclusive lock on shared_mutex and updates the shared data.
+     * @brief Lets the test cases enable an external profiler only during their measured phases.
+     * @param control The profiler control, or null; must outlive `run()`.
+     * @return Reference to the Benchmark object for chaining.
      */
-    void writerSharedLock() {
-        for (int i = 0; i < numUpdates; ++i) {
-            std::unique_lock lock(sharedMutex);
-            sharedData.counter++;
-            sharedData.text = RandomStringGenerator::generate(10000);
-        }
+    Benchmark& setProfiler(ProfilerControl* control) {
+        profiler = control;
+        return *this;
     }
 
     /**
-     * @brief Function executed by reader threads using standard mutex.
-     *
-     * Each reader acquires a lock on standardMutex and reads the shared data.
+     * @brief Captures the call stacks of the slowest waits on the blocking locks.
+     * @param stacks The collector, or null; must outlive `run()`.
+     * @return Reference to the Benchmark object for chaining.
      */
-    void readerStandardLock() {
-        for (int i = 0; i < numReads; ++i) {
-            std::lock_guard lock(standardMutex);
-            volatile int data = sharedData.counter;
-            volatile std::string text = sharedData.text;
-        }
+    Benchmark& setWaitProfiler(WaitProfiler* stacks) {
+        waitProfiler = stacks;
+        return *this;
     }
 
     /**
-     * @brief Function executed by writer threads using standard mutex.
-     *
-     * Each writer acquires a lock on standardMutex and updates the shared data.
+     * @brief Adds the priority-inheritance mutexes to the locks every test case runs.
+     * @param enabled Whether to run `PI Mutex` and `Futex PI` as well.
+     * @return Reference to the Benchmark object for chaining.
      */
-    void writerStandardLock() {
-        for (int i = 0; i < numUpdates; ++i) {
-            std::lock_guard lock(standardMutex);
-            sharedData.counter++;
-            sharedData.text = RandomStringGenerator::generate(10000);
-        }
+    Benchmark& setPiLocks(bool enabled) {
+        piLocks = enabled;
+        return *this;
     }
 
-    SharedData sharedData;       /**< Shared data accessed by readers and writers. */
-    std::shared_mutex sharedMutex; /**< Mutex for shared lock testing. */
-    std::mutex standardMutex;    /**< Mutex for standard lock testing. */
-};
-
+    /**
+     * @brief Adds the parking-lot mutexes to the locks every test case runs.
+     * @param enabled Whether to run `Parking Mutex` and `Parking Shared` as well.
+     * @return Reference to the Benchmark object for chaining.
+     */
+    Benchmark& setParkingLocks(bool enabled) {
+        parkingLocks = enabled;
+        return *this;
+    }
 
-/**
- * @class Benchmark
- * @brief A class for adding and running lock test cases, then outputting benchmark results in a formatted table.
- */
-class Benchmark final {
-public:
     /**
-     * @brief Adds a new test case with specified reader/writer counts and operations.
-     * @param numReaders Number of reader threads for this test case.
-     * @param numWriters Number of writer threads for this test case.
-     * @param numReads Number of read operations each reader will perform.
-     * @param numUpdates Number of update operations each writer will perform.
+     * @brief Adds the lease lock to the read-dominated test cases.
+     * @param lease Lease length; zero leaves the lease lock out.
      * @return Reference to the Benchmark object for chaining.
      *
-     * This method creates a new `LockTester` instance and stores it as a unique pointer in `testCases`.
+     * A test case is read-dominated when reads are at least 90% of its operations.
      */
-    Benchmark& addTestCase(int numReaders, int numWriters, int numReads, int numUpdates) {
-        testCases.emplace_back(std::make_unique<LockTester>(numReaders, numWriters, numReads, numUpdates));
+    Benchmark& setLeaseTime(std::chrono::microseconds lease) {
+        leaseTime = lease;
         return *this;
     }
 
+    /**
+     * @brief Combines the payload digests of every writer of the last `run()`.
+     * @return A fingerprint that is equal for two runs exactly when every writer of every test
+     *         case and lock generated the same payload sequence.
+     */
+    uint64_t payloadDigest() const {
+        const LockTester::Definitions& ids = LockTester::definitions();
+        uint64_t digest = 0;
+        for (size_t caseIndex = 0; caseIndex < results.size(); ++caseIndex) {
+            uint64_t lockIndex = 0;
+            for (const auto& lock : results[caseIndex].stats) {
+                const auto& writers = lock.second.writers;
+                for (size_t writer = 0; writer < writers.size(); ++writer) {
+                    uint64_t writerDigest = static_cast<uint64_t>(writers[writer].value(ids.payloadDigest));
+                    digest += RandomStringGenerator::deriveSeed(writerDigest, {caseIndex, lockIndex, writer});
+                }
+                ++lockIndex;
+            }
+        }
+        return digest;
+    }
+
     /**
      * @brief Runs all added test cases and records their results.
      * @return Reference to the Benchmark object for chaining.
      *
-     * Each test case is executed for both `shared_mutex` and `standard mutex`, and the execution times are
+     * Each test case is executed for both `shared_mutex` and `standard mutex`, and the resulting metrics are
      * stored in the `results` vector as `Result` structures.
      */
     Benchmark& run() {
-        for (auto& testerPtr : testCases) {
-            auto& tester = *testerPtr;
+        for (size_t caseIndex = 0; caseIndex < testCases.size(); ++caseIndex) {
+            auto& tester = *testCases[caseIndex];
+            tester.seed = RandomStringGenerator::deriveSeed(seed, {caseIndex});
+            tester.pinThreads = pinThreads;
+            tester.readerPriority = readerPriority;
+            tester.writerPriority = writerPriority;
+            tester.measureOffCpu = !readerPriority.isDefault() || !writerPriority.isDefault();
+            tester.coreGroups = coreGroups;
+            tester.dataPlacement = dataPlacement;
+            tester.textPlacement = textPlacement;
+            tester.lockPlacement = lockPlacement;
+            tester.profiler = profiler;
+            tester.waitProfiler = waitProfiler;
             tester.testSharedMutex();
             tester.testStandardMutex();
+            tester.testNodeReplicated();
+            if (piLocks) {
+                tester.testPiMutex();
+                tester.testFutexPi();
+            }
+            if (parkingLocks) {
+                tester.testParkingMutex();
+                tester.testParkingShared();
+            }
+            if (leaseTime.count() > 0 && tester.readDominated()) {
+                tester.leaseTime = leaseTime;
+                tester.testLeaseLock();
+            }
 
             Result result;
-            result.times = std::move(tester.times); // Move 'times' to avoid copying
+            result.metrics = std::move(tester.metrics); // Move the metrics to avoid copying histograms
+            result.stats = std::move(tester.stats);
             result.numReaders = tester.numReaders;
             result.numWriters = tester.numWriters;
             result.numReads = tester.numReads;
@@ -334,15 +8550,21 @@ public:
      * @return Reference to the Benchmark object for chaining.
      *
      * Generates a dynamic-width table based on the contents of the `results` vector.
-     * Each column represents either a fixed attribute (e.g., readers, writers) or a dynamically
-     * obtained metric from the test cases (e.g., `Shared Mutex Time`).
+     * Each column represents either a fixed attribute (e.g., readers, writers) or a duration
+     * metric reported by any of the test cases (e.g., `Shared Mutex Time`), in registry order.
      */
     Benchmark& printBenchmarkTable() {
-        // Collect dynamic column headers from the first result's times map
+        // Collect the duration metrics any result reported, in the order they were registered
+        const MetricRegistry& registry = LockTester::definitions().resultRegistry;
+        std::vector<MetricId> metricIds;
         std::vector<std::string> columns;
-        if (!results.empty()) {
-            for (const auto& pair : results[0].times) {
-                columns.push_back(pair.first);
+        for (MetricId id = 0; id < registry.size(); ++id) {
+            if (registry.descriptor(id).kind != MetricKind::Duration) continue;
+            bool reported = std::any_of(results.begin(), results.end(),
+                                        [id](const Result& result) { return result.metrics.has(id); });
+            if (reported) {
+                metricIds.push_back(id);
+                columns.push_back(registry.descriptor(id).name);
             }
         }
 
@@ -353,12 +8575,11 @@ public:
 
         // Calculate dynamic widths for the time columns
         std::vector<int> column_widths;
-        for (const auto& col : columns) {
-            int max_len = static_cast<int>(col.length());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            int max_len = static_cast<int>(columns[i].length());
             for (const auto& result : results) {
-                auto it = result.times.find(col);
-                if (it != result.times.end()) {
-                    int data_len = static_cast<int>(std::to_string(it->second).length()) + 3; // value length + " ms"
+                if (result.metrics.has(metricIds[i])) {
+                    int data_len = static_cast<int>(formatMetric(result.metrics, metricIds[i]).length());
                     max_len = std::max(max_len, data_len);
                 }
             }
@@ -396,9 +8617,8 @@ public:
                     << " | " << std::setw(reads_width) << result.numReads
                     << " | " << std::setw(updates_width) << result.numUpdates;
             for (size_t i = 0; i < columns.size(); ++i) {
-                auto it = result.times.find(columns[i]);
-                if (it != result.times.end()) {
-                    std::cout << " | " << std::setfill(' ') << std::setw(column_widths[i]) << (std::to_string(it->second) + " ms");
+                if (result.metrics.has(metricIds[i])) {
+                    std::cout << " | " << std::setfill(' ') << std::setw(column_widths[i]) << formatMetric(result.metrics, metricIds[i]);
                 } else {
                     std::cout << " | " << std::setfill(' ') << std::setw(column_widths[i]) << "N/A";
                 }
@@ -407,6 +8627,393 @@ public:
             printSeparator();
         }        
 
+        // Replicas are chosen from the CPU a thread starts on, which only sticks when threads are pinned
+        MetricId replicated;
+        if (!pinThreads && LockTester::definitions().resultRegistry.find("Node Replicated Time", replicated) &&
+            std::any_of(results.begin(), results.end(), [&](const Result& result) { return result.metrics.has(replicated); }))
+            std::cout << "Node Replicated threads use the replica of the CPU they started on; without --pin they may "
+                         "migrate away from it." << std::endl;
+
+        return *this;
+    }
+
+    /**
+     * @brief Prints how long readers waited while writers held the lock, to expose priority inversion.
+     * @return Reference to the Benchmark object for chaining.
+     *
+     * For every test case and lock the table shows the readers' lock wait, the writers' hold time,
+     * the part of the hold time writers spent preempted (off the CPU) and how many critical sections
+     * were spent mostly preempted. When low-priority writers are preempted while holding the lock,
+     * reader wait tails grow with the writers' off-CPU time although readers have the CPU to run.
+     */
+    Benchmark& printPriorityReport() {
+        const LockTester::Definitions& ids = LockTester::definitions();
+        std::cout << "\nPriority inversion (readers " << readerPriority.describe() << ", writers "
+                  << writerPriority.describe() << "):" << std::endl;
+        TextTable table({"Case (R/W/Reads/Updates)", "Lock", "Reader wait p50", "Reader wait p99", "Reader wait max",
+                         "Writer hold p50", "Writer hold p99", "Hold off-CPU p99", "Preempted holds"});
+        auto ns = LatencyHistogram::format;
+        for (const auto& result : results) {
+            // Locks in definition order, as in the main table
+            for (const std::string& lockName : LockTester::lockNames()) {
+                const LockTester::LockMetricIds& lockIds = ids.locks.at(lockName);
+                if (!result.metrics.has(lockIds.time)) continue;
+                const LatencyHistogram& wait = result.metrics.histogram(lockIds.readerWait);
+                const LatencyHistogram& hold = result.metrics.histogram(lockIds.writerHold);
+                const LatencyHistogram& offCpu = result.metrics.histogram(lockIds.writerOffCpu);
+                uint64_t preempted = static_cast<uint64_t>(result.metrics.value(lockIds.preemptedHolds));
+                table.addRow({caseKeyOf(result), lockName, ns(wait.percentile(0.5)), ns(wait.percentile(0.99)),
+                              ns(wait.max()), ns(hold.percentile(0.5)), ns(hold.percentile(0.99)),
+                              ns(offCpu.percentile(0.99)),
+                              std::to_string(preempted) + " / " + std::to_string(hold.count())});
+            }
+        }
+        table.print();
+        return *this;
+    }
+
+    /**
+     * @brief Prints what priority inheritance costs writers and saves readers, against `std::mutex`.
+     * @return Reference to the Benchmark object for chaining.
+     *
+     * First the uncontended lock and unlock of each mutex is timed on this thread. Then, for
+     * every test case, writer waits show the cost of the PI slow path in the writer loops,
+     * where the kernel queues the waiter and hands the lock over on unlock, and reader wait
+     * tails show what boosting a preempted writer saves the readers. Boosting only happens for
+     * real-time waiters (`--reader-sched fifo:N`); with normal readers the PI locks pay the
+     * slow path without a benefit.
+     */
+    Benchmark& printPiReport() {
+        std::cout << "\nUncontended lock + unlock:";
+        auto timeLock = [](auto& mutex) {
+            constexpr int kRounds = 1000000;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < kRounds; ++i) {
+                mutex.lock();
+                mutex.unlock();
+            }
+            auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+            return static_cast<uint64_t>(elapsed.count() / kRounds);
+        };
+        std::mutex standard;
+        PiMutex pthreadPi;
+        FutexPiMutex futexPi;
+        std::cout << " Standard Mutex " << LatencyHistogram::format(timeLock(standard)) << ", PI Mutex "
+                  << LatencyHistogram::format(timeLock(pthreadPi)) << ", Futex PI " << LatencyHistogram::format(timeLock(futexPi))
+                  << std::endl;
+
+        const LockTester::Definitions& ids = LockTester::definitions();
+        std::cout << "Priority inheritance (readers " << readerPriority.describe() << ", writers " << writerPriority.describe()
+                  << "):" << std::endl;
+        TextTable table({"Case (R/W/Reads/Updates)", "Lock", "Time", "Writer wait p50", "Writer wait p99", "Reader wait p99",
+                         "Reader wait max", "Reader p99 vs std::mutex"});
+        auto ns = LatencyHistogram::format;
+        for (const auto& result : results) {
+            const LockTester::LockMetricIds& standardIds = ids.locks.at("Standard Mutex");
+            if (!result.metrics.has(standardIds.time)) continue;
+            double baseline = static_cast<double>(result.metrics.histogram(standardIds.readerWait).percentile(0.99));
+            for (const char* lockName : {"Standard Mutex", "PI Mutex", "Futex PI"}) {
+                const LockTester::LockMetricIds& lockIds = ids.locks.at(lockName);
+                if (!result.metrics.has(lockIds.time)) continue;
+                LatencyHistogram writerWait;
+                for (const MetricSet& writer : result.stats.at(lockName).writers) writerWait.merge(writer.histogram(ids.waitTime));
+                const LatencyHistogram& readerWait = result.metrics.histogram(lockIds.readerWait);
+                std::string change = "-";
+                if (lockIds.time != standardIds.time && baseline > 0) {
+                    std::ostringstream out;
+                    out << std::showpos << std::fixed << std::setprecision(1) << (readerWait.percentile(0.99) / baseline - 1) * 100 << "%";
+                    change = out.str();
+                }
+                table.addRow({caseKeyOf(result), lockName, formatMetric(result.metrics, lockIds.time), ns(writerWait.percentile(0.5)),
+                              ns(writerWait.percentile(0.99)), ns(readerWait.percentile(0.99)), ns(readerWait.max()), change});
+            }
+        }
+        table.print();
+        return *this;
+    }
+
+    /**
+     * @brief Prints the parking-lot mutexes next to the standard locks they replace.
+     * @return Reference to the Benchmark object for chaining.
+     *
+     * `Parking Mutex` is compared with `std::mutex` and `Parking Shared` with
+     * `std::shared_mutex`, by time, reader wait tail and writer latency tail.
+     */
+    Benchmark& printParkingReport() {
+        const LockTester::Definitions& ids = LockTester::definitions();
+        std::cout << "\nParking-lot locks (" << sizeof(ParkingMutex) << " B and " << sizeof(ParkingSharedMutex)
+                  << " B) vs std::mutex (" << sizeof(std::mutex) << " B) and std::shared_mutex (" << sizeof(std::shared_mutex)
+                  << " B), " << ParkingLot::parkCount() << " parks in all:" << std::endl;
+        TextTable table({"Case (R/W/Reads/Updates)", "Lock", "Time", "vs standard", "Reader wait p99", "Writer p99"});
+        auto ns = LatencyHistogram::format;
+        for (const auto& result : results) {
+            for (const auto& pair : {std::make_pair("Standard Mutex", "Parking Mutex"), std::make_pair("Shared Mutex", "Parking Shared")}) {
+                const LockTester::LockMetricIds& baseIds = ids.locks.at(pair.first);
+                const LockTester::LockMetricIds& lockIds = ids.locks.at(pair.second);
+                if (!result.metrics.has(lockIds.time) || !result.metrics.has(baseIds.time)) continue;
+                double baseline = result.metrics.value(baseIds.time);
+                std::ostringstream change;
+                change << std::showpos << std::fixed << std::setprecision(1)
+                       << (baseline > 0 ? (result.metrics.value(lockIds.time) / baseline - 1) * 100 : 0.0) << "%";
+                table.addRow({caseKeyOf(result), pair.second, formatMetric(result.metrics, lockIds.time), change.str(),
+                              ns(result.metrics.histogram(lockIds.readerWait).percentile(0.99)),
+                              ns(result.metrics.histogram(lockIds.writerLatency).percentile(0.99))});
+            }
+        }
+        table.print();
+        return *this;
+    }
+
+    /**
+     * @brief Prints how the lease lock compares with `std::shared_mutex` in the read-dominated cases.
+     * @return Reference to the Benchmark object for chaining.
+     *
+     * Readers of the lease lock skip the shared write and fence of every read as long as their
+     * lease lasts, so their latency shows what that saves; writers wait for every lease to be
+     * released or to end, so their latency shows what it costs. Renewals per 1000 reads show
+     * how often readers had to take a new lease, mostly after a writer.
+     */
+    Benchmark& printLeaseReport() {
+        const LockTester::Definitions& ids = LockTester::definitions();
+        std::cout << "\nLease lock (" << leaseTime.count() << " us leases, " << (TscClock::usesTsc() ? "TSC" : "steady_clock")
+                  << " clock) vs Shared Mutex:" << std::endl;
+        TextTable table({"Case (R/W/Reads/Updates)", "Lock", "Time", "Throughput", "Reader p50", "Reader p99", "Writer p50",
+                         "Writer p99", "Renewals per 1000 reads"});
+        auto ns = LatencyHistogram::format;
+        for (const auto& result : results) {
+            if (!result.metrics.has(ids.locks.at("Lease Lock").time)) continue;
+            for (const char* lockName : {"Shared Mutex", "Lease Lock"}) {
+                const LockTester::LockMetricIds& lockIds = ids.locks.at(lockName);
+                const LatencyHistogram& readers = result.metrics.histogram(lockIds.readerLatency);
+                const LatencyHistogram& writers = result.metrics.histogram(lockIds.writerLatency);
+                std::string renewals = "-";
+                if (lockIds.time == ids.locks.at("Lease Lock").time) {
+                    double leases = 0, reads = 0;
+                    for (const MetricSet& reader : result.stats.at(lockName).readers) {
+                        leases += reader.value(ids.leaseRenewals);
+                        reads += reader.value(ids.operations);
+                    }
+                    std::ostringstream out;
+                    out << std::fixed << std::setprecision(2) << (reads > 0 ? leases * 1000 / reads : 0.0);
+                    renewals = out.str();
+                }
+                table.addRow({caseKeyOf(result), lockName, formatMetric(result.metrics, lockIds.time),
+                              ScalingStudy::formatRate(result.metrics.value(lockIds.throughput)), ns(readers.percentile(0.5)),
+                              ns(readers.percentile(0.99)), ns(writers.percentile(0.5)), ns(writers.percentile(0.99)), renewals});
+            }
+        }
+        table.print();
+        return *this;
+    }
+
+    /**
+     * @brief Prints where the shared objects were placed and how readers on other nodes fared.
+     * @return Reference to the Benchmark object for chaining.
+     *
+     * A reader is remote when the node of its CPU differs from the node of the payload, or of
+     * SharedData when the text buffer is not placed and moves with every write. The penalty
+     * compares the mean operation latency of remote and local readers.
+     */
+    Benchmark& printPlacementReport() {
+        const LockTester::Definitions& ids = LockTester::definitions();
+        std::cout << "\nMemory placement (data " << dataPlacement.describe() << ", text " << textPlacement.describe()
+                  << ", locks " << lockPlacement.describe() << "):" << std::endl;
+        TextTable table({"Case (R/W/Reads/Updates)", "Lock", "Data node", "Text node", "Lock node", "Local readers",
+                         "Remote readers", "Remote penalty"});
+        auto node = [](double value) { return value < 0 ? std::string("-") : std::to_string(static_cast<int>(value)); };
+        for (const auto& result : results) {
+            for (const auto& lock : ids.locks) {
+                const LockTester::LockMetricIds& lockIds = lock.second;
+                if (!result.metrics.has(lockIds.dataNode)) continue;
+                double textNode = result.metrics.value(lockIds.textNode);
+                double payloadNode = textNode >= 0 ? textNode : result.metrics.value(lockIds.dataNode);
+                LatencyHistogram local, remote;
+                for (const MetricSet& reader : result.stats.at(lock.first).readers)
+                    (reader.value(ids.node) == payloadNode ? local : remote).merge(reader.histogram(ids.latency));
+                auto describe = [](const LatencyHistogram& latency) {
+                    return latency.count() ? std::to_string(latency.count()) + " ops, " + LatencyHistogram::format(static_cast<uint64_t>(latency.mean()))
+                                           : std::string("-");
+                };
+                std::string penalty = "-";
+                if (local.count() && remote.count()) {
+                    std::ostringstream out;
+                    out << std::showpos << std::fixed << std::setprecision(1) << (remote.mean() / local.mean() - 1) * 100 << "%";
+                    penalty = out.str();
+                }
+                table.addRow({caseKeyOf(result), lock.first, node(result.metrics.value(lockIds.dataNode)), node(textNode),
+                              node(result.metrics.value(lockIds.lockNode)), describe(local), describe(remote), penalty});
+            }
+        }
+        table.print();
+        return *this;
+    }
+
+    /**
+     * @brief Prints the waiting-reader comparison of a tester that ran both notification tests.
+     * @param tester A tester after `testConditionVariableWait()` and `testEventCountWait()`.
+     *
+     * CPU per update divides the CPU time of all readers by the versions they observed, which
+     * includes spurious wake-ups and the lock reacquisition after waking.
+     */
+    static void printWaitComparison(const LockTester& tester) {
+        const LockTester::Definitions& ids = LockTester::definitions();
+        std::cout << "Readers waiting for new versions (" << tester.numReaders << " readers, " << tester.numWriters
+                  << " writers x " << tester.numUpdates << " updates every " << tester.updateInterval.count() << " us):" << std::endl;
+        TextTable table({"Notification", "Observed updates", "Wake p50", "Wake p99", "Wake max", "Reader CPU / update",
+                         "Notify p50", "Notify p99", "Skipped notifies"});
+        auto ns = LatencyHistogram::format;
+        for (const char* name : {"Condition Variable", "EventCount"}) {
+            auto lock = tester.stats.find(name);
+            if (lock == tester.stats.end()) continue;
+            MetricSet readers(ids.threadRegistry), writers(ids.threadRegistry);
+            for (const auto& reader : lock->second.readers) readers.merge(reader);
+            for (const auto& writer : lock->second.writers) writers.merge(writer);
+            const LatencyHistogram& wake = readers.histogram(ids.wakeLatency);
+            const LatencyHistogram& notify = writers.histogram(ids.notifyTime);
+            double observed = readers.value(ids.operations);
+            uint64_t cpuPerUpdate = observed > 0 ? static_cast<uint64_t>(readers.value(ids.cpuTime) / observed) : 0;
+            table.addRow({name, std::to_string(static_cast<uint64_t>(observed)), ns(wake.percentile(0.5)), ns(wake.percentile(0.99)),
+                          ns(wake.max()), ns(cpuPerUpdate), ns(notify.percentile(0.5)), ns(notify.percentile(0.99)),
+                          std::to_string(static_cast<uint64_t>(writers.value(ids.skippedNotifies))) + " / " +
+                              std::to_string(notify.count())});
+        }
+        table.print();
+    }
+
+    /**
+     * @brief Appends the results of the last `run()` to a results history file.
+     * @param history The history store to append to.
+     * @param attributes Run metadata (timestamp, revision, host, configuration).
+     * @return Reference to the Benchmark object for chaining.
+     *
+     * Each scalar metric of each test case becomes one sample keyed by the test case configuration,
+     * and each histogram contributes its p50 and p99, so `ResultsHistory::printTrendReport()` can
+     * follow them across runs.
+     */
+    Benchmark& saveHistory(const ResultsHistory& history, const ResultsHistory::Attributes& attributes) {
+        const MetricRegistry& registry = LockTester::definitions().resultRegistry;
+        std::vector<ResultsHistory::Sample> samples;
+        for (const auto& result : results) {
+            std::string caseKey = caseKeyOf(result);
+            for (MetricId id = 0; id < registry.size(); ++id) {
+                if (!result.metrics.has(id)) continue;
+                const MetricDescriptor& descriptor = registry.descriptor(id);
+                if (descriptor.kind == MetricKind::Histogram) {
+                    const LatencyHistogram& histogram = result.metrics.histogram(id);
+                    samples.push_back({caseKey, descriptor.name + " p50", static_cast<double>(histogram.percentile(0.5)), "ns"});
+                    samples.push_back({caseKey, descriptor.name + " p99", static_cast<double>(histogram.percentile(0.99)), "ns"});
+                } else {
+                    samples.push_back({caseKey, descriptor.name, result.metrics.value(id), descriptor.unit});
+                }
+            }
+        }
+        std::string runId = history.append(attributes, samples);
+        std::cout << "Results appended to history as run " << runId << std::endl;
+        return *this;
+    }
+
+    /**
+     * @brief Writes the results of the last `run()` as a self-contained HTML report.
+     * @param path Output file path.
+     * @param metadata Key/value pairs shown in the report header.
+     * @return Reference to the Benchmark object for chaining.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    Benchmark& writeHtmlReport(const std::string& path, const ResultsHistory::Attributes& metadata) {
+        HtmlReport report("Lock benchmark");
+        for (const auto& result : results) {
+            HtmlReport::CaseResult testCase;
+            testCase.label = std::to_string(result.numReaders) + "R/" + std::to_string(result.numWriters) + "W "
+                + std::to_string(result.numReads) + " reads x " + std::to_string(result.numUpdates) + " updates";
+            testCase.threads = result.numReaders + result.numWriters;
+            const LockTester::Definitions& ids = LockTester::definitions();
+            for (const auto& lock : result.stats) {
+                const LockTester::LockMetricIds& lockIds = ids.locks.at(lock.first);
+                HtmlReport::LockResult lockResult{lock.first,
+                                                  static_cast<long long>(result.metrics.value(lockIds.time)),
+                                                  result.metrics.value(lockIds.throughput),
+                                                  &result.metrics.histogram(lockIds.readerLatency),
+                                                  &result.metrics.histogram(lockIds.writerLatency),
+                                                  {},
+                                                  {}};
+                for (const auto& reader : lock.second.readers)
+                    lockResult.readerThroughputs.push_back(LockTester::threadThroughput(reader));
+                for (const auto& writer : lock.second.writers)
+                    lockResult.writerThroughputs.push_back(LockTester::threadThroughput(writer));
+                testCase.locks.push_back(std::move(lockResult));
+            }
+            report.addCase(std::move(testCase));
+        }
+        report.write(path, metadata);
+        std::cout << "HTML report written to " << path << std::endl;
+        return *this;
+    }
+
+    /**
+     * @brief Writes the results of the last `run()` as a JSON document.
+     * @param path Output file path.
+     * @param metadata Key/value pairs stored under `metadata`.
+     * @return Reference to the Benchmark object for chaining.
+     * @throws std::runtime_error If the file cannot be written.
+     *
+     * Every metric of the result registry is written with its kind and unit; histograms are
+     * summarized by count, mean, p50, p90, p99, p99.9 and max. The recorded schedule (start order
+     * and CPU of every thread) follows under `threads`.
+     */
+    Benchmark& writeJsonReport(const std::string& path, const ResultsHistory::Attributes& metadata) {
+        std::ofstream out(path);
+        if (!out) throw std::runtime_error("cannot write report " + path);
+        out << std::setprecision(12);
+
+        static const char* kindNames[] = {"counter", "gauge", "duration", "histogram"};
+        const MetricRegistry& registry = LockTester::definitions().resultRegistry;
+        out << "{\n  \"metadata\": {";
+        for (size_t i = 0; i < metadata.size(); ++i)
+            out << (i ? ",\n" : "\n") << "    " << jsonString(metadata[i].first) << ": " << jsonString(metadata[i].second);
+        out << "\n  },\n  \"results\": [";
+        for (size_t r = 0; r < results.size(); ++r) {
+            const Result& result = results[r];
+            out << (r ? ",\n" : "\n") << "    {\"readers\": " << result.numReaders << ", \"writers\": " << result.numWriters
+                << ", \"reads\": " << result.numReads << ", \"updates\": " << result.numUpdates << ", \"metrics\": {";
+            bool first = true;
+            for (MetricId id = 0; id < registry.size(); ++id) {
+                if (!result.metrics.has(id)) continue;
+                const MetricDescriptor& descriptor = registry.descriptor(id);
+                out << (first ? "\n" : ",\n") << "      " << jsonString(descriptor.name) << ": {\"kind\": \""
+                    << kindNames[static_cast<int>(descriptor.kind)] << "\", \"unit\": " << jsonString(descriptor.unit);
+                first = false;
+                if (descriptor.kind == MetricKind::Histogram) {
+                    const LatencyHistogram& histogram = result.metrics.histogram(id);
+                    out << ", \"count\": " << histogram.count() << ", \"mean\": " << histogram.mean()
+                        << ", \"p50\": " << histogram.percentile(0.5) << ", \"p90\": " << histogram.percentile(0.9)
+                        << ", \"p99\": " << histogram.percentile(0.99) << ", \"p999\": " << histogram.percentile(0.999)
+                        << ", \"max\": " << histogram.max() << "}";
+                } else {
+                    out << ", \"value\": " << result.metrics.value(id) << "}";
+                }
+            }
+            out << "\n    }, \"threads\": {";
+            const LockTester::Definitions& ids = LockTester::definitions();
+            bool firstLock = true;
+            for (const auto& lock : result.stats) {
+                out << (firstLock ? "\n" : ",\n") << "      " << jsonString(lock.first) << ": [";
+                firstLock = false;
+                bool firstThread = true;
+                for (bool writers : {false, true}) {
+                    const auto& threads = writers ? lock.second.writers : lock.second.readers;
+                    for (size_t i = 0; i < threads.size(); ++i) {
+                        out << (firstThread ? "" : ", ") << "{\"role\": \"" << (writers ? "writer" : "reader")
+                            << "\", \"index\": " << i << ", \"start\": " << threads[i].value(ids.startOrder)
+                            << ", \"cpu\": " << threads[i].value(ids.cpu) << "}";
+                        firstThread = false;
+                    }
+                }
+                out << "]";
+            }
+            out << "\n    }}";
+        }
+        out << "\n  ]\n}\n";
+        std::cout << "JSON report written to " << path << std::endl;
         return *this;
     }
 
@@ -418,21 +9025,710 @@ private:
      * Holds the timing data for different mutex types as well as the configuration of the test case.
      */
     struct Result {
-        std::map<std::string, long long> times; /**< Execution times for various mutexes (e.g., shared vs standard). */
+        MetricSet metrics; /**< Result metrics of all mutexes (times, throughput, latency histograms). */
+        std::map<std::string, LockStats> stats; /**< Per-thread metrics for each mutex. */
         int numReaders; /**< Number of readers used in the test case. */
         int numWriters; /**< Number of writers used in the test case. */
         int numReads; /**< Number of read operations per reader in the test case. */
         int numUpdates; /**< Number of update operations per writer in the test case. */
     };
 
+    /**
+     * @brief Formats a scalar metric value with its unit, without a fractional part for whole numbers.
+     * @param metrics The set holding the value.
+     * @param id The metric.
+     * @return The formatted value, e.g. `223 ms`.
+     */
+    static std::string formatMetric(const MetricSet& metrics, MetricId id) {
+        double value = metrics.value(id);
+        std::ostringstream out;
+        if (value == std::floor(value)) out << static_cast<long long>(value);
+        else out << std::fixed << std::setprecision(2) << value;
+        return out.str() + " " + metrics.registry()->descriptor(id).unit;
+    }
+
+
+    /// @return The configuration of a test case as `readers/writers/reads/updates`.
+    static std::string caseKeyOf(const Result& result) {
+        return std::to_string(result.numReaders) + "/" + std::to_string(result.numWriters) + "/"
+            + std::to_string(result.numReads) + "/" + std::to_string(result.numUpdates);
+    }
+
+    /// @return The text as a quoted JSON string.
+    static std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') quoted += std::string("\\") + c;
+            else if (c == '\n') quoted += "\\n";
+            else if (static_cast<unsigned char>(c) < 0x20) quoted += ' ';
+            else quoted += c;
+        }
+        return quoted + "\"";
+    }
+
     std::vector<std::unique_ptr<LockTester>> testCases; /**< Stores all test cases to be run. */
     std::vector<Result> results; /**< Holds results from each test case after it is run. */
+    uint64_t seed = 0; /**< Global seed from which per-case and per-thread seeds are derived. */
+    bool pinThreads = false; /**< Whether threads are pinned to CPUs deterministically. */
+    ThreadPriority readerPriority; /**< Scheduling class and nice value of reader threads. */
+    ThreadPriority writerPriority; /**< Scheduling class and nice value of writer threads. */
+    int coreGroups = 2; /**< Replicas of node replication on single-node machines. */
+    MemoryPlacement dataPlacement; /**< Placement of SharedData. */
+    MemoryPlacement textPlacement; /**< Placement of SharedData's text buffer. */
+    MemoryPlacement lockPlacement; /**< Placement of the lock words. */
+    bool piLocks = false; /**< Whether the priority-inheritance mutexes run as well. */
+    std::chrono::microseconds leaseTime{0}; /**< Lease length of the lease lock in read-dominated cases; 0 leaves it out. */
+    bool parkingLocks = false; /**< Whether the parking-lot mutexes run as well. */
+    ProfilerControl* profiler = nullptr; /**< External profiler enabled during measured phases, or null. */
+    WaitProfiler* waitProfiler = nullptr; /**< Collector of the slowest waits' stacks, or null. */
 };
 
-int main() {
-    // Create a Benchmark instance and add various test cases to evaluate performance
+/**
+ * @struct Options
+ * @brief Command-line options of the benchmark program.
+ *
+ * Usage: `main [run|report|env|soak|notify|stripes|multiget|eventloop|replicas|percore|interfere|manylocks|kvserver|futexhash|copy|simulate|replay RUN|help] [options]`; see `printUsage()` for the option list.
+ * Without a command the benchmark is run, its table printed and its results appended to the history file.
+ */
+struct Options {
+    std::string command = "run";                   /**< Command: `run`, `report`, `env`, `soak`, `notify`, `stripes`, `multiget`, `eventloop`, `replicas`, `percore`, `interfere`, `manylocks`, `kvserver`, `futexhash`, `copy`, `simulate`, `replay` or `help`. */
+    std::string historyPath = "bench_history.tsv"; /**< Results history file used by `run` and `report`. */
+    bool recordHistory = true;                     /**< Whether `run` appends its results to the history file. */
+    double stepThreshold = 0.10;                   /**< Relative change flagged as a step by `report`. */
+    std::string htmlPath;                          /**< If set, `run` also writes an HTML report to this file. */
+    std::string jsonPath;                          /**< If set, `run` also writes a JSON report to this file. */
+    int readers = 50;                              /**< Reader threads of the `soak` workload. */
+    int writers = 2;                               /**< Writer threads of the `soak` workload. */
+    int updates = 1000;                            /**< Updates per writer of the `notify` workload. */
+    size_t keys = 100000;                          /**< Entries of the `stripes`, `multiget` and `kvserver` store. */
+    double zipfTheta = 0.99;                       /**< Zipfian skew of the `stripes` and `multiget` workloads. */
+    int phases = 4;                                /**< Hot-set positions of the `stripes` workload. */
+    std::chrono::seconds phaseTime{2};             /**< Duration of each `stripes` phase. */
+    double splitThreshold = 0.01;                  /**< Contended share above which an adaptive stripe splits. */
+    std::vector<int> batchSizes = {10, 20, 50};    /**< Keys per request that `multiget` compares. */
+    int requests = 2000;                           /**< Requests per reader and batch size of `multiget`. */
+    int replicas = 4;                              /**< Copies of SharedData in the `replicas` workload. */
+    int reads = 20000;                             /**< Reads per reader of the `replicas` workload. */
+    int loops = 2;                                 /**< Event-loop threads of the `eventloop` workload. */
+    int inFlight = 32;                             /**< Requests each event loop or `percore` core keeps in flight. */
+    std::chrono::microseconds ioTime{50};          /**< Mean simulated I/O duration of `eventloop`. */
+    std::chrono::seconds loopTime{2};              /**< Run time of each `eventloop` mode. */
+    int shards = 0;                                /**< Cores of `percore`; 0 uses every allowed CPU. */
+    int coreOps = 20000;                           /**< Operations per core of `percore`. */
+    double writePercent = 10;                      /**< Share of updates in `percore` and `kvserver`, in percent. */
+    int instances = 2;                             /**< Testers `interfere` runs at once. */
+    bool disjointCpus = false;                     /**< Give each `interfere` instance its own CPUs. */
+    std::vector<int> testCases;                    /**< 1-based test cases `interfere` runs; empty runs all. */
+    std::string lock = "shared";                   /**< Lock of the `soak` workload: `shared` or `standard`. */
+    std::chrono::seconds duration{3600};           /**< Total run time of `soak`. */
+    std::chrono::seconds interval{10};             /**< Sampling interval of `soak`. */
+    std::vector<int> simulatedCores = {256, 512, 1024}; /**< Core counts `simulate` predicts. */
+    int simulatedOps = 200;                        /**< Upper bound of operations per thread in `simulate`. */
+    double transferNs = 0;                         /**< Cache-line transfer latency for `simulate`; 0 measures it. */
+    uint64_t seed = 0;                             /**< Global seed; random unless `--seed` is given. */
+    bool seedSet = false;                          /**< Whether `--seed` was given. */
+    bool pin = false;                              /**< Pin threads to CPUs deterministically. */
+    int coreGroups = 2;                            /**< Replicas of node replication on single-node machines. */
+    MemoryPlacement dataPlacement;                 /**< Placement of SharedData. */
+    MemoryPlacement textPlacement;                 /**< Placement of the text buffer. */
+    MemoryPlacement lockPlacement;                 /**< Placement of the lock words. */
+    bool piLocks = false;                          /**< Also run the priority-inheritance mutexes. */
+    bool parkingLocks = false;                     /**< Also run the parking-lot mutexes. */
+    size_t objects = 2000000;                      /**< Objects, each with a lock, of `manylocks`. */
+    int threads = 4;                               /**< Threads of `manylocks`, probe threads of `futexhash`. */
+    int lockOps = 1000000;                         /**< Operations per thread of `manylocks`. */
+    int workers = 2;                               /**< Server threads of `kvserver`. */
+    int clients = 16;                              /**< Client threads and connections of `kvserver`. */
+    bool tcp = false;                              /**< Run `kvserver` over loopback TCP instead of a Unix domain socket. */
+    std::chrono::seconds serverTime{2};            /**< Run time of each `kvserver` lock. */
+    std::vector<size_t> futexWords = {10, 100, 1000, 10000, 100000, 1000000}; /**< Parked word counts of `futexhash`. */
+    int futexOps = 50000;                          /**< Probe operations per thread of `futexhash`. */
+    int wakes = 1000;                              /**< Wakes measured per word count of `futexhash`. */
+    std::chrono::microseconds leaseTime{0};        /**< Lease length of the lease lock in read-dominated cases; 0 is off. */
+    std::string readCopy;                          /**< Copy kernel of readers: `memcpy`, `sse2`, `avx` or `stream`; empty copies std::strings. */
+    std::string writeCopy;                         /**< Copy kernel writers install payloads with; empty assigns std::strings. */
+    size_t copyMaxSize = 0;                        /**< Largest payload of `copy`; 0 picks it from the cache size. */
+    std::string perfControl;                       /**< `CTL[,ACK]` FIFOs of an external perf to enable per measured phase. */
+    std::chrono::microseconds stackThreshold{0};   /**< Capture the stack of every lock wait this long; 0 is off. */
+    size_t stackTop = 0;                           /**< Capture the stacks of the N longest lock waits. */
+    ThreadPriority readerPriority;                 /**< Scheduling class and nice value of readers. */
+    ThreadPriority writerPriority;                 /**< Scheduling class and nice value of writers. */
+    std::string replayRunId;                       /**< Run to reproduce with `replay`. */
+    std::string commandLine;                       /**< The full command line, quoted per argument, recorded with each run. */
+
+    /// @return CPU numbers as a comma-separated list, e.g. `0,1,2,3`.
+    static std::string formatCpus(const std::vector<int>& cpus) {
+        std::string list;
+        for (int cpu : cpus) list += (list.empty() ? "" : ",") + std::to_string(cpu);
+        return list;
+    }
+
+    /**
+     * @brief Quotes one argument so that `splitArguments()` gives it back unchanged.
+     * @param argument The argument.
+     * @return The argument as is if it needs no quoting, else in double quotes with `\\`, `\"`,
+     *         `\t`, `\n` and `\r` escaped.
+     */
+    static std::string quoteArgument(const std::string& argument) {
+        bool plain = !argument.empty() && argument.find_first_of(" \t\n\r\"'\\") == std::string::npos;
+        if (plain) return argument;
+        std::string quoted = "\"";
+        for (char c : argument) {
+            if (c == '\\' || c == '"') quoted += '\\', quoted += c;
+            else if (c == '\t') quoted += "\\t";
+            else if (c == '\n') quoted += "\\n";
+            else if (c == '\r') quoted += "\\r";
+            else quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    /**
+     * @brief Splits a command line written by `quoteArgument()` back into its arguments.
+     * @param line The command line.
+     * @return The arguments; unquoted words split on whitespace as before quoting existed.
+     */
+    static std::vector<std::string> splitArguments(const std::string& line) {
+        std::vector<std::string> arguments;
+        size_t i = 0;
+        while (i < line.size()) {
+            if (std::isspace(static_cast<unsigned char>(line[i]))) {
+                ++i;
+                continue;
+            }
+            std::string argument;
+            if (line[i] == '"') {
+                for (++i; i < line.size() && line[i] != '"'; ++i) {
+                    if (line[i] != '\\' || i + 1 == line.size()) {
+                        argument += line[i];
+                        continue;
+                    }
+                    char escaped = line[++i];
+                    argument += escaped == 't' ? '\t' : escaped == 'n' ? '\n' : escaped == 'r' ? '\r' : escaped;
+                }
+                ++i;
+            } else {
+                while (i < line.size() && !std::isspace(static_cast<unsigned char>(line[i]))) argument += line[i++];
+            }
+            arguments.push_back(argument);
+        }
+        return arguments;
+    }
+
+    /**
+     * @brief Parses the command line.
+     * @param argc Argument count as passed to `main()`.
+     * @param argv Argument vector as passed to `main()`.
+     * @return The parsed options.
+     * @throws std::invalid_argument On unknown options, missing or malformed values.
+     */
+    static Options parse(int argc, char* argv[]) {
+        Options options;
+        for (int i = 0; i < argc; ++i) {
+            if (i) options.commandLine += " ";
+            options.commandLine += quoteArgument(argv[i]);
+        }
+
+        auto value = [&](int& i) -> std::string {
+            if (i + 1 >= argc) throw std::invalid_argument(std::string("missing value for ") + argv[i]);
+            return argv[++i];
+        };
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "run" || arg == "report" || arg == "env" || arg == "soak" || arg == "simulate" || arg == "notify" || arg == "stripes" || arg == "multiget" || arg == "eventloop" || arg == "replicas" || arg == "percore" || arg == "interfere" || arg == "manylocks" || arg == "kvserver" || arg == "futexhash" || arg == "copy" || arg == "help") {
+                options.command = arg;
+            } else if (arg == "replay") {
+                options.command = arg;
+                options.replayRunId = value(i);
+            } else if (arg == "--seed") {
+                options.seed = std::stoull(value(i));
+                options.seedSet = true;
+            } else if (arg == "--pin") {
+                options.pin = true;
+            } else if (arg == "--place") {
+                options.dataPlacement = options.textPlacement = options.lockPlacement = MemoryPlacement::parse(value(i));
+            } else if (arg == "--place-data") {
+                options.dataPlacement = MemoryPlacement::parse(value(i));
+            } else if (arg == "--place-text") {
+                options.textPlacement = MemoryPlacement::parse(value(i));
+            } else if (arg == "--place-locks") {
+                options.lockPlacement = MemoryPlacement::parse(value(i));
+            } else if (arg == "--core-groups") {
+                options.coreGroups = std::stoi(value(i));
+                if (options.coreGroups <= 0) throw std::invalid_argument("--core-groups must be positive");
+            } else if (arg == "--pi") {
+                options.piLocks = true;
+            } else if (arg == "--parking") {
+                options.parkingLocks = true;
+            } else if (arg == "--objects") {
+                options.objects = std::stoull(value(i));
+                if (options.objects == 0) throw std::invalid_argument("--objects must be positive");
+            } else if (arg == "--threads") {
+                options.threads = std::stoi(value(i));
+                if (options.threads <= 0) throw std::invalid_argument("--threads must be positive");
+            } else if (arg == "--lock-ops") {
+                options.lockOps = std::stoi(value(i));
+                if (options.lockOps <= 0) throw std::invalid_argument("--lock-ops must be positive");
+            } else if (arg == "--workers") {
+                options.workers = std::stoi(value(i));
+                if (options.workers <= 0) throw std::invalid_argument("--workers must be positive");
+            } else if (arg == "--clients") {
+                options.clients = std::stoi(value(i));
+                if (options.clients <= 0) throw std::invalid_argument("--clients must be positive");
+            } else if (arg == "--tcp") {
+                options.tcp = true;
+            } else if (arg == "--server-time") {
+                options.serverTime = parseDuration(value(i));
+            } else if (arg == "--words") {
+                options.futexWords.clear();
+                std::istringstream list(value(i));
+                for (std::string count; std::getline(list, count, ',');) {
+                    if (std::stoull(count) == 0) throw std::invalid_argument("invalid word count " + count);
+                    options.futexWords.push_back(std::stoull(count));
+                }
+            } else if (arg == "--futex-ops") {
+                options.futexOps = std::stoi(value(i));
+                if (options.futexOps <= 0) throw std::invalid_argument("--futex-ops must be positive");
+            } else if (arg == "--wakes") {
+                options.wakes = std::stoi(value(i));
+                if (options.wakes <= 0) throw std::invalid_argument("--wakes must be positive");
+            } else if (arg == "--lease") {
+                options.leaseTime = std::chrono::microseconds(std::stoll(value(i)));
+                if (options.leaseTime.count() <= 0) throw std::invalid_argument("--lease must be positive");
+            } else if (arg == "--perf-ctl") {
+                options.perfControl = value(i);
+            } else if (arg == "--stacks") {
+                options.stackThreshold = std::chrono::microseconds(std::stoll(value(i)));
+                if (options.stackThreshold.count() <= 0) throw std::invalid_argument("--stacks must be positive");
+            } else if (arg == "--stacks-top") {
+                options.stackTop = std::stoull(value(i));
+            } else if (arg == "--read-copy") {
+                options.readCopy = value(i);
+                StreamingCopy::find(options.readCopy);
+            } else if (arg == "--write-copy") {
+                options.writeCopy = value(i);
+                StreamingCopy::find(options.writeCopy);
+            } else if (arg == "--max-size") {
+                options.copyMaxSize = std::stoull(value(i)) << 20;
+                if (options.copyMaxSize == 0) throw std::invalid_argument("--max-size must be positive");
+            } else if (arg == "--reader-sched") {
+                options.readerPriority = ThreadPriority::parse(value(i));
+            } else if (arg == "--writer-sched") {
+                options.writerPriority = ThreadPriority::parse(value(i));
+            } else if (arg == "-h" || arg == "--help") {
+                options.command = "help";
+            } else if (arg == "--history") {
+                options.historyPath = value(i);
+            } else if (arg == "--html") {
+                options.htmlPath = value(i);
+            } else if (arg == "--json") {
+                options.jsonPath = value(i);
+            } else if (arg == "--readers") {
+                options.readers = std::stoi(value(i));
+            } else if (arg == "--writers") {
+                options.writers = std::stoi(value(i));
+            } else if (arg == "--updates") {
+                options.updates = std::stoi(value(i));
+                if (options.updates <= 0) throw std::invalid_argument("--updates must be positive");
+            } else if (arg == "--keys") {
+                options.keys = std::stoull(value(i));
+                if (options.keys == 0) throw std::invalid_argument("--keys must be positive");
+            } else if (arg == "--zipf") {
+                options.zipfTheta = std::stod(value(i));
+            } else if (arg == "--phases") {
+                options.phases = std::stoi(value(i));
+                if (options.phases <= 0) throw std::invalid_argument("--phases must be positive");
+            } else if (arg == "--phase-time") {
+                options.phaseTime = parseDuration(value(i));
+            } else if (arg == "--split-threshold") {
+                options.splitThreshold = std::stod(value(i)) / 100.0;
+            } else if (arg == "--batch") {
+                options.batchSizes.clear();
+                std::istringstream list(value(i));
+                for (std::string size; std::getline(list, size, ',');) {
+                    if (std::stoi(size) <= 0) throw std::invalid_argument("invalid batch size " + size);
+                    options.batchSizes.push_back(std::stoi(size));
+                }
+            } else if (arg == "--requests") {
+                options.requests = std::stoi(value(i));
+                if (options.requests <= 0) throw std::invalid_argument("--requests must be positive");
+            } else if (arg == "--replicas") {
+                options.replicas = std::stoi(value(i));
+                if (options.replicas <= 0 || options.replicas > FUTEX_WAITV_MAX)
+                    throw std::invalid_argument("--replicas must be between 1 and " + std::to_string(FUTEX_WAITV_MAX));
+            } else if (arg == "--reads") {
+                options.reads = std::stoi(value(i));
+                if (options.reads <= 0) throw std::invalid_argument("--reads must be positive");
+            } else if (arg == "--loops") {
+                options.loops = std::stoi(value(i));
+                if (options.loops <= 0) throw std::invalid_argument("--loops must be positive");
+            } else if (arg == "--in-flight") {
+                options.inFlight = std::stoi(value(i));
+                if (options.inFlight <= 0) throw std::invalid_argument("--in-flight must be positive");
+            } else if (arg == "--io-us") {
+                options.ioTime = std::chrono::microseconds(std::stoll(value(i)));
+                if (options.ioTime.count() <= 0) throw std::invalid_argument("--io-us must be positive");
+            } else if (arg == "--loop-time") {
+                options.loopTime = parseDuration(value(i));
+            } else if (arg == "--instances") {
+                options.instances = std::stoi(value(i));
+                if (options.instances < 2) throw std::invalid_argument("--instances must be at least 2");
+            } else if (arg == "--disjoint") {
+                options.disjointCpus = true;
+            } else if (arg == "--cases") {
+                options.testCases.clear();
+                std::istringstream list(value(i));
+                for (std::string index; std::getline(list, index, ',');) {
+                    if (std::stoi(index) <= 0) throw std::invalid_argument("invalid test case " + index);
+                    options.testCases.push_back(std::stoi(index));
+                }
+            } else if (arg == "--shards") {
+                options.shards = std::stoi(value(i));
+                if (options.shards <= 0) throw std::invalid_argument("--shards must be positive");
+            } else if (arg == "--ops") {
+                options.coreOps = std::stoi(value(i));
+                if (options.coreOps <= 0) throw std::invalid_argument("--ops must be positive");
+            } else if (arg == "--write-pct") {
+                options.writePercent = std::stod(value(i));
+                if (options.writePercent < 0 || options.writePercent > 100) throw std::invalid_argument("--write-pct must be between 0 and 100");
+            } else if (arg == "--lock") {
+                options.lock = value(i);
+            } else if (arg == "--duration") {
+                options.duration = parseDuration(value(i));
+            } else if (arg == "--interval") {
+                options.interval = parseDuration(value(i));
+            } else if (arg == "--cores") {
+                options.simulatedCores.clear();
+                std::istringstream list(value(i));
+                for (std::string count; std::getline(list, count, ',');) {
+                    if (std::stoi(count) <= 0) throw std::invalid_argument("invalid core count " + count);
+                    options.simulatedCores.push_back(std::stoi(count));
+                }
+            } else if (arg == "--sim-ops") {
+                options.simulatedOps = std::stoi(value(i));
+            } else if (arg == "--transfer-ns") {
+                options.transferNs = std::stod(value(i));
+            } else if (arg == "--no-history") {
+                options.recordHistory = false;
+            } else if (arg == "--threshold") {
+                options.stepThreshold = std::stod(value(i)) / 100.0;
+            } else {
+                throw std::invalid_argument("unknown argument " + arg);
+            }
+        }
+        // First-touch placements only hold if the threads run where the memory was touched from
+        if (options.dataPlacement.firstTouch() || options.textPlacement.firstTouch() || options.lockPlacement.firstTouch())
+            options.pin = true;
+        return options;
+    }
+
+    /**
+     * @brief Parses a duration such as `90`, `90s`, `30m` or `8h`.
+     * @param text The duration; a bare number means seconds.
+     * @return The duration in seconds.
+     * @throws std::invalid_argument If the text is not a positive duration.
+     */
+    static std::chrono::seconds parseDuration(const std::string& text) {
+        size_t end = 0;
+        long long amount = std::stoll(text, &end);
+        std::string unit = text.substr(end);
+        long long scale = unit.empty() || unit == "s" ? 1 : unit == "m" ? 60 : unit == "h" ? 3600 : 0;
+        if (scale == 0 || amount <= 0) throw std::invalid_argument("invalid duration " + text);
+        return std::chrono::seconds(amount * scale);
+    }
+
+    /**
+     * @brief Prints the command-line synopsis.
+     * @param out The output stream.
+     */
+    static void printUsage(std::ostream& out) {
+        out << "Usage: main [command] [options]\n"
+            << "\n"
+            << "Commands:\n"
+            << "  run                 Run the benchmark and print the results table (default)\n"
+            << "  report              Show per-metric trends across the runs in the history file\n"
+            << "  env                 Show the captured environment and any noise warnings\n"
+            << "  soak                Run one workload for a long time and track memory and latency drift\n"
+            << "  notify              Compare an eventcount with a condition variable for readers waiting on updates\n"
+            << "  stripes             Compare static and adaptive lock striping while the hot keys move\n"
+            << "  multiget            Compare batched lookups in the striped store with independent reads\n"
+            << "  eventloop           Compare blocking, io_uring, eventfd and handoff lock waits in event loops\n"
+            << "  replicas            Compare readers that wait for their own replica with readers taking any free one\n"
+            << "  percore             Compare shared-nothing cores passing messages with lock-based sharing\n"
+            << "  interfere           Run several testers at once and report each one's slowdown versus running alone\n"
+            << "  manylocks           Compare footprint and speed of millions of mostly uncontended locks\n"
+            << "  kvserver            Compare lock types end to end behind a loopback key-value server\n"
+            << "  futexhash           Measure futex wakes and probes while up to millions of waiters are parked\n"
+            << "  copy                Compare streaming copy and fill kernels with memcpy across payload sizes\n"
+            << "  simulate            Calibrate a lock protocol simulator here and predict larger core counts\n"
+            << "  replay RUN          Rerun a recorded run with its configuration, seed and placement\n"
+            << "  help                Show this message\n"
+            << "\n"
+            << "Options:\n"
+            << "  --history FILE      Results history file (default: bench_history.tsv)\n"
+            << "  --no-history        Do not append this run to the history file\n"
+            << "  --html FILE         Also write a self-contained HTML report with charts to FILE\n"
+            << "  --json FILE         Also write all metrics, including latency percentiles, as JSON to FILE\n"
+            << "  --seed N            Global seed for all payload generators (default: random, always recorded)\n"
+            << "  --pin               Pin threads to CPUs in a fixed order (readers, then writers)\n"
+            << "  --place P           Memory placement of data, text and locks: default|writer|reader|interleave|node:N\n"
+            << "  --place-data P      Placement of SharedData only (also --place-text, --place-locks)\n"
+            << "                      writer and reader place by first touch and imply --pin\n"
+            << "  --core-groups N     Replicas of Node Replicated on single-node machines (default: 2)\n"
+            << "  --pi                Also run the priority-inheritance mutexes and print their report\n"
+            << "  --parking           Also run the parking-lot mutexes (1-byte mutex, 2-byte shared mutex)\n"
+            << "  --lease US          Also run a lease lock with US-microsecond leases in read-dominated cases\n"
+            << "  --perf-ctl CTL[,ACK]  Enable an external perf only while threads measure, e.g. with\n"
+            << "                      perf record -D -1 -k mono --control fifo:CTL,ACK; markers go to stderr\n"
+            << "  --stacks US         Capture the call stack of every lock wait of at least US microseconds\n"
+            << "  --stacks-top N      Capture the stacks of the N longest lock waits; both print a deduplicated report\n"
+            << "  --read-copy K       Kernel readers copy the text with: memcpy, sse2, avx or stream (widest streaming)\n"
+            << "  --write-copy K      Kernel writers install payloads with, in place (default for both: std::string copies)\n"
+            << "  --reader-sched S    Scheduling of readers: other|batch|idle[:NICE] or fifo|rr[:PRIO], e.g. fifo:10\n"
+            << "  --writer-sched S    Scheduling of writers, e.g. idle or batch:19; prints a priority inversion report\n"
+            << "  --threshold PCT     Change against the trailing median reported as a step (default: 10)\n"
+            << "\n"
+            << "Soak and notify options:\n"
+            << "  --readers N         Reader threads (default: 50)\n"
+            << "  --writers N         Writer threads (default: 2)\n"
+            << "  --updates N         Updates per writer of notify (default: 1000)\n"
+            << "  --lock NAME         shared (std::shared_mutex) or standard (std::mutex) (default: shared)\n"
+            << "  --duration TIME     Total run time, e.g. 90s, 30m, 8h (default: 1h)\n"
+            << "  --interval TIME     Time between samples (default: 10s)\n"
+            << "\n"
+            << "Stripes options (also --readers, --writers):\n"
+            << "  --keys N            Entries in the store (default: 100000)\n"
+            << "  --zipf THETA        Zipfian skew in (0, 1) (default: 0.99)\n"
+            << "  --phases N          Times the hot set moves, including the start (default: 4)\n"
+            << "  --phase-time TIME   Duration of each phase (default: 2s)\n"
+            << "  --split-threshold PCT  Contended acquisitions that split a stripe (default: 1)\n"
+            << "\n"
+            << "Multiget options (also --readers, --writers, --keys, --zipf):\n"
+            << "  --batch LIST        Keys per request to compare, e.g. 10,20,50 (default)\n"
+            << "  --requests N        Requests per reader and batch size (default: 2000)\n"
+            << "\n"
+            << "Eventloop options (also --writers):\n"
+            << "  --loops N           Event-loop threads (default: 2)\n"
+            << "  --in-flight N       Requests each loop keeps in flight (default: 32)\n"
+            << "  --io-us N           Mean simulated I/O time in microseconds (default: 50)\n"
+            << "  --loop-time TIME    Run time of each wait mode (default: 2s)\n"
+            << "\n"
+            << "Replicas options (also --readers, --writers):\n"
+            << "  --replicas N        Copies of SharedData (default: 4)\n"
+            << "  --reads N           Reads per reader (default: 20000)\n"
+            << "\n"
+            << "Percore options (also --in-flight):\n"
+            << "  --shards N          Cores, each owning a partition (default: every allowed CPU, at least 2)\n"
+            << "  --ops N             Operations per core (default: 20000)\n"
+            << "  --write-pct P       Share of updates in percent (default: 10)\n"
+            << "\n"
+            << "Interfere options (also --pi, --parking, --lease):\n"
+            << "  --instances N       Testers running at once, each with its own data and locks (default: 2)\n"
+            << "  --disjoint          Pin each instance to its own CPUs (default: all on the same CPUs)\n"
+            << "  --cases LIST        Test cases to run, 1-based, e.g. 1,5 (default: all)\n"
+            << "\n"
+            << "Manylocks options:\n"
+            << "  --objects N         Objects, each with its own lock (default: 2000000)\n"
+            << "  --threads N         Threads picking objects at random (default: 4)\n"
+            << "  --lock-ops N        Operations per thread (default: 1000000)\n"
+            << "\n"
+            << "Kvserver options (also --keys, --write-pct):\n"
+            << "  --workers N         Server threads, each with its own epoll instance (default: 2)\n"
+            << "  --clients N         Client threads, each with a connection and one request in flight (default: 16)\n"
+            << "  --tcp               Use loopback TCP (default: a Unix domain socket)\n"
+            << "  --server-time TIME  Run time of each lock type (default: 2s)\n"
+            << "\n"
+            << "Futexhash options (also --threads for the probe threads):\n"
+            << "  --words LIST        Parked word counts, e.g. 10,1000 (default: 10 to 1000000 by powers of ten)\n"
+            << "  --futex-ops N       Probe operations per thread (default: 50000)\n"
+            << "  --wakes N           Wakes measured per word count (default: 1000)\n"
+            << "\n"
+            << "Copy options:\n"
+            << "  --max-size MIB      Largest payload in MiB (default: twice the LLC, 64 to 256)\n"
+            << "\n"
+            << "Simulate options:\n"
+            << "  --cores LIST        Core counts to predict, e.g. 256,512,1024 (default)\n"
+            << "  --sim-ops N         Reads or updates per thread the test cases are scaled to (default: 200)\n"
+            << "  --transfer-ns NS    Cache-line transfer latency (default: measured, 100 on a single CPU)\n";
+    }
+};
+
+int main(int argc, char* argv[]) {
+    Options options;
+    try {
+        options = Options::parse(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n\n";
+        Options::printUsage(std::cerr);
+        return 2;
+    }
+
+    if (options.command == "help") {
+        Options::printUsage(std::cout);
+        return 0;
+    }
+
+    // Without a kernel the operations keep the original std::string copies; any kernel copies through a buffer
+    if (!options.readCopy.empty()) LockTester::readCopy = StreamingCopy::find(options.readCopy).copy;
+    if (!options.writeCopy.empty()) LockTester::writeCopy = StreamingCopy::find(options.writeCopy).copy;
+
+    try {
+        if (options.command == "report") {
+            ResultsHistory(options.historyPath).printTrendReport(options.stepThreshold);
+            return 0;
+        }
+        if (options.command == "soak") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.readers + options.writers))
+                std::cerr << "Warning: " << warning << std::endl;
+            SoakTester soak(options.readers, options.writers, options.lock, options.duration, options.interval);
+            soak.seed = options.seed;
+            soak.pinThreads = options.pin;
+            soak.readerPriority = options.readerPriority;
+            soak.writerPriority = options.writerPriority;
+            soak.run();
+            return 0;
+        }
+        if (options.command == "notify") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.readers + options.writers))
+                std::cerr << "Warning: " << warning << std::endl;
+            LockTester tester(options.readers, options.writers, 0, options.updates);
+            tester.seed = options.seed;
+            tester.pinThreads = options.pin;
+            tester.testConditionVariableWait();
+            tester.testEventCountWait();
+            Benchmark::printWaitComparison(tester);
+            return 0;
+        }
+        if (options.command == "stripes") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.readers + options.writers))
+                std::cerr << "Warning: " << warning << std::endl;
+            StripingBenchmark(options.readers, options.writers, options.keys, options.zipfTheta, options.phases, options.phaseTime,
+                              options.splitThreshold, options.seedSet ? options.seed : std::random_device{}())
+                .run();
+            return 0;
+        }
+        if (options.command == "multiget") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.readers + options.writers))
+                std::cerr << "Warning: " << warning << std::endl;
+            MultiGetBenchmark(options.readers, options.writers, options.keys, options.zipfTheta, options.batchSizes,
+                              options.requests, options.seedSet ? options.seed : std::random_device{}())
+                .run();
+            return 0;
+        }
+        if (options.command == "eventloop") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.loops + options.writers))
+                std::cerr << "Warning: " << warning << std::endl;
+            EventLoopBenchmark(options.loops, options.writers, options.inFlight, options.ioTime, options.loopTime,
+                               options.seedSet ? options.seed : std::random_device{}())
+                .run();
+            return 0;
+        }
+        if (options.command == "replicas") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.readers + options.writers))
+                std::cerr << "Warning: " << warning << std::endl;
+            AnyReplicaBenchmark(options.readers, options.writers, options.replicas, options.reads,
+                                options.seedSet ? options.seed : std::random_device{}())
+                .run();
+            return 0;
+        }
+        if (options.command == "percore") {
+            ThreadPerCoreBenchmark benchmark(options.shards, options.coreOps, options.writePercent, options.inFlight,
+                                             options.seedSet ? options.seed : std::random_device{}());
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(benchmark.cores()))
+                std::cerr << "Warning: " << warning << std::endl;
+            benchmark.run();
+            return 0;
+        }
+        if (options.command == "manylocks") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.threads))
+                std::cerr << "Warning: " << warning << std::endl;
+            ManyLocksBenchmark(options.objects, options.threads, options.lockOps,
+                               options.seedSet ? options.seed : std::random_device{}())
+                .run();
+            return 0;
+        }
+        if (options.command == "kvserver") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.workers + options.clients))
+                std::cerr << "Warning: " << warning << std::endl;
+            KvServerBenchmark(options.workers, options.clients, options.keys, options.writePercent, options.tcp,
+                              options.serverTime, options.seedSet ? options.seed : std::random_device{}())
+                .run();
+            return 0;
+        }
+        if (options.command == "futexhash") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            for (const auto& warning : environment.warnings(options.threads))
+                std::cerr << "Warning: " << warning << std::endl;
+            FutexBucketBenchmark(options.futexWords, options.threads, options.futexOps, options.wakes,
+                                 options.seedSet ? options.seed : std::random_device{}())
+                .run();
+            return 0;
+        }
+        if (options.command == "copy") {
+            CopyBenchmark(options.copyMaxSize).run();
+            return 0;
+        }
+        if (options.command == "env") {
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            TextTable table({"Property", "Value"});
+            for (const auto& attribute : environment.attributes()) table.addRow({attribute.first, attribute.second});
+            table.print();
+            for (const auto& warning : environment.warnings(0)) std::cout << "Warning: " << warning << std::endl;
+            return 0;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // A replay reuses the recorded command line and seed; placement follows from --pin in that command line
+    std::map<std::string, std::string> replayed;
+    if (options.command == "replay") {
+        try {
+            replayed = ResultsHistory(options.historyPath).findRun(options.replayRunId);
+            std::vector<std::string> tokens = Options::splitArguments(replayed["args"]);
+            std::vector<char*> argvReplay;
+            for (auto& token : tokens) argvReplay.push_back(&token[0]);
+
+            Options recorded = Options::parse(static_cast<int>(argvReplay.size()), argvReplay.data());
+            recorded.command = "run";
+            recorded.seed = std::stoull(replayed.at("seed"));
+            recorded.seedSet = true;
+            recorded.historyPath = options.historyPath;
+            recorded.recordHistory = options.recordHistory;
+            if (!options.htmlPath.empty()) recorded.htmlPath = options.htmlPath;
+            if (!options.jsonPath.empty()) recorded.jsonPath = options.jsonPath;
+            recorded.replayRunId = options.replayRunId;
+            options = recorded;
+        } catch (const std::exception& e) {
+            std::cerr << "Error: cannot replay " << options.replayRunId << ": " << e.what() << std::endl;
+            return 1;
+        }
+        if (replayed["git"] != GIT_REVISION)
+            std::cerr << "Warning: run was recorded with git " << replayed["git"] << ", this binary is " << GIT_REVISION << std::endl;
+        if (replayed.count("cpus") && replayed["cpus"] != Options::formatCpus(SimulationCosts::allowedCpus()))
+            std::cerr << "Warning: run was recorded on CPUs " << replayed["cpus"] << ", this process may run on "
+                      << Options::formatCpus(SimulationCosts::allowedCpus()) << "; pinned threads land elsewhere" << std::endl;
+        std::cout << "Replaying run " << options.replayRunId << " (seed " << options.seed << "): " << options.commandLine << std::endl;
+    }
+    if (!options.seedSet) options.seed = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
 
-    Benchmark()
+    // Create a Benchmark instance and add various test cases to evaluate performance
+    Benchmark benchmark;
+    benchmark.setSeed(options.seed).setPinning(options.pin).setPriorities(options.readerPriority, options.writerPriority)
+        .setCoreGroups(options.coreGroups).setPiLocks(options.piLocks)
+        .setParkingLocks(options.parkingLocks).setLeaseTime(options.leaseTime).setPlacement(options.dataPlacement, options.textPlacement, options.lockPlacement);
+    benchmark
         // Test case 1: High number of readers, few writers, minimal write workload
         // This demonstrates the performance gain of using shared_mutex with a read-heavy load
         .addTestCase(50, 2, static_cast<int>(1e4), 1)
@@ -467,13 +9763,141 @@ int main() {
         
         // Test case 9: Single reader, high number of writers, moderate workload
         // Demonstrates shared_mutex behavior when write access is highly prioritized
-        .addTestCase(1, 20, 50, static_cast<int>(1e3))
+        .addTestCase(1, 20, 50, static_cast<int>(1e3));
+
+    // Run several testers side by side to see what they cost each other without sharing a lock
+    if (options.command == "interfere") {
+        try {
+            std::vector<std::tuple<int, int, int, int>> testCases;
+            for (int index : options.testCases) {
+                if (index > static_cast<int>(benchmark.configurations().size()))
+                    throw std::invalid_argument("no test case " + std::to_string(index));
+                testCases.push_back(benchmark.configurations()[index - 1]);
+            }
+            if (testCases.empty()) testCases = benchmark.configurations();
+            EnvironmentInfo environment = EnvironmentInfo::collect();
+            int maxThreads = 0;
+            for (const auto& testCase : testCases) maxThreads = std::max(maxThreads, std::get<0>(testCase) + std::get<1>(testCase));
+            for (const auto& warning : environment.warnings(maxThreads * options.instances))
+                std::cerr << "Warning: " << warning << std::endl;
+            std::vector<std::string> locks = {"Shared Mutex", "Standard Mutex"};
+            if (options.piLocks) locks.insert(locks.end(), {"PI Mutex", "Futex PI"});
+            if (options.leaseTime.count() > 0) locks.push_back("Lease Lock");
+            if (options.parkingLocks) locks.insert(locks.end(), {"Parking Mutex", "Parking Shared"});
+            InterferenceStudy(testCases, options.instances, options.disjointCpus,
+                              options.seedSet ? options.seed : std::random_device{}(), locks, options.leaseTime)
+                .run();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // Predict the test cases on machines larger than this one
+    if (options.command == "simulate") {
+        try {
+            ScalingStudy(benchmark.configurations(), options.simulatedCores, options.simulatedOps, options.transferNs).run();
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    // An external perf started with its events disabled profiles only the measured phases
+    std::unique_ptr<ProfilerControl> profiler;
+    if (!options.perfControl.empty()) {
+        try {
+            profiler = std::make_unique<ProfilerControl>(options.perfControl);
+        } catch (const std::exception& e) {
+            std::cerr << "Error: " << e.what() << std::endl;
+            return 1;
+        }
+        benchmark.setProfiler(profiler.get());
+    }
 
+    // Slow waits are attributed to the call stacks that incurred them
+    std::unique_ptr<WaitProfiler> waitProfiler;
+    if (options.stackThreshold.count() > 0 || options.stackTop > 0) {
+        waitProfiler = std::make_unique<WaitProfiler>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(options.stackThreshold).count(), options.stackTop);
+        benchmark.setWaitProfiler(waitProfiler.get());
+    }
+
+    // Capture the conditions of this run and warn about the ones that make results noisy
+    EnvironmentInfo environment = EnvironmentInfo::collect();
+    for (const auto& warning : environment.warnings(benchmark.maxThreads()))
+        std::cerr << "Warning: " << warning << std::endl;
+
+    benchmark
         // Execute all test cases and measure performance
         .run()
 
         // Print the benchmark results in a formatted table for easy comparison
         .printBenchmarkTable();
 
+    // Mixed-priority runs also show how long readers waited behind preempted writers
+    if (!options.readerPriority.isDefault() || !options.writerPriority.isDefault())
+        benchmark.printPriorityReport();
+
+    // Priority inheritance shows its cost on writers and its effect on reader tails
+    if (options.piLocks) benchmark.printPiReport();
+
+    // One- and two-byte locks against the standard ones they would replace
+    if (options.parkingLocks) benchmark.printParkingReport();
+
+    // Leases trade reader fences for writer waits
+    if (options.leaseTime.count() > 0) benchmark.printLeaseReport();
+
+    // The stacks behind the slowest waits
+    if (waitProfiler) waitProfiler->printReport();
+
+    // Placement experiments show whether readers pay for payloads on other nodes
+    if (!options.dataPlacement.isDefault() || !options.textPlacement.isDefault() || !options.lockPlacement.isDefault())
+        benchmark.printPlacementReport();
+
+    ResultsHistory::Attributes runAttributes = ResultsHistory::currentRunAttributes(options.commandLine);
+    for (const auto& attribute : environment.attributes()) runAttributes.push_back(attribute);
+    std::ostringstream digest;
+    digest << std::hex << std::setw(16) << std::setfill('0') << benchmark.payloadDigest();
+    runAttributes.push_back({"seed", std::to_string(options.seed)});
+    runAttributes.push_back({"placement", options.pin ? "pinned" : "os"});
+    // Pinned threads take these CPUs in this order, wrapping around
+    runAttributes.push_back({"cpus", Options::formatCpus(SimulationCosts::allowedCpus())});
+    runAttributes.push_back({"reader_sched", options.readerPriority.describe()});
+    runAttributes.push_back({"writer_sched", options.writerPriority.describe()});
+    runAttributes.push_back({"mem_data", options.dataPlacement.describe()});
+    runAttributes.push_back({"mem_text", options.textPlacement.describe()});
+    runAttributes.push_back({"mem_locks", options.lockPlacement.describe()});
+    runAttributes.push_back({"read_copy", options.readCopy.empty() ? std::string("string") : options.readCopy});
+    runAttributes.push_back({"write_copy", options.writeCopy.empty() ? std::string("string") : options.writeCopy});
+    int replicas = NodeReplicatedData::layout(0, 0, options.coreGroups).first;
+    runAttributes.push_back({"replicas", std::to_string(replicas) + (NumaTopology::get().nodes.size() > 1 ? " numa nodes" : " core groups")});
+    runAttributes.push_back({"payload_digest", digest.str()});
+    if (!options.replayRunId.empty()) {
+        runAttributes.push_back({"replay_of", options.replayRunId});
+        bool same = replayed["payload_digest"] == digest.str();
+        std::cout << "Payload sequence " << (same ? "matches" : "DIFFERS FROM") << " run " << options.replayRunId
+                  << " (digest " << digest.str() << ")" << std::endl;
+    }
+
+    // Keep the results so trends across kernel, glibc or compiler rollouts can be reported later
+    if (options.recordHistory) {
+        try {
+            benchmark.saveHistory(ResultsHistory(options.historyPath), runAttributes);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    }
+
+    // Charts and machine-readable metrics for comparisons that do not fit into the ASCII table
+    try {
+        if (!options.htmlPath.empty()) benchmark.writeHtmlReport(options.htmlPath, runAttributes);
+        if (!options.jsonPath.empty()) benchmark.writeJsonReport(options.jsonPath, runAttributes);
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: " << e.what() << std::endl;
+    }
+
     return 0;
 }